@@ -1,6 +1,7 @@
 @echo off
 set CXX=g++
 set CFLAGS=-Wall -Wextra -std=c++17
+set CLIENT_CFLAGS=-Wall -Wextra -std=c++20
 
 echo Creating bin directory...
 if not exist bin mkdir bin
@@ -10,23 +11,183 @@ echo Building game server...
   src/server/main.cpp ^
   src/server/game_session.cpp ^
   src/server/session_manager.cpp ^
+  src/server/timer_wheel.cpp ^
+  src/server/session_snapshot.cpp ^
+  src/server/server_stats.cpp ^
+  src/log/logger.cpp ^
   src/protocol/protocol.cpp ^
+  src/protocol/codec.cpp ^
+  src/protocol/checksum.cpp ^
   src/game/game_logic.cpp ^
+  src/game/random.cpp ^
+  src/game/word_dictionary.cpp ^
+  src/game/word_selector.cpp ^
+  src/game/word_library.cpp ^
   src/ipc/file_socket.cpp ^
   src/ipc/file_handle.cpp ^
   src/ipc/file_lock.cpp ^
-  src/ipc/region_ops.cpp
+  src/ipc/region_ops.cpp ^
+  src/ipc/mapped_file.cpp ^
+  src/ipc/notify.cpp ^
+  src/ipc/ring_buffer.cpp ^
+  src/ipc/slot_table.cpp ^
+  src/ipc/uring_queue.cpp ^
+  src/ipc/batched_regions.cpp
 
 echo Building game client...
-%CXX% %CFLAGS% -o bin/client.exe ^
+%CXX% %CLIENT_CFLAGS% -o bin/client.exe ^
   src/client/main.cpp ^
   src/client/game_client.cpp ^
+  src/client/async_client.cpp ^
+  src/client/client_loop.cpp ^
+  src/client/word_solver.cpp ^
   src/protocol/protocol.cpp ^
+  src/protocol/codec.cpp ^
+  src/protocol/checksum.cpp ^
   src/game/game_logic.cpp ^
+  src/game/random.cpp ^
+  src/game/word_dictionary.cpp ^
   src/ipc/file_socket.cpp ^
   src/ipc/file_handle.cpp ^
   src/ipc/file_lock.cpp ^
-  src/ipc/region_ops.cpp
+  src/ipc/region_ops.cpp ^
+  src/ipc/mapped_file.cpp ^
+  src/ipc/notify.cpp ^
+  src/ipc/ring_buffer.cpp ^
+  src/ipc/slot_table.cpp ^
+  src/ipc/uring_queue.cpp ^
+  src/ipc/batched_regions.cpp
+
+echo Building checksum benchmark...
+%CXX% %CFLAGS% -O2 -o bin/checksum_bench.exe ^
+  src/bench/checksum_bench.cpp ^
+  src/protocol/checksum.cpp ^
+  src/protocol/codec.cpp
+
+echo Building microbenchmarks...
+%CXX% %CFLAGS% -O2 -o bin/micro_bench.exe ^
+  src/bench/micro_bench.cpp ^
+  src/server/session_manager.cpp ^
+  src/server/game_session.cpp ^
+  src/server/timer_wheel.cpp ^
+  src/log/logger.cpp ^
+  src/protocol/protocol.cpp ^
+  src/protocol/codec.cpp ^
+  src/protocol/checksum.cpp ^
+  src/game/game_logic.cpp ^
+  src/game/random.cpp ^
+  src/game/word_dictionary.cpp ^
+  src/game/word_selector.cpp ^
+  src/ipc/file_socket.cpp ^
+  src/ipc/file_handle.cpp ^
+  src/ipc/file_lock.cpp ^
+  src/ipc/region_ops.cpp ^
+  src/ipc/mapped_file.cpp ^
+  src/ipc/notify.cpp ^
+  src/ipc/ring_buffer.cpp ^
+  src/ipc/slot_table.cpp ^
+  src/ipc/uring_queue.cpp ^
+  src/ipc/batched_regions.cpp
+
+echo Building load generator...
+%CXX% %CFLAGS% -O2 -o bin/loadgen.exe ^
+  src/tools/loadgen.cpp ^
+  src/tools/latency_histogram.cpp ^
+  src/protocol/protocol.cpp ^
+  src/protocol/codec.cpp ^
+  src/protocol/checksum.cpp ^
+  src/ipc/file_socket.cpp ^
+  src/ipc/file_handle.cpp ^
+  src/ipc/file_lock.cpp ^
+  src/ipc/region_ops.cpp ^
+  src/ipc/mapped_file.cpp ^
+  src/ipc/notify.cpp ^
+  src/ipc/ring_buffer.cpp ^
+  src/ipc/slot_table.cpp ^
+  src/ipc/uring_queue.cpp ^
+  src/ipc/batched_regions.cpp
+
+echo Building stats viewer...
+%CXX% %CFLAGS% -O2 -o bin/hangman-top.exe ^
+  src/tools/hangman_top.cpp
+
+echo Building dictionary compiler...
+%CXX% %CFLAGS% -O2 -o bin/dict_compile.exe ^
+  src/tools/dict_compile.cpp ^
+  src/protocol/checksum.cpp ^
+  src/game/word_dictionary.cpp ^
+  src/game/game_logic.cpp ^
+  src/game/random.cpp
+
+echo Compiling dictionary...
+bin\dict_compile.exe resources/words.txt resources/words.dict
+
+echo Building tests...
+%CXX% %CFLAGS% -O2 -o bin/timer_wheel_test.exe ^
+  src/tests/timer_wheel_test.cpp ^
+  src/server/timer_wheel.cpp
+
+%CXX% %CFLAGS% -O2 -o bin/session_snapshot_test.exe ^
+  src/tests/session_snapshot_test.cpp ^
+  src/server/session_snapshot.cpp ^
+  src/log/logger.cpp ^
+  src/protocol/checksum.cpp ^
+  src/game/game_logic.cpp ^
+  src/game/random.cpp ^
+  src/game/word_dictionary.cpp ^
+  src/ipc/file_socket.cpp ^
+  src/ipc/file_handle.cpp ^
+  src/ipc/file_lock.cpp ^
+  src/ipc/region_ops.cpp ^
+  src/ipc/mapped_file.cpp ^
+  src/ipc/notify.cpp ^
+  src/ipc/ring_buffer.cpp ^
+  src/ipc/slot_table.cpp ^
+  src/ipc/uring_queue.cpp ^
+  src/ipc/batched_regions.cpp
+
+%CXX% %CFLAGS% -O2 -o bin/codec_test.exe ^
+  src/tests/codec_test.cpp ^
+  src/protocol/codec.cpp ^
+  src/protocol/checksum.cpp ^
+  src/protocol/protocol.cpp ^
+  src/ipc/file_socket.cpp ^
+  src/ipc/file_handle.cpp ^
+  src/ipc/file_lock.cpp ^
+  src/ipc/region_ops.cpp ^
+  src/ipc/mapped_file.cpp ^
+  src/ipc/notify.cpp ^
+  src/ipc/ring_buffer.cpp ^
+  src/ipc/slot_table.cpp ^
+  src/ipc/uring_queue.cpp ^
+  src/ipc/batched_regions.cpp
+
+%CXX% %CFLAGS% -O2 -o bin/checksum_test.exe ^
+  src/tests/checksum_test.cpp ^
+  src/protocol/checksum.cpp
+
+%CXX% %CFLAGS% -O2 -o bin/game_logic_test.exe ^
+  src/tests/game_logic_test.cpp ^
+  src/game/game_logic.cpp ^
+  src/game/random.cpp
+
+%CXX% %CFLAGS% -O2 -o bin/word_selector_test.exe ^
+  src/tests/word_selector_test.cpp ^
+  src/protocol/checksum.cpp ^
+  src/game/word_selector.cpp ^
+  src/game/word_dictionary.cpp ^
+  src/game/game_logic.cpp ^
+  src/game/random.cpp
+
+%CXX% %CFLAGS% -O2 -o bin/word_dictionary_test.exe ^
+  src/tests/word_dictionary_test.cpp ^
+  src/protocol/checksum.cpp ^
+  src/game/word_dictionary.cpp ^
+  src/game/game_logic.cpp ^
+  src/game/random.cpp
+
+echo Running tests...
+for %%t in (bin\*_test.exe) do %%t
 
 echo Build complete!
 echo Executables are in: bin\
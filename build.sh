@@ -0,0 +1,195 @@
+#!/bin/sh
+CXX=${CXX:-g++}
+CFLAGS="-Wall -Wextra -std=c++17 -pthread"
+CLIENT_CFLAGS="-Wall -Wextra -std=c++20 -pthread"
+
+echo "Creating bin directory..."
+mkdir -p bin
+
+echo "Building game server..."
+$CXX $CFLAGS -o bin/server \
+  src/server/main.cpp \
+  src/server/game_session.cpp \
+  src/server/session_manager.cpp \
+  src/server/timer_wheel.cpp \
+  src/server/session_snapshot.cpp \
+  src/server/server_stats.cpp \
+  src/log/logger.cpp \
+  src/protocol/protocol.cpp \
+  src/protocol/codec.cpp \
+  src/protocol/checksum.cpp \
+  src/game/game_logic.cpp \
+  src/game/random.cpp \
+  src/game/word_dictionary.cpp \
+  src/game/word_selector.cpp \
+  src/game/word_library.cpp \
+  src/ipc/file_socket.cpp \
+  src/ipc/file_handle.cpp \
+  src/ipc/file_lock.cpp \
+  src/ipc/region_ops.cpp \
+  src/ipc/mapped_file.cpp \
+  src/ipc/notify.cpp \
+  src/ipc/ring_buffer.cpp \
+  src/ipc/slot_table.cpp \
+  src/ipc/uring_queue.cpp \
+  src/ipc/batched_regions.cpp || exit 1
+
+echo "Building game client..."
+$CXX $CLIENT_CFLAGS -o bin/client \
+  src/client/main.cpp \
+  src/client/game_client.cpp \
+  src/client/async_client.cpp \
+  src/client/client_loop.cpp \
+  src/client/word_solver.cpp \
+  src/protocol/protocol.cpp \
+  src/protocol/codec.cpp \
+  src/protocol/checksum.cpp \
+  src/game/game_logic.cpp \
+  src/game/random.cpp \
+  src/game/word_dictionary.cpp \
+  src/ipc/file_socket.cpp \
+  src/ipc/file_handle.cpp \
+  src/ipc/file_lock.cpp \
+  src/ipc/region_ops.cpp \
+  src/ipc/mapped_file.cpp \
+  src/ipc/notify.cpp \
+  src/ipc/ring_buffer.cpp \
+  src/ipc/slot_table.cpp \
+  src/ipc/uring_queue.cpp \
+  src/ipc/batched_regions.cpp || exit 1
+
+echo "Building checksum benchmark..."
+$CXX $CFLAGS -O2 -o bin/checksum_bench \
+  src/bench/checksum_bench.cpp \
+  src/protocol/checksum.cpp \
+  src/protocol/codec.cpp || exit 1
+
+echo "Building microbenchmarks..."
+$CXX $CFLAGS -O2 -o bin/micro_bench \
+  src/bench/micro_bench.cpp \
+  src/server/session_manager.cpp \
+  src/server/game_session.cpp \
+  src/server/timer_wheel.cpp \
+  src/log/logger.cpp \
+  src/protocol/protocol.cpp \
+  src/protocol/codec.cpp \
+  src/protocol/checksum.cpp \
+  src/game/game_logic.cpp \
+  src/game/random.cpp \
+  src/game/word_dictionary.cpp \
+  src/game/word_selector.cpp \
+  src/ipc/file_socket.cpp \
+  src/ipc/file_handle.cpp \
+  src/ipc/file_lock.cpp \
+  src/ipc/region_ops.cpp \
+  src/ipc/mapped_file.cpp \
+  src/ipc/notify.cpp \
+  src/ipc/ring_buffer.cpp \
+  src/ipc/slot_table.cpp \
+  src/ipc/uring_queue.cpp \
+  src/ipc/batched_regions.cpp || exit 1
+
+echo "Building load generator..."
+$CXX $CFLAGS -O2 -o bin/loadgen \
+  src/tools/loadgen.cpp \
+  src/tools/latency_histogram.cpp \
+  src/protocol/protocol.cpp \
+  src/protocol/codec.cpp \
+  src/protocol/checksum.cpp \
+  src/ipc/file_socket.cpp \
+  src/ipc/file_handle.cpp \
+  src/ipc/file_lock.cpp \
+  src/ipc/region_ops.cpp \
+  src/ipc/mapped_file.cpp \
+  src/ipc/notify.cpp \
+  src/ipc/ring_buffer.cpp \
+  src/ipc/slot_table.cpp \
+  src/ipc/uring_queue.cpp \
+  src/ipc/batched_regions.cpp || exit 1
+
+echo "Building stats viewer..."
+$CXX $CFLAGS -O2 -o bin/hangman-top \
+  src/tools/hangman_top.cpp || exit 1
+
+echo "Building dictionary compiler..."
+$CXX $CFLAGS -O2 -o bin/dict_compile \
+  src/tools/dict_compile.cpp \
+  src/protocol/checksum.cpp \
+  src/game/word_dictionary.cpp \
+  src/game/game_logic.cpp \
+  src/game/random.cpp || exit 1
+
+echo "Compiling dictionary..."
+bin/dict_compile resources/words.txt resources/words.dict || exit 1
+
+echo "Building tests..."
+$CXX $CFLAGS -O2 -o bin/timer_wheel_test \
+  src/tests/timer_wheel_test.cpp \
+  src/server/timer_wheel.cpp || exit 1
+
+$CXX $CFLAGS -O2 -o bin/session_snapshot_test \
+  src/tests/session_snapshot_test.cpp \
+  src/server/session_snapshot.cpp \
+  src/log/logger.cpp \
+  src/protocol/checksum.cpp \
+  src/game/game_logic.cpp \
+  src/game/random.cpp \
+  src/game/word_dictionary.cpp \
+  src/ipc/file_socket.cpp \
+  src/ipc/file_handle.cpp \
+  src/ipc/file_lock.cpp \
+  src/ipc/region_ops.cpp \
+  src/ipc/mapped_file.cpp \
+  src/ipc/notify.cpp \
+  src/ipc/ring_buffer.cpp \
+  src/ipc/slot_table.cpp \
+  src/ipc/uring_queue.cpp \
+  src/ipc/batched_regions.cpp || exit 1
+
+$CXX $CFLAGS -O2 -o bin/codec_test \
+  src/tests/codec_test.cpp \
+  src/protocol/codec.cpp \
+  src/protocol/checksum.cpp \
+  src/protocol/protocol.cpp \
+  src/ipc/file_socket.cpp \
+  src/ipc/file_handle.cpp \
+  src/ipc/file_lock.cpp \
+  src/ipc/region_ops.cpp \
+  src/ipc/mapped_file.cpp \
+  src/ipc/notify.cpp \
+  src/ipc/ring_buffer.cpp \
+  src/ipc/slot_table.cpp \
+  src/ipc/uring_queue.cpp \
+  src/ipc/batched_regions.cpp || exit 1
+
+$CXX $CFLAGS -O2 -o bin/checksum_test \
+  src/tests/checksum_test.cpp \
+  src/protocol/checksum.cpp || exit 1
+
+$CXX $CFLAGS -O2 -o bin/game_logic_test \
+  src/tests/game_logic_test.cpp \
+  src/game/game_logic.cpp \
+  src/game/random.cpp || exit 1
+
+$CXX $CFLAGS -O2 -o bin/word_selector_test \
+  src/tests/word_selector_test.cpp \
+  src/protocol/checksum.cpp \
+  src/game/word_selector.cpp \
+  src/game/word_dictionary.cpp \
+  src/game/game_logic.cpp \
+  src/game/random.cpp || exit 1
+
+$CXX $CFLAGS -O2 -o bin/word_dictionary_test \
+  src/tests/word_dictionary_test.cpp \
+  src/protocol/checksum.cpp \
+  src/game/word_dictionary.cpp \
+  src/game/game_logic.cpp \
+  src/game/random.cpp || exit 1
+
+echo "Running tests..."
+for test in bin/*_test; do
+  "$test" || exit 1
+done
+
+echo "Build complete!"
+echo "Executables are in: bin/"
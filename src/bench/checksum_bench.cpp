@@ -0,0 +1,54 @@
+// Сравнение контрольных сумм сообщения: прежний XOR и CRC32C (таблица и SSE4.2)
+#include "../protocol/checksum.hpp"
+#include "../protocol/codec.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+typedef uint32_t (*ChecksumFunction)(uint32_t, const uint8_t*, size_t);
+
+// Результат копится в volatile, чтобы компилятор не выбросил цикл
+static volatile uint32_t sink;
+
+static double measure_ns(ChecksumFunction function, const std::vector<uint8_t>& data, size_t iterations) {
+    uint32_t value = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        value = function(value, data.data(), data.size());
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    sink = value;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+int main(int argc, char* argv[]) {
+    size_t iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000000;
+    const size_t sizes[] = {24, 64, 128, 256};
+
+    std::printf("SSE4.2 crc32: %s\n", Protocol::crc32c_hardware_available() ? "yes" : "no");
+    std::printf("%8s %12s %12s %12s %12s\n", "bytes", "xor ns", "crc-table ns", "crc-sse ns", "crc-sse GB/s");
+
+    for (size_t size : sizes) {
+        std::vector<uint8_t> data(size);
+        for (size_t i = 0; i < size; ++i) {
+            data[i] = static_cast<uint8_t>(i * 131 + 7);
+        }
+
+        double xor_ns = measure_ns(Protocol::xor_checksum, data, iterations);
+        double table_ns = measure_ns(Protocol::crc32c_software, data, iterations);
+        double sse_ns = Protocol::crc32c_hardware_available()
+                            ? measure_ns(Protocol::crc32c_hardware, data, iterations) : 0.0;
+
+        std::printf("%8zu %12.1f %12.1f %12.1f %12.2f\n", size, xor_ns, table_ns, sse_ns,
+                    sse_ns > 0 ? size / sse_ns : 0.0);
+    }
+
+    // Известное значение CRC32C("123456789") - проверка обеих реализаций
+    const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    bool ok = Protocol::crc32c_software(0, check, sizeof(check)) == 0xE3069283 &&
+              Protocol::crc32c(0, check, sizeof(check)) == 0xE3069283;
+    std::printf("crc32c check value: %s\n", ok ? "ok" : "MISMATCH");
+    return ok ? 0 : 1;
+}
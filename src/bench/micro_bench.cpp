@@ -0,0 +1,522 @@
+// Микробенчмарки горячих путей протокола, IPC и игровой логики.
+// Для каждого замера - ns/op и число выделений памяти на операцию; результаты
+// можно сохранить в JSON и сравнить следующий запуск с ним:
+//   micro_bench --json baseline.json
+//   micro_bench --baseline baseline.json [--threshold 10]
+#include "../protocol/protocol.hpp"
+#include "../protocol/codec.hpp"
+#include "../ipc/batched_regions.hpp"
+#include "../ipc/mapped_file.hpp"
+#include "../ipc/region_ops.hpp"
+#include "../ipc/ipc_common.hpp"
+#include "../game/game_logic.hpp"
+#include "../game/word_dictionary.hpp"
+#include "../game/word_selector.hpp"
+#include "../game/word_library.hpp"
+#include "../server/session_manager.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <new>
+#include <string>
+#include <vector>
+
+// ==================== Счётчик выделений ====================
+
+static std::atomic<uint64_t> allocation_count(0);
+
+// noinline: иначе после встраивания GCC видит пару malloc/operator delete
+// или operator new/free и предупреждает (-Wmismatched-new-delete)
+#ifdef __GNUC__
+#define BENCH_NOINLINE __attribute__((noinline))
+#else
+#define BENCH_NOINLINE
+#endif
+
+BENCH_NOINLINE void* operator new(size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    void* memory = std::malloc(size != 0 ? size : 1);
+    if (memory == nullptr) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+BENCH_NOINLINE void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+BENCH_NOINLINE void operator delete(void* memory, size_t) noexcept {
+    std::free(memory);
+}
+
+// ==================== Замер ====================
+
+struct BenchResult {
+    std::string name;
+    double ns_per_op;
+    double allocs_per_op;
+};
+
+// Результат копится в volatile, чтобы компилятор не выбросил тело
+static volatile uint64_t sink;
+
+// body(iterations) выполняет iterations вызовов и возвращает что-нибудь из
+// результата; ops_per_call - операций в одном вызове. Число повторов
+// подбирается под min_seconds, из трёх прогонов берётся лучший.
+template <typename Body>
+static BenchResult run_benchmark(const std::string& name, uint64_t ops_per_call, double min_seconds, Body body) {
+    typedef std::chrono::steady_clock Clock;
+
+    uint64_t iterations = 1;
+    while (true) {
+        auto start = Clock::now();
+        sink = body(iterations);
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        if (seconds >= min_seconds / 10 || iterations >= (1ull << 40)) {
+            iterations = static_cast<uint64_t>(iterations * (min_seconds / std::max(seconds, 1e-9)) / 3) + 1;
+            break;
+        }
+        iterations *= 4;
+    }
+
+    BenchResult result = {name, 1e300, 0};
+    for (int run = 0; run < 3; ++run) {
+        uint64_t allocations_before = allocation_count.load(std::memory_order_relaxed);
+        auto start = Clock::now();
+        sink = body(iterations);
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        uint64_t allocations = allocation_count.load(std::memory_order_relaxed) - allocations_before;
+
+        double ops = static_cast<double>(iterations * ops_per_call);
+        result.ns_per_op = std::min(result.ns_per_op, ns / ops);
+        result.allocs_per_op = allocations / ops;
+    }
+    return result;
+}
+
+// ==================== Входные данные ====================
+
+static Protocol::GameState make_game_state() {
+    Protocol::GameState state;
+    state.display_word = "*ro*ra**in*";
+    state.errors_left = 4;
+    state.status = Protocol::GameStatus::IN_PROGRESS;
+    state.additional_info = "Correct! Wrong letters: e, s";
+    return state;
+}
+
+static Protocol::CompactState make_compact_state() {
+    Protocol::CompactState state;
+    state.word_length = 11;
+    state.errors_left = 4;
+    state.status = Protocol::GameStatus::IN_PROGRESS;
+    state.code = Protocol::StateCode::CORRECT;
+    state.guessed_mask = (1u << ('r' - 'a')) | (1u << ('e' - 'a'));
+    state.wrong_mask = 1u << ('e' - 'a');
+    state.base_sequence = 7;
+    state.changed_positions = (1ull << 1) | (1ull << 4);
+    state.letters = "rr";
+    return state;
+}
+
+// Файл-сокет во временном каталоге: на POSIX запись и чтение идут через
+// постоянный дескриптор, как у сервера и клиента
+static bool prepare_socket_file(std::filesystem::path& directory) {
+    std::error_code error;
+    directory = std::filesystem::temp_directory_path(error) / "hangman_micro_bench";
+    if (error) {
+        return false;
+    }
+    std::filesystem::create_directories(directory, error);
+    std::filesystem::current_path(directory, error);
+    if (error) {
+        return false;
+    }
+    std::ofstream file(IPC::SOCKET_FILE, std::ios::binary | std::ios::trunc);
+    std::vector<char> zeros(IPC::CHUNK_SIZE, 0);
+    file.write(zeros.data(), static_cast<std::streamsize>(zeros.size()));
+    return static_cast<bool>(file);
+}
+
+static std::vector<BenchResult> run_all(const std::string& filter, double min_seconds,
+                                        const std::vector<std::string>& words,
+                                        const std::shared_ptr<const GameLogic::WordSnapshot>& snapshot) {
+    const GameLogic::WordSelector& selector = *snapshot->selector;
+    std::vector<BenchResult> results;
+    auto add = [&](const std::string& name, uint64_t ops_per_call, auto body) {
+        if (name.find(filter) == std::string::npos) {
+            return;
+        }
+        results.push_back(run_benchmark(name, ops_per_call, min_seconds, body));
+        std::fprintf(stderr, ".");
+    };
+
+    const Protocol::GameState game_state = make_game_state();
+    const Protocol::GameStateView state_view = Protocol::make_game_state_view(game_state);
+    const Protocol::CompactState compact_state = make_compact_state();
+    const Protocol::CompactStateView compact_view = Protocol::make_compact_state_view(compact_state);
+
+    uint8_t buffer[IPC::MAX_MESSAGE_SIZE];
+    Protocol::MutableByteSpan out{buffer, sizeof(buffer)};
+
+    uint8_t pong[IPC::MAX_MESSAGE_SIZE];
+    size_t pong_size = Protocol::encode_pong(Protocol::MutableByteSpan{pong, sizeof(pong)}, 42, 7, state_view,
+                                             Protocol::ChecksumType::CRC32C);
+    Protocol::MessageView pong_message;
+    Protocol::decode_message(Protocol::ByteSpan{pong, pong_size}, pong_message);
+    std::vector<uint8_t> pong_payload(pong_message.payload.data, pong_message.payload.data + pong_message.payload.size);
+
+    // serialize_game_state / create_pong_message - теперь кодек пишет сообщение в буфер
+    add("protocol/encode_pong", 1, [&](uint64_t n) {
+        uint64_t total = 0;
+        for (uint64_t i = 0; i < n; ++i) {
+            total += Protocol::encode_pong(out, 42, static_cast<uint32_t>(i), state_view, Protocol::ChecksumType::CRC32C);
+        }
+        return total;
+    });
+    add("protocol/encode_compact_pong", 1, [&](uint64_t n) {
+        uint64_t total = 0;
+        for (uint64_t i = 0; i < n; ++i) {
+            total += Protocol::encode_compact_pong(out, 42, static_cast<uint32_t>(i), compact_view,
+                                                   Protocol::ChecksumType::CRC32C);
+        }
+        return total;
+    });
+    // create_ping_message
+    add("protocol/encode_ping", 1, [&](uint64_t n) {
+        uint64_t total = 0;
+        for (uint64_t i = 0; i < n; ++i) {
+            total += Protocol::encode_ping(out, 42, static_cast<uint32_t>(i), "e", Protocol::ChecksumType::CRC32C, 6);
+        }
+        return total;
+    });
+    // deserialize_game_state: разбор сообщения и представление состояния
+    add("protocol/decode_pong", 1, [&](uint64_t n) {
+        uint64_t total = 0;
+        for (uint64_t i = 0; i < n; ++i) {
+            Protocol::MessageView message;
+            Protocol::GameStateView state;
+            if (Protocol::decode_message(Protocol::ByteSpan{pong, pong_size}, message) &&
+                Protocol::decode_game_state(message.payload, state)) {
+                total += state.display_word.size();
+            }
+        }
+        return total;
+    });
+    // Прежний разбор в std::string - для сравнения выделений
+    add("protocol/parse_pong_payload", 1, [&](uint64_t n) {
+        uint64_t total = 0;
+        for (uint64_t i = 0; i < n; ++i) {
+            total += Protocol::parse_pong_payload(pong_payload).display_word.size();
+        }
+        return total;
+    });
+    add("protocol/checksum_xor", 1, [&](uint64_t n) {
+        uint64_t total = 0;
+        for (uint64_t i = 0; i < n; ++i) {
+            total += Protocol::calculate_checksum(pong_message.header, pong_message.payload, Protocol::ChecksumType::XOR);
+        }
+        return total;
+    });
+    add("protocol/checksum_crc32c", 1, [&](uint64_t n) {
+        uint64_t total = 0;
+        for (uint64_t i = 0; i < n; ++i) {
+            total += Protocol::calculate_checksum(pong_message.header, pong_message.payload, Protocol::ChecksumType::CRC32C);
+        }
+        return total;
+    });
+
+    std::filesystem::path directory;
+    std::filesystem::path original_directory = std::filesystem::current_path();
+    if ((std::string("ipc/region_write_read").find(filter) != std::string::npos ||
+         std::string("ipc/server_pass_file").find(filter) != std::string::npos ||
+         std::string("ipc/server_pass_uring").find(filter) != std::string::npos) &&
+        prepare_socket_file(directory)) {
+        // Слот 1 занят статистикой сервера
+        const uint32_t offset = IPC::get_client_to_server_offset(2);
+        const uint32_t half_size = IPC::RING_CONTROL_SIZE + IPC::RING_CAPACITY;
+        const char* message_data = reinterpret_cast<const char*>(pong);
+        char message[IPC::MAX_MESSAGE_SIZE];
+        add("ipc/region_write_read", 1, [&](uint64_t n) {
+            uint64_t total = 0;
+            for (uint64_t i = 0; i < n; ++i) {
+                FileSocket::write_to_region_impl(IPC::SOCKET_FILE, offset, message_data, pong_size);
+                total += FileSocket::read_from_region_impl(IPC::SOCKET_FILE, offset, half_size, message, sizeof(message));
+            }
+            return total;
+        });
+
+        // Проход сервера по PASS_SLOTS слотам: сообщение из каждого и ответ в каждый.
+        // Сторона клиентов (запись сообщений, чтение ответов) в обоих вариантах одна и та же.
+        const uint32_t PASS_SLOTS = 32;
+        uint32_t slots[PASS_SLOTS];
+        for (uint32_t i = 0; i < PASS_SLOTS; ++i) {
+            slots[i] = 2 + i;
+        }
+        auto clients_send = [&] {
+            for (uint32_t slot : slots) {
+                FileSocket::write_to_region_impl(IPC::SOCKET_FILE, IPC::get_client_to_server_offset(slot),
+                                                 message_data, pong_size);
+            }
+        };
+        auto clients_receive = [&] {
+            uint64_t total = 0;
+            for (uint32_t slot : slots) {
+                total += FileSocket::read_from_region_impl(IPC::SOCKET_FILE, IPC::get_server_to_client_offset(slot),
+                                                           half_size, message, sizeof(message));
+            }
+            return total;
+        };
+        // Заголовок файла создаётся до проходов, а не посреди первого из них
+        FileSocket::get_socket_header();
+
+        add("ipc/server_pass_file", PASS_SLOTS, [&](uint64_t n) {
+            uint64_t total = 0;
+            for (uint64_t i = 0; i < n; ++i) {
+                clients_send();
+                for (uint32_t slot : slots) {
+                    total += FileSocket::read_from_region_impl(IPC::SOCKET_FILE, IPC::get_client_to_server_offset(slot),
+                                                               half_size, message, sizeof(message));
+                    FileSocket::write_to_region_impl(IPC::SOCKET_FILE, IPC::get_server_to_client_offset(slot),
+                                                     message_data, pong_size);
+                }
+                total += clients_receive();
+            }
+            return total;
+        });
+
+        if (FileSocket::UringQueue::is_supported()) {
+            FileSocket::BatchedRegions batch;
+            add("ipc/server_pass_uring", PASS_SLOTS, [&](uint64_t n) {
+                uint64_t total = 0;
+                for (uint64_t i = 0; i < n; ++i) {
+                    clients_send();
+                    batch.fetch(slots, PASS_SLOTS);
+                    for (uint32_t slot : slots) {
+                        size_t size = 0;
+                        while (batch.read(slot, message, sizeof(message), size) ==
+                               FileSocket::BatchedRegions::SlotRead::MESSAGE) {
+                            total += size;
+                            batch.write(slot, 42, message_data, pong_size);
+                        }
+                    }
+                    batch.flush();
+                    total += clients_receive();
+                }
+                return total;
+            });
+        }
+        std::error_code error;
+        std::filesystem::current_path(original_directory, error);
+        std::filesystem::remove_all(directory, error);
+    }
+
+    // Полная партия - 26 вызовов guess_letter
+    const std::string alphabet = "etaoinshrdlcumwfgypbvkjxqz";
+    add("game/guess_letter", alphabet.size(), [&](uint64_t n) {
+        GameLogic::HangmanGame game;
+        uint64_t total = 0;
+        for (uint64_t i = 0; i < n; ++i) {
+            game.start_new_game(words[i % words.size()], 26);
+            for (char letter : alphabet) {
+                total += game.guess_letter(letter);
+            }
+        }
+        return total;
+    });
+    add("game/start_new_game", 1, [&](uint64_t n) {
+        GameLogic::HangmanGame game;
+        uint64_t total = 0;
+        for (uint64_t i = 0; i < n; ++i) {
+            game.start_new_game(words[i % words.size()]);
+            total += game.get_display_word().size();
+        }
+        return total;
+    });
+    add("game/get_random_word", 1, [&](uint64_t n) {
+        uint64_t total = 0;
+        for (uint64_t i = 0; i < n; ++i) {
+            total += GameLogic::Dictionary::get_random_word(words).size();
+        }
+        return total;
+    });
+    add("game/selector_pick", 1, [&](uint64_t n) {
+        uint64_t total = 0;
+        for (uint64_t i = 0; i < n; ++i) {
+            total += selector.pick(static_cast<uint8_t>(i % 4)).size();
+        }
+        return total;
+    });
+
+    // Таблица сессий сервера на SESSION_TABLE_SIZE записей: поиск по номеру и ход
+    const uint32_t SESSION_TABLE_SIZE = 1u << 20;
+    if (snapshot->dictionary.size() != 0 &&
+        (std::string("server/session_touch_guess").find(filter) != std::string::npos ||
+         std::string("server/session_create").find(filter) != std::string::npos)) {
+        SessionManager sessions;
+        std::vector<uint32_t> session_ids(SESSION_TABLE_SIZE);
+        for (uint32_t i = 0; i < SESSION_TABLE_SIZE; ++i) {
+            // Нечётный множитель - без повторов, разбросанные по диапазону номера
+            session_ids[i] = (i + 1) * 2654435761u;
+            sessions.create_session(session_ids[i], snapshot, selector.pick_index(0));
+        }
+        std::fprintf(stderr, "[%zu sessions: %.1f MB] ", sessions.get_session_count(),
+                     sessions.memory_bytes() / (1024.0 * 1024.0));
+
+        add("server/session_touch_guess", 1, [&](uint64_t n) {
+            uint64_t total = 0;
+            auto now = SessionManager::Clock::now();
+            for (uint64_t i = 0; i < n; ++i) {
+                uint32_t session_id = session_ids[(i * 7919) % SESSION_TABLE_SIZE];
+                GameSession session = sessions.touch_session(session_id, now);
+                total += session.apply_guess(alphabet[i % alphabet.size()]);
+            }
+            return total;
+        });
+        // Новая игра в существующей сессии: запись переиспользуется
+        add("server/session_create", 1, [&](uint64_t n) {
+            uint64_t total = 0;
+            for (uint64_t i = 0; i < n; ++i) {
+                uint32_t session_id = session_ids[(i * 7919) % SESSION_TABLE_SIZE];
+                total += sessions.create_session(session_id, snapshot, selector.pick_index(0)).get_session_id();
+            }
+            return total;
+        });
+    }
+
+    std::fprintf(stderr, "\n");
+    return results;
+}
+
+// ==================== JSON ====================
+
+static bool write_json(const std::string& filename, const std::vector<BenchResult>& results) {
+    FILE* file = filename == "-" ? stdout : std::fopen(filename.c_str(), "w");
+    if (file == nullptr) {
+        return false;
+    }
+    std::fprintf(file, "{\n  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); ++i) {
+        std::fprintf(file, "    {\"name\": \"%s\", \"ns_per_op\": %.3f, \"allocs_per_op\": %.3f}%s\n",
+                     results[i].name.c_str(), results[i].ns_per_op, results[i].allocs_per_op,
+                     i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(file, "  ]\n}\n");
+    if (file != stdout) {
+        std::fclose(file);
+    }
+    return true;
+}
+
+// Читает только то, что пишет write_json: объект на строку
+static bool read_json(const std::string& filename, std::map<std::string, BenchResult>& results) {
+    std::ifstream file(filename);
+    if (!file) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t name_pos = line.find("\"name\": \"");
+        size_t ns_pos = line.find("\"ns_per_op\": ");
+        size_t allocs_pos = line.find("\"allocs_per_op\": ");
+        if (name_pos == std::string::npos || ns_pos == std::string::npos || allocs_pos == std::string::npos) {
+            continue;
+        }
+        name_pos += std::strlen("\"name\": \"");
+        BenchResult result;
+        result.name = line.substr(name_pos, line.find('"', name_pos) - name_pos);
+        result.ns_per_op = std::strtod(line.c_str() + ns_pos + std::strlen("\"ns_per_op\": "), nullptr);
+        result.allocs_per_op = std::strtod(line.c_str() + allocs_pos + std::strlen("\"allocs_per_op\": "), nullptr);
+        results[result.name] = result;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    std::string filter;
+    std::string json_file;
+    std::string baseline_file;
+    std::string words_file = "resources/words.txt";
+    double threshold = 10;
+    double min_seconds = 0.2;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (value != nullptr && arg == "--filter") {
+            filter = value;
+        } else if (value != nullptr && arg == "--json") {
+            json_file = value;
+        } else if (value != nullptr && arg == "--baseline") {
+            baseline_file = value;
+        } else if (value != nullptr && arg == "--threshold") {
+            threshold = std::atof(value);
+        } else if (value != nullptr && arg == "--min-time") {
+            min_seconds = std::atof(value);
+        } else if (value != nullptr && arg == "--words") {
+            words_file = value;
+        } else {
+            std::printf("Usage: %s [--filter TEXT] [--json FILE|-] [--baseline FILE] [--threshold PCT]"
+                        " [--min-time S] [--words words.txt]\n", argv[0]);
+            return 1;
+        }
+        ++i;
+    }
+
+    std::map<std::string, BenchResult> baseline;
+    if (!baseline_file.empty() && !read_json(baseline_file, baseline)) {
+        std::printf("Error: cannot read baseline %s\n", baseline_file.c_str());
+        return 1;
+    }
+
+    // Слова словаря игры; без файла - небольшой встроенный список
+    std::vector<std::string> words = GameLogic::Dictionary::load_words(words_file);
+    if (words.empty()) {
+        words = {"algorithm", "hangman", "network", "python", "computer", "javascript", "database"};
+    }
+    auto snapshot = std::make_shared<GameLogic::WordSnapshot>();
+    if (!snapshot->dictionary.load_text(words_file)) {
+        snapshot->dictionary.open_compiled("resources/words.dict");
+    }
+    snapshot->selector = std::make_unique<GameLogic::WordSelector>(snapshot->dictionary);
+
+    std::vector<BenchResult> results = run_all(filter, min_seconds, words, snapshot);
+
+    // Регрессия - медленнее базы больше чем на threshold процентов или больше выделений
+    int regressions = 0;
+    std::printf("%-32s %12s %12s", "benchmark", "ns/op", "allocs/op");
+    if (!baseline.empty()) {
+        std::printf(" %12s %9s", "base ns/op", "change");
+    }
+    std::printf("\n");
+    for (const BenchResult& result : results) {
+        std::printf("%-32s %12.2f %12.2f", result.name.c_str(), result.ns_per_op, result.allocs_per_op);
+        auto base = baseline.find(result.name);
+        if (base != baseline.end()) {
+            double change = base->second.ns_per_op > 0
+                ? (result.ns_per_op - base->second.ns_per_op) * 100 / base->second.ns_per_op : 0;
+            bool regressed = change > threshold || result.allocs_per_op > base->second.allocs_per_op + 0.005;
+            regressions += regressed;
+            std::printf(" %12.2f %+8.1f%%%s", base->second.ns_per_op, change, regressed ? "  REGRESSION" : "");
+        } else if (!baseline.empty()) {
+            std::printf(" %12s", "new");
+        }
+        std::printf("\n");
+    }
+
+    if (!json_file.empty() && !write_json(json_file, results)) {
+        std::printf("Error: cannot write %s\n", json_file.c_str());
+        return 1;
+    }
+    if (regressions > 0) {
+        std::printf("%d regression(s) against %s\n", regressions, baseline_file.c_str());
+        return 1;
+    }
+    return 0;
+}
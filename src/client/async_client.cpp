@@ -0,0 +1,124 @@
+#include "async_client.hpp"
+#include "../game/game_logic.hpp"
+#include "../ipc/file_socket.hpp"
+#include <cassert>
+
+AsyncGameClient::AsyncGameClient(ClientLoop& loop, uint32_t session_id, uint8_t difficulty)
+    : loop_(loop), session_id_(session_id), sequence_number_(1), checksum_(Protocol::ChecksumType::XOR),
+      difficulty_(difficulty), acked_sequence_(0), in_flight_(false) {}
+
+AsyncGameClient::~AsyncGameClient() {
+    FileSocket::release_session(session_id_);
+}
+
+bool AsyncGameClient::connect() {
+    return FileSocket::connect_session(session_id_);
+}
+
+// Текст к коду исхода из COMPACT_STATE
+static std::string describe_state_code(const Protocol::CompactState& state) {
+    std::string wrong_letters = GameLogic::mask_letters(state.wrong_mask);
+    switch (state.code) {
+        case Protocol::StateCode::GAME_STARTED: return "Game started! Guess a letter.";
+        case Protocol::StateCode::CORRECT: return "Correct! Wrong letters: " + wrong_letters;
+        case Protocol::StateCode::WRONG: return "Wrong! Wrong letters: " + wrong_letters;
+        case Protocol::StateCode::REPEATED: return "Already guessed! Wrong letters: " + wrong_letters;
+        case Protocol::StateCode::WON: return "You won! The word was: " + state.secret_word;
+        case Protocol::StateCode::LOST: return "You lost! The word was: " + state.secret_word;
+    }
+    return "";
+}
+
+Protocol::GameState AsyncGameClient::apply_compact_state(const Protocol::CompactState& state, uint32_t sequence) {
+    // Полное состояние (base_sequence == 0) начинает слово заново, дельта дополняет известное
+    if (state.base_sequence == 0 || display_word_.size() != state.word_length) {
+        display_word_.assign(state.word_length, '*');
+    }
+
+    size_t letter = 0;
+    for (size_t i = 0; i < display_word_.size() && letter < state.letters.size(); ++i) {
+        if ((state.changed_positions >> i) & 1) {
+            display_word_[i] = state.letters[letter++];
+        }
+    }
+    acked_sequence_ = sequence;
+
+    Protocol::GameState game_state;
+    game_state.display_word = display_word_;
+    game_state.errors_left = state.errors_left;
+    game_state.status = state.status;
+    game_state.additional_info = describe_state_code(state);
+    return game_state;
+}
+
+Protocol::GameState AsyncGameClient::read_game_state(const Protocol::BinaryMessage& response) {
+    Protocol::CompactState compact_state;
+    if (Protocol::is_compact_pong_payload(response.payload) &&
+        Protocol::parse_compact_pong_payload(response.payload, compact_state)) {
+        return apply_compact_state(compact_state, response.header.sequence);
+    }
+    return Protocol::parse_pong_payload(response.payload);
+}
+
+Task<AsyncGameClient::Turn> AsyncGameClient::exchange(uint32_t sequence, bool sent) {
+    Turn turn;
+    if (!sent || !co_await loop_.receive(session_id_, sequence, OPERATION_TIMEOUT_MS, reply_)) {
+        co_return turn;
+    }
+    if (reply_.checksum == Protocol::ChecksumType::CRC32C) {
+        checksum_ = Protocol::ChecksumType::CRC32C;
+    }
+
+    turn.replied = true;
+    if (reply_.header.message_type != Protocol::MessageType::PONG) {
+        turn.state.errors_left = 0;
+        turn.state.status = Protocol::GameStatus::ERROR_STATE;
+        turn.state.additional_info = "Unexpected reply type";
+    } else if (!Protocol::is_batch_pong_payload(reply_.payload)) {
+        turn.state = read_game_state(reply_);
+    } else {
+        Protocol::BatchResult result = Protocol::parse_batch_pong_payload(reply_.payload);
+        turn.outcomes = std::move(result.outcomes);
+        turn.state = result.compact ? apply_compact_state(result.compact_state, reply_.header.sequence)
+                                    : std::move(result.state);
+    }
+    co_return turn;
+}
+
+// Ход сессии в полёте - от отправки до ответа или таймаута
+AsyncGameClient::InFlight::InFlight(bool& flag) : flag_(flag) {
+    assert(!flag_ && "one outstanding request per session");
+    flag_ = true;
+}
+
+AsyncGameClient::InFlight::~InFlight() {
+    flag_ = false;
+}
+
+// Номер и отправка - при первом возобновлении, а не при создании задачи: иначе
+// ответ на запрос, который ещё никто не ждёт, отбросил бы чужой take_reply
+Task<AsyncGameClient::Turn> AsyncGameClient::start() {
+    InFlight in_flight(in_flight_);
+    acked_sequence_ = 0;
+    uint32_t sequence = sequence_number_++;
+    bool sent = Protocol::send_binary_start(session_id_, sequence, difficulty_, checksum_);
+    co_return co_await exchange(sequence, sent);
+}
+
+Task<AsyncGameClient::Turn> AsyncGameClient::guess(char letter) {
+    InFlight in_flight(in_flight_);
+    uint32_t sequence = sequence_number_++;
+    bool sent = Protocol::send_binary_ping(session_id_, sequence, std::string(1, letter), checksum_,
+                                           acked_sequence_);
+    co_return co_await exchange(sequence, sent);
+}
+
+Task<AsyncGameClient::Turn> AsyncGameClient::guess(std::string letters) {
+    if (letters.length() == 1) {
+        co_return co_await guess(letters[0]);
+    }
+    InFlight in_flight(in_flight_);
+    uint32_t sequence = sequence_number_++;
+    bool sent = Protocol::send_binary_guess_batch(session_id_, sequence, letters, checksum_, acked_sequence_);
+    co_return co_await exchange(sequence, sent);
+}
@@ -0,0 +1,72 @@
+#ifndef ASYNC_CLIENT_HPP
+#define ASYNC_CLIENT_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "client_loop.hpp"
+#include "task.hpp"
+#include "../protocol/protocol.hpp"
+
+// Одна сессия игры поверх ClientLoop: каждый ход - co_await, поток при этом
+// ведёт остальные сессии цикла.
+//   Turn turn = co_await client.guess('e');
+// Задачи start/guess ленивые: запрос уходит при первом co_await, не при вызове.
+// У сессии не больше одного хода в полёте - следующий ход ждут только после
+// того, как завершился предыдущий (нарушение ловит assert); ответы с чужим
+// sequence отбрасываются, поэтому параллельный второй ход потерял бы ответ.
+class AsyncGameClient {
+public:
+    struct Turn {
+        bool replied = false;           // false - не отправлено или нет ответа за OPERATION_TIMEOUT_MS
+        Protocol::GameState state;
+        std::vector<uint8_t> outcomes;  // исходы букв пакета (Protocol::GuessOutcome)
+    };
+
+    static constexpr int OPERATION_TIMEOUT_MS = 10000;
+
+private:
+    ClientLoop& loop_;
+    uint32_t session_id_;
+    uint32_t sequence_number_;
+    // XOR, пока сервер не ответил с CRC32C
+    Protocol::ChecksumType checksum_;
+    uint8_t difficulty_;        // Protocol::Difficulty, запрашивается в каждом start
+    // Состояние, собранное из COMPACT_STATE, и sequence последнего применённого ответа
+    std::string display_word_;
+    uint32_t acked_sequence_;
+    Protocol::BinaryMessage reply_;
+    bool in_flight_;
+
+    class InFlight {
+    private:
+        bool& flag_;
+
+    public:
+        explicit InFlight(bool& flag);
+        ~InFlight();
+    };
+
+    Protocol::GameState apply_compact_state(const Protocol::CompactState& state, uint32_t sequence);
+    Protocol::GameState read_game_state(const Protocol::BinaryMessage& response);
+    Task<Turn> exchange(uint32_t sequence, bool sent);
+
+public:
+    AsyncGameClient(ClientLoop& loop, uint32_t session_id, uint8_t difficulty = Protocol::Difficulty::ANY);
+    ~AsyncGameClient();
+
+    uint32_t session_id() const { return session_id_; }
+    // Занимает слот файла-сокета; false - свободных слотов нет
+    bool connect();
+
+    // Новая игра (и в уже начатой сессии)
+    Task<Turn> start();
+    Task<Turn> guess(char letter);
+    // Несколько букв одним пакетом (не больше Protocol::MAX_BATCH_LETTERS)
+    Task<Turn> guess(std::string letters);
+
+    AsyncGameClient(const AsyncGameClient&) = delete;
+    AsyncGameClient& operator=(const AsyncGameClient&) = delete;
+};
+
+#endif
@@ -0,0 +1,132 @@
+#include "client_loop.hpp"
+#include "../ipc/file_socket.hpp"
+#include "../protocol/codec.hpp"
+#include <thread>
+
+ClientLoop::Wait::Wait(ClientLoop& loop, uint32_t session_id, uint32_t sequence, int timeout_ms,
+                       Protocol::BinaryMessage* reply)
+    : loop_(loop),
+      session_id_(session_id),
+      sequence_(sequence),
+      doorbell_(session_id != 0 ? FileSocket::client_doorbell(session_id) : FileSocket::Doorbell(nullptr, nullptr)),
+      seen_(0),
+      checked_(false),
+      deadline_(Clock::now() + std::chrono::milliseconds(timeout_ms)),
+      reply_(reply),
+      received_(false) {}
+
+void ClientLoop::Wait::await_suspend(std::coroutine_handle<> handle) {
+    handle_ = handle;
+    loop_.waits_.push_back(this);
+}
+
+void ClientLoop::spawn(Task<void> task) {
+    ready_.push_back(task.handle_);
+    tasks_.push_back(std::move(task));
+}
+
+// Регион читается, только если звонок сессии изменился с прошлой проверки
+// (без отображённого заголовка звонков нет - тогда на каждом проходе)
+bool ClientLoop::take_reply(Wait& wait) {
+    uint32_t doorbell = wait.doorbell_.value();
+    if (wait.checked_ && wait.doorbell_.is_valid() && doorbell == wait.seen_) {
+        return false;
+    }
+    wait.seen_ = doorbell;
+    wait.checked_ = true;
+
+    uint8_t buffer[IPC::MAX_MESSAGE_SIZE];
+    size_t size;
+    while ((size = FileSocket::read_from_server_region(wait.session_id_, reinterpret_cast<char*>(buffer),
+                                                       sizeof(buffer))) != 0) {
+        Protocol::MessageView message;
+        if (!Protocol::decode_message(Protocol::ByteSpan{buffer, size}, message) ||
+            message.header.session_id != wait.session_id_ || message.header.sequence != wait.sequence_) {
+            continue;
+        }
+        wait.reply_->header = message.header;
+        wait.reply_->checksum = message.checksum;
+        wait.reply_->payload.assign(message.payload.data, message.payload.data + message.payload.size);
+        return true;
+    }
+    return false;
+}
+
+// Завершает ожидания с ответом или истёкшим таймаутом; true - хоть одно завершилось
+bool ClientLoop::poll() {
+    bool progressed = false;
+    Clock::time_point now = Clock::now();
+    for (size_t i = 0; i < waits_.size();) {
+        Wait* wait = waits_[i];
+        if (wait->session_id_ != 0 && take_reply(*wait)) {
+            wait->received_ = true;
+        } else if (now < wait->deadline_) {
+            ++i;
+            continue;
+        }
+        ready_.push_back(wait->handle_);
+        waits_[i] = waits_.back();
+        waits_.pop_back();
+        progressed = true;
+    }
+    return progressed;
+}
+
+void ClientLoop::block() {
+    Clock::time_point deadline = waits_.front()->deadline_;
+    Wait* session_wait = nullptr;
+    size_t session_waits = 0;
+    for (Wait* wait : waits_) {
+        if (wait->deadline_ < deadline) {
+            deadline = wait->deadline_;
+        }
+        if (wait->session_id_ != 0) {
+            session_wait = session_wait != nullptr ? session_wait : wait;
+            ++session_waits;
+        }
+    }
+
+    auto left = std::chrono::ceil<std::chrono::milliseconds>(deadline - Clock::now());
+    int timeout_ms = left.count() > 0 ? static_cast<int>(left.count()) : 0;
+    if (session_waits > 1 && timeout_ms > POLL_INTERVAL_MS) {
+        timeout_ms = POLL_INTERVAL_MS;
+    }
+    if (session_wait != nullptr) {
+        session_wait->doorbell_.wait(session_wait->seen_, timeout_ms);
+    } else if (timeout_ms > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+    }
+}
+
+void ClientLoop::run() {
+    while (true) {
+        while (!ready_.empty()) {
+            std::coroutine_handle<> handle = ready_.front();
+            ready_.pop_front();
+            handle.resume();
+        }
+
+        for (size_t i = 0; i < tasks_.size();) {
+            if (!tasks_[i].done()) {
+                ++i;
+                continue;
+            }
+            Task<void> task = std::move(tasks_[i]);
+            tasks_[i] = std::move(tasks_.back());
+            tasks_.pop_back();
+            if (task.handle_.promise().exception) {
+                // Ожидания оставшихся задач уничтожаются вместе с ними
+                waits_.clear();
+                tasks_.clear();
+                std::rethrow_exception(task.handle_.promise().exception);
+            }
+        }
+        if (tasks_.empty() || waits_.empty()) {
+            return;
+        }
+
+        if (!poll()) {
+            block();
+        }
+    }
+}
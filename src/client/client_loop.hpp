@@ -0,0 +1,78 @@
+#ifndef CLIENT_LOOP_HPP
+#define CLIENT_LOOP_HPP
+
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include "task.hpp"
+#include "../ipc/notify.hpp"
+#include "../protocol/protocol.hpp"
+
+// Цикл событий клиента: в одном потоке ведёт сколько угодно сессий. Корутина,
+// ждущая ответа, стоит в списке ожиданий; проход цикла сверяет звонки их
+// сессий с последними виденными значениями и читает регион только той
+// сессии, чей звонок изменился. Когда никто не продвинулся, цикл спит на
+// звонке одной из сессий (или до ближайшего таймаута), при нескольких
+// ожидающих - не дольше POLL_INTERVAL_MS: звонка "любой из сессий" в файле нет.
+class ClientLoop {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    // Ожидание ответа с заданным sequence; session_id == 0 - просто таймер
+    class Wait {
+    private:
+        friend class ClientLoop;
+
+        ClientLoop& loop_;
+        uint32_t session_id_;
+        uint32_t sequence_;
+        FileSocket::Doorbell doorbell_;
+        uint32_t seen_;
+        bool checked_;
+        Clock::time_point deadline_;
+        Protocol::BinaryMessage* reply_;
+        bool received_;
+        std::coroutine_handle<> handle_;
+
+        Wait(ClientLoop& loop, uint32_t session_id, uint32_t sequence, int timeout_ms,
+             Protocol::BinaryMessage* reply);
+
+    public:
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle);
+        // true - пришёл ответ; false - таймаут
+        bool await_resume() const noexcept { return received_; }
+    };
+
+private:
+    static constexpr int POLL_INTERVAL_MS = 1;
+
+    std::vector<Task<void>> tasks_;
+    std::deque<std::coroutine_handle<>> ready_;
+    std::vector<Wait*> waits_;
+
+    bool take_reply(Wait& wait);
+    bool poll();
+    void block();
+
+public:
+    ClientLoop() = default;
+
+    // Задача начнёт выполняться в run()
+    void spawn(Task<void> task);
+    // Выполняет задачи, пока все не завершатся; исключение задачи выходит отсюда
+    void run();
+
+    // Ответы на запросы, по которым уже истёк таймаут, пропускаются
+    Wait receive(uint32_t session_id, uint32_t sequence, int timeout_ms, Protocol::BinaryMessage& reply) {
+        return Wait(*this, session_id, sequence, timeout_ms, &reply);
+    }
+    Wait sleep(int timeout_ms) { return Wait(*this, 0, 0, timeout_ms, nullptr); }
+
+    ClientLoop(const ClientLoop&) = delete;
+    ClientLoop& operator=(const ClientLoop&) = delete;
+};
+
+#endif
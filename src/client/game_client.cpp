@@ -1,21 +1,17 @@
 #include "game_client.hpp"
+#include "../ipc/file_socket.hpp"
 #include <iostream>
 #include <string>
 #include <vector>
 #include <algorithm>
 #include <chrono>
+#include <memory>
 #include <random>
-#include <thread>
-#include <functional>
+#include <unordered_set>
 #include <cctype>
 
-#ifdef _WIN32
-#include <windows.h>
-#else
-#include <unistd.h>
-#endif
-
-GameClient::GameClient() : session_id_(gen_session_id()), sequence_number_(1) {}
+GameClient::GameClient(uint8_t difficulty)
+    : difficulty_(difficulty), client_(loop_, gen_session_id(), difficulty) {}
 
 void GameClient::display_game_state(const Protocol::GameState& game_state) {
     std::cout << "\n=== HANGMAN GAME ===" << std::endl;
@@ -47,105 +43,106 @@ void GameClient::display_game_state(const Protocol::GameState& game_state) {
     std::cout << "====================" << std::endl;
 }
 
-bool GameClient::start_new_game() {
+Task<bool> GameClient::start_new_game() {
     for (int attempt = 0; attempt < CONNECTION_RETRIES; ++attempt) {
         std::cout << "Starting new game (attempt " << (attempt + 1) << ")..." << std::endl;
         
-        if (!Protocol::send_binary_ping(session_id_, sequence_number_++, "start")) {
-            std::cout << "Failed to send start request!" << std::endl;
-            if (attempt < CONNECTION_RETRIES - 1) {
-                sleep_ms(1000 * (attempt + 1));
-                continue;
-            }
-            return false;
-        }
-        
-        auto binary_response = Protocol::receive_binary_message(session_id_, OPERATION_TIMEOUT_MS);
-        
-        if (binary_response.header.session_id != 0) {
-            if (binary_response.header.message_type == Protocol::MessageType::PONG) {
-                auto game_state = Protocol::parse_pong_payload(binary_response.payload);
-                
-                if (game_state.status == Protocol::GameStatus::ERROR_STATE) {
-                    std::cout << "Server error: " << game_state.additional_info << std::endl;
-                    return false;
-                }
-
-                guessed_letters_.clear();
-                display_game_state(game_state);
-                return true;
+        AsyncGameClient::Turn turn = co_await client_.start();
+        if (turn.replied) {
+            if (turn.state.status == Protocol::GameStatus::ERROR_STATE) {
+                std::cout << "Server error: " << turn.state.additional_info << std::endl;
+                co_return false;
             }
+            
+            guessed_letters_.clear();
+            display_game_state(turn.state);
+            co_return true;
         }
         
         std::cout << "No response from server, retrying..." << std::endl;
         if (attempt < CONNECTION_RETRIES - 1) {
-            sleep_ms(1000 * (attempt + 1));
+            co_await loop_.sleep(1000 * (attempt + 1));
         }
     }
     
     std::cout << "Failed to start game after " << CONNECTION_RETRIES << " attempts" << std::endl;
-    return false;
+    co_return false;
 }
 
-bool GameClient::make_guess(char letter) {
-    std::string letter_str(1, letter);
-    
-    if (!Protocol::send_binary_ping(session_id_, sequence_number_++, letter_str)) {
-        std::cout << "Failed to send guess!" << std::endl;
-        return false;
+Task<bool> GameClient::make_guess(const std::string& letters) {
+    // Несколько букв уходят одним пакетом и получают один ответ
+    AsyncGameClient::Turn turn = co_await client_.guess(letters);
+    if (!turn.replied) {
+        std::cout << "No response from server!" << std::endl;
+        co_return false;
     }
     
-    auto binary_response = Protocol::receive_binary_message(session_id_, OPERATION_TIMEOUT_MS);
-    
-    if (binary_response.header.session_id == 0) {
-        std::cout << "No response from server!" << std::endl;
-        return false;
+    if (letters.length() > 1 && turn.state.status != Protocol::GameStatus::ERROR_STATE) {
+        for (size_t i = 0; i < turn.outcomes.size() && i < letters.length(); ++i) {
+            std::cout << letters[i] << ": ";
+            switch (turn.outcomes[i]) {
+                case Protocol::GuessOutcome::CORRECT: std::cout << "correct"; break;
+                case Protocol::GuessOutcome::WRONG: std::cout << "wrong"; break;
+                case Protocol::GuessOutcome::REPEATED: std::cout << "already guessed"; break;
+                default: std::cout << "unknown";
+            }
+            std::cout << std::endl;
+        }
+        if (turn.outcomes.size() < letters.length()) {
+            std::cout << "Skipped " << (letters.length() - turn.outcomes.size())
+                      << " letter(s): the game is over" << std::endl;
+        }
     }
+    co_return co_await handle_game_state(turn.state);
+}
+
+Task<bool> GameClient::handle_game_state(const Protocol::GameState& game_state) {
+    display_game_state(game_state);
     
-    if (binary_response.header.message_type == Protocol::MessageType::PONG) {
-        auto game_state = Protocol::parse_pong_payload(binary_response.payload);
-        display_game_state(game_state);
+    if (game_state.status == Protocol::GameStatus::WIN || 
+        game_state.status == Protocol::GameStatus::LOSE) {
         
-        if (game_state.status == Protocol::GameStatus::WIN || 
-            game_state.status == Protocol::GameStatus::LOSE) {
-            
-            std::cout << "\n*** GAME OVER ***" << std::endl;
-            if (game_state.status == Protocol::GameStatus::WIN) {
-                std::cout << "Congratulations! You won!" << std::endl;
-            } else {
-                std::cout << "Game over! Better luck next time!" << std::endl;
-            }
-            
-            std::cout << "\nPlay again? (y/n): ";
-            std::string choice;
-            std::getline(std::cin, choice);
-            
-            if (choice == "y" || choice == "Y") {
-                sequence_number_ = 1;
-                guessed_letters_.clear();
-                return start_new_game();
-            } else {
-                return false;
-            }
+        std::cout << "\n*** GAME OVER ***" << std::endl;
+        if (game_state.status == Protocol::GameStatus::WIN) {
+            std::cout << "Congratulations! You won!" << std::endl;
+        } else {
+            std::cout << "Game over! Better luck next time!" << std::endl;
+        }
+        
+        std::cout << "\nPlay again? (y/n): ";
+        std::string choice;
+        std::getline(std::cin, choice);
+        
+        if (choice == "y" || choice == "Y") {
+            guessed_letters_.clear();
+            co_return co_await start_new_game();
+        } else {
+            co_return false;
         }
     }
     
-    return true;
+    co_return true;
 }
 
-void GameClient::play_game() {
-    std::cout << "Welcome to Hangman! Session ID: " << session_id_ << std::endl;
+// Ввод блокирует цикл, но кроме этой сессии в нём никого нет
+Task<void> GameClient::play_session() {
+    std::cout << "Welcome to Hangman! Session ID: " << client_.session_id() << std::endl;
     std::cout << "Using binary protocol..." << std::endl;
     
+    if (!client_.connect()) {
+        std::cout << "No free session slots on the server!" << std::endl;
+        co_return;
+    }
+    
     // Начинаем игру
-    if (!start_new_game()) {
+    if (!co_await start_new_game()) {
         std::cout << "Failed to start game!" << std::endl;
-        return;
+        co_return;
     }
     
     // Игровой цикл
     while (true) {
-        std::cout << "\nEnter a letter (or 'quit' to exit): ";
+        std::cout << "\nEnter a letter or several letters (or 'quit' to exit): ";
         std::string input;
         std::getline(std::cin, input);
         
@@ -154,30 +151,141 @@ void GameClient::play_game() {
             break;
         }
         
-        if (input.length() != 1) {
-            std::cout << "Please enter exactly one letter!" << std::endl;
+        // Строка из нескольких букв отправляется одним пакетом
+        if (input.empty() || input.length() > Protocol::MAX_BATCH_LETTERS) {
+            std::cout << "Please enter from 1 to " << Protocol::MAX_BATCH_LETTERS << " letters!" << std::endl;
             continue;
         }
         
-        char letter = input[0];
-        if (!std::isalpha(letter)) {
+        if (!std::all_of(input.begin(), input.end(), [](char c) { return std::isalpha(static_cast<unsigned char>(c)) != 0; })) {
             std::cout << "Please enter a valid letter (a-z)!" << std::endl;
             continue;
         }
         
-        // Добавляем букву в список использованных
-        if (std::find(guessed_letters_.begin(), guessed_letters_.end(), letter) == guessed_letters_.end()) {
-            guessed_letters_.push_back(letter);
+        // Добавляем буквы в список использованных
+        for (char letter : input) {
+            if (std::find(guessed_letters_.begin(), guessed_letters_.end(), letter) == guessed_letters_.end()) {
+                guessed_letters_.push_back(letter);
+            }
         }
         
-        // Отправляем букву на сервер
-        if (!make_guess(letter)) {
+        // Отправляем буквы на сервер
+        if (!co_await make_guess(input)) {
             std::cout << "Game session ended." << std::endl;
             break;
         }
     }
 }
 
+void GameClient::play_game() {
+    loop_.spawn(play_session());
+    loop_.run();
+}
+
+// Сводка бота по всем сессиям
+struct BotTotals {
+    int games = 0;
+    int wins = 0;
+    int losses = 0;
+    int inconsistent = 0;   // ответы, противоречащие предыдущим
+    int unknown_words = 0;  // слова сервера нет в словаре бота
+    uint64_t guesses = 0;
+    uint64_t wrong_guesses = 0;
+    bool failed = false;    // какая-то сессия осталась без ответа
+};
+
+static bool valid_turn(const AsyncGameClient::Turn& turn) {
+    return turn.replied && turn.state.status != Protocol::GameStatus::ERROR_STATE;
+}
+
+// solver - своя копия на сессию (индекс словаря общий)
+static Task<void> play_bot_session(AsyncGameClient& client, WordSolver solver, int games, BotTotals& totals) {
+    for (int game = 0; game < games; ++game) {
+        AsyncGameClient::Turn turn = co_await client.start();
+        if (!valid_turn(turn)) {
+            std::cout << "Bot: no valid reply to start in game " << (game + 1) << " of session "
+                      << client.session_id() << std::endl;
+            totals.failed = true;
+            co_return;
+        }
+        solver.start(turn.state.display_word);
+        
+        while (turn.state.status == Protocol::GameStatus::IN_PROGRESS) {
+            char letter = solver.next_letter();
+            if (letter == 0) {
+                ++totals.inconsistent;
+                break;
+            }
+            
+            turn = co_await client.guess(letter);
+            if (!valid_turn(turn)) {
+                std::cout << "Bot: no valid reply to '" << letter << "' in game " << (game + 1) << " of session "
+                          << client.session_id() << std::endl;
+                totals.failed = true;
+                co_return;
+            }
+            ++totals.guesses;
+            if (!solver.apply(letter, turn.state.display_word)) {
+                ++totals.inconsistent;
+            }
+        }
+        
+        ++totals.games;
+        if (turn.state.status == Protocol::GameStatus::WIN) {
+            ++totals.wins;
+            if (turn.state.display_word.find('*') != std::string::npos) {
+                ++totals.inconsistent;
+            }
+        } else {
+            ++totals.losses;
+        }
+        totals.wrong_guesses += 6 - turn.state.errors_left;
+        if (solver.candidate_count() == 0) {
+            ++totals.unknown_words;
+        }
+    }
+}
+
+bool GameClient::play_bot(const WordSolver& solver, int games, int sessions) {
+    // Первая сессия - своя, остальные с неповторяющимися в процессе session_id
+    std::vector<std::unique_ptr<AsyncGameClient>> extra_clients;
+    std::vector<AsyncGameClient*> clients(1, &client_);
+    std::unordered_set<uint32_t> session_ids;
+    session_ids.insert(client_.session_id());
+    for (int i = 1; i < sessions; ++i) {
+        uint32_t session_id = gen_session_id();
+        while (!session_ids.insert(session_id).second) {
+            session_id = gen_session_id();
+        }
+        extra_clients.push_back(std::make_unique<AsyncGameClient>(loop_, session_id, difficulty_));
+        clients.push_back(extra_clients.back().get());
+    }
+    for (AsyncGameClient* client : clients) {
+        if (!client->connect()) {
+            std::cout << "No free session slots on the server!" << std::endl;
+            return false;
+        }
+    }
+    
+    BotTotals totals;
+    auto start = std::chrono::steady_clock::now();
+    for (AsyncGameClient* client : clients) {
+        loop_.spawn(play_bot_session(*client, solver, games, totals));
+    }
+    loop_.run();
+    
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Bot: " << totals.games << " games in " << sessions << " session(s), " << totals.wins << " won, "
+              << totals.losses << " lost, "
+              << (totals.games > 0 ? static_cast<double>(totals.wrong_guesses) / totals.games : 0)
+              << " wrong guesses per game" << std::endl;
+    std::cout << "Bot: " << totals.guesses << " guesses in " << seconds << " s ("
+              << (seconds > 0 ? totals.guesses / seconds : 0) << " guesses/s)" << std::endl;
+    std::cout << "Bot: " << totals.inconsistent << " inconsistent replies, " << totals.unknown_words
+              << " words not in the bot dictionary" << std::endl;
+    return !totals.failed && totals.inconsistent == 0;
+}
+
 uint32_t gen_session_id() {
     static std::random_device rd;
     static std::mt19937 gen(rd());
@@ -189,11 +297,3 @@ uint32_t gen_session_id() {
     
     return (static_cast<uint32_t>(time_ms) & 0xFFFF0000) | (dis(gen) & 0x0000FFFF);
 }
-
-void sleep_ms(int milliseconds) {
-#ifdef _WIN32
-    Sleep(milliseconds);
-#else
-    usleep(milliseconds * 1000);
-#endif
-}
@@ -5,25 +5,34 @@
 #include <vector>
 #include <string>
 #include "../protocol/protocol.hpp"
+#include "async_client.hpp"
+#include "client_loop.hpp"
+#include "word_solver.hpp"
 
+// Интерактивная игра и бот - обёртки над AsyncGameClient в собственном цикле
 class GameClient {
 private:
-    uint32_t session_id_;
-    uint32_t sequence_number_;
+    uint8_t difficulty_;
+    ClientLoop loop_;
+    AsyncGameClient client_;
     std::vector<char> guessed_letters_;
-    const int OPERATION_TIMEOUT_MS = 10000;
     const int CONNECTION_RETRIES = 3;
     
     void display_game_state(const Protocol::GameState& game_state);
-    bool start_new_game();
-    bool make_guess(char letter);
+    Task<bool> start_new_game();
+    Task<bool> make_guess(const std::string& letters);
+    Task<bool> handle_game_state(const Protocol::GameState& game_state);
+    Task<void> play_session();
     
 public:
-    GameClient();
+    explicit GameClient(uint8_t difficulty = Protocol::Difficulty::ANY);
     void play_game();
+    // Без ввода: буквы выбирает solver, games игр подряд в каждой из sessions
+    // сессий (все в одном потоке), в конце сводка.
+    // false - сервер не ответил или его ответы противоречили друг другу
+    bool play_bot(const WordSolver& solver, int games, int sessions = 1);
 };
 
 uint32_t gen_session_id();
-void sleep_ms(int milliseconds);
 
 #endif
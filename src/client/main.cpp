@@ -1,13 +1,66 @@
 #include "game_client.hpp"
+#include "word_solver.hpp"
+#include "../game/word_dictionary.hpp"
+#include "../ipc/ipc_common.hpp"
 #include <iostream>
+#include <string>
+#include <cstdlib>
 
-int main() {
+int main(int argc, char* argv[]) {
+    uint8_t difficulty = Protocol::Difficulty::ANY;
+    bool bot = false;
+    int games = 100;
+    int sessions = 1;
+    std::string dictionary_file = "resources/words.dict";
+    std::string text_file = "resources/words.txt";
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        std::string value = i + 1 < argc ? argv[i + 1] : "";
+        if (arg == "--difficulty" && (value == "easy" || value == "medium" || value == "hard")) {
+            difficulty = value == "easy" ? Protocol::Difficulty::EASY
+                       : value == "medium" ? Protocol::Difficulty::MEDIUM : Protocol::Difficulty::HARD;
+            ++i;
+        } else if (arg == "--bot") {
+            bot = true;
+        } else if (arg == "--games" && !value.empty()) {
+            games = std::atoi(value.c_str());
+            ++i;
+        } else if (arg == "--sessions" && !value.empty()) {
+            sessions = std::atoi(value.c_str());
+            if (sessions < 1 || sessions > IPC::MAX_SESSIONS) {
+                std::cout << "--sessions must be from 1 to " << IPC::MAX_SESSIONS << std::endl;
+                return 1;
+            }
+            ++i;
+        } else if (arg == "--dict" && !value.empty()) {
+            dictionary_file = value;
+            ++i;
+        } else if (arg == "--words" && !value.empty()) {
+            text_file = value;
+            ++i;
+        } else {
+            std::cout << "Usage: " << argv[0] << " [--difficulty easy|medium|hard]"
+                      << " [--bot [--games N] [--sessions N] [--dict words.dict] [--words words.txt]]" << std::endl;
+            return 1;
+        }
+    }
+    
     try {
-        GameClient client;
-        client.play_game();
+        GameClient client(difficulty);
+        if (!bot) {
+            client.play_game();
+            return 0;
+        }
+        
+        // Бот подбирает слова по тому же словарю, что и сервер; без словаря - по частоте букв
+        GameLogic::WordDictionary dictionary;
+        if (!dictionary.open_compiled(dictionary_file) && !dictionary.load_text(text_file)) {
+            std::cout << "Bot: no dictionary, guessing by letter frequency" << std::endl;
+        }
+        WordSolver solver(dictionary);
+        return client.play_bot(solver, games, sessions) ? 0 : 1;
     } catch (const std::exception& e) {
         std::cerr << "Client error: " << e.what() << std::endl;
         return 1;
     }
-    return 0;
 }
@@ -0,0 +1,93 @@
+#ifndef TASK_HPP
+#define TASK_HPP
+
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+// Корутина-задача клиента (C++20). Начинает выполняться при co_await (или в
+// ClientLoop::spawn), по завершении сразу возобновляет ждавшую её корутину.
+// Исключение из задачи выбрасывается в ждущем.
+template <typename T>
+class Task;
+
+template <typename T>
+struct TaskResult {
+    T value{};
+    void return_value(T result) { value = std::move(result); }
+    T take() { return std::move(value); }
+};
+
+template <>
+struct TaskResult<void> {
+    void return_void() {}
+    void take() {}
+};
+
+template <typename T>
+struct TaskPromise : TaskResult<T> {
+    std::coroutine_handle<> continuation;
+    std::exception_ptr exception;
+
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<TaskPromise> handle) noexcept {
+            std::coroutine_handle<> next = handle.promise().continuation;
+            return next ? next : std::noop_coroutine();
+        }
+        void await_resume() const noexcept {}
+    };
+
+    Task<T> get_return_object() { return Task<T>(std::coroutine_handle<TaskPromise>::from_promise(*this)); }
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() { exception = std::current_exception(); }
+};
+
+template <typename T>
+class Task {
+public:
+    typedef TaskPromise<T> promise_type;
+
+private:
+    std::coroutine_handle<promise_type> handle_;
+
+    friend class ClientLoop;
+
+public:
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle_) {
+                handle_.destroy();
+            }
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+    ~Task() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    bool done() const { return !handle_ || handle_.done(); }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle_.promise().continuation = awaiting;
+        return handle_;
+    }
+    T await_resume() {
+        if (handle_.promise().exception) {
+            std::rethrow_exception(handle_.promise().exception);
+        }
+        return handle_.promise().take();
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+};
+
+#endif
@@ -0,0 +1,230 @@
+#include "word_solver.hpp"
+#include <algorithm>
+#include <cctype>
+
+static const char FREQUENCY_ORDER[] = "etaoinshrdlcumwfgypbvkjxqz";
+
+static int popcount64(uint64_t value) {
+#ifdef __GNUC__
+    return __builtin_popcountll(value);
+#else
+    int count = 0;
+    for (; value != 0; value &= value - 1) {
+        ++count;
+    }
+    return count;
+#endif
+}
+
+// Подсчёт кандидатов с буквой - самый горячий цикл бота. Без -mpopcnt
+// __builtin_popcountll - вызов библиотечной функции, поэтому, как и CRC32C,
+// выбираем версию с инструкцией popcnt во время выполнения.
+typedef int (*CountFunction)(const uint64_t*, const uint64_t*, const std::vector<uint32_t>&);
+
+static int count_common_generic(const uint64_t* candidates, const uint64_t* set, const std::vector<uint32_t>& blocks) {
+    int count = 0;
+    for (uint32_t b : blocks) {
+        count += popcount64(candidates[b] & set[b]);
+    }
+    return count;
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+__attribute__((target("popcnt")))
+static int count_common_popcnt(const uint64_t* candidates, const uint64_t* set, const std::vector<uint32_t>& blocks) {
+    int count = 0;
+    for (uint32_t b : blocks) {
+        count += __builtin_popcountll(candidates[b] & set[b]);
+    }
+    return count;
+}
+
+static int count_common(const uint64_t* candidates, const uint64_t* set, const std::vector<uint32_t>& blocks) {
+    static const CountFunction implementation =
+        __builtin_cpu_supports("popcnt") ? count_common_popcnt : count_common_generic;
+    return implementation(candidates, set, blocks);
+}
+#else
+static int count_common(const uint64_t* candidates, const uint64_t* set, const std::vector<uint32_t>& blocks) {
+    return count_common_generic(candidates, set, blocks);
+}
+#endif
+
+// Номер буквы 0..25 без учёта регистра, -1 для остальных символов
+static int letter_index(char c) {
+    char lower = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return (lower >= 'a' && lower <= 'z') ? lower - 'a' : -1;
+}
+
+WordSolver::WordSolver(const GameLogic::WordDictionary& dictionary)
+    : dictionary_(dictionary), groups_(build_groups(dictionary)), group_(nullptr), guessed_mask_(0) {}
+
+// Два прохода по словарю: раскладка по длинам, затем биты позиций
+std::shared_ptr<const std::vector<WordSolver::LengthGroup>> WordSolver::build_groups(
+    const GameLogic::WordDictionary& dictionary) {
+    auto groups = std::make_shared<std::vector<LengthGroup>>(256);
+    for (size_t i = 0; i < dictionary.size(); ++i) {
+        (*groups)[dictionary.info(i).length].words.push_back(static_cast<uint32_t>(i));
+    }
+
+    for (size_t length = 0; length < groups->size(); ++length) {
+        LengthGroup& group = (*groups)[length];
+        group.blocks = (group.words.size() + 63) / 64;
+        group.bits.assign((length + 1) * 26 * group.blocks, 0);
+        std::fill(group.letter_counts, group.letter_counts + 26, 0);
+        for (size_t w = 0; w < group.words.size(); ++w) {
+            std::string_view word = dictionary.word(group.words[w]);
+            uint64_t bit = 1ull << (w % 64);
+            size_t block = w / 64;
+            for (size_t p = 0; p < word.size() && p < length; ++p) {
+                int letter = letter_index(word[p]);
+                if (letter < 0) {
+                    continue;
+                }
+                group.bits[(p * 26 + letter) * group.blocks + block] |= bit;
+                uint64_t& has = group.bits[(length * 26 + letter) * group.blocks + block];
+                group.letter_counts[letter] += (has & bit) == 0;
+                has |= bit;
+            }
+        }
+    }
+    return groups;
+}
+
+const uint64_t* WordSolver::letter_set(size_t position, int letter) const {
+    return &group_->bits[(position * 26 + letter) * group_->blocks];
+}
+
+void WordSolver::start(const std::string& pattern) {
+    pattern_ = pattern;
+    guessed_mask_ = 0;
+    group_ = nullptr;
+    candidates_.clear();
+    active_blocks_.clear();
+    if (pattern.empty() || pattern.size() >= groups_->size()) {
+        return;
+    }
+
+    group_ = &(*groups_)[pattern.size()];
+    candidates_.assign(group_->blocks, ~0ull);
+    if (group_->words.size() % 64 != 0) {
+        candidates_.back() = (1ull << (group_->words.size() % 64)) - 1;
+    }
+    for (size_t b = 0; b < candidates_.size(); ++b) {
+        active_blocks_.push_back(static_cast<uint32_t>(b));
+    }
+
+    // Символы вне a-z открыты с начала: проверяем их напрямую, таких слов мало
+    if (pattern.find_first_not_of('*') == std::string::npos) {
+        return;
+    }
+    for (size_t w = 0; w < group_->words.size(); ++w) {
+        std::string_view word = dictionary_.word(group_->words[w]);
+        for (size_t p = 0; p < pattern.size(); ++p) {
+            if (pattern[p] != '*' && word[p] != pattern[p]) {
+                candidates_[w / 64] &= ~(1ull << (w % 64));
+                break;
+            }
+        }
+    }
+    compact_blocks();
+}
+
+void WordSolver::compact_blocks() {
+    size_t kept = 0;
+    for (uint32_t block : active_blocks_) {
+        if (candidates_[block] != 0) {
+            active_blocks_[kept++] = block;
+        }
+    }
+    active_blocks_.resize(kept);
+}
+
+char WordSolver::next_letter() const {
+    int best_letter = -1;
+    int best_count = 0;
+    if (group_ != nullptr) {
+        // В начале игры кандидаты - вся группа, и счётчики уже посчитаны
+        bool whole_group = guessed_mask_ == 0 && pattern_.find_first_not_of('*') == std::string::npos;
+        size_t length = pattern_.size();
+        for (int letter = 0; letter < 26; ++letter) {
+            if ((guessed_mask_ >> letter) & 1) {
+                continue;
+            }
+            const uint64_t* has = letter_set(length, letter);
+            int count = 0;
+            if (whole_group) {
+                count = static_cast<int>(group_->letter_counts[letter]);
+            } else {
+                count = count_common(candidates_.data(), has, active_blocks_);
+            }
+            if (count > best_count) {
+                best_count = count;
+                best_letter = letter;
+            }
+        }
+    }
+    if (best_letter >= 0) {
+        return static_cast<char>('a' + best_letter);
+    }
+
+    for (const char* letter = FREQUENCY_ORDER; *letter != '\0'; ++letter) {
+        if (((guessed_mask_ >> (*letter - 'a')) & 1) == 0) {
+            return *letter;
+        }
+    }
+    return 0;
+}
+
+bool WordSolver::apply(char letter, const std::string& pattern) {
+    int index = letter_index(letter);
+    if (index < 0 || pattern.size() != pattern_.size()) {
+        return false;
+    }
+    guessed_mask_ |= 1u << index;
+
+    // Открыться могут только позиции названной буквы, открытые остаются
+    bool consistent = true;
+    bool revealed = false;
+    for (size_t p = 0; p < pattern.size(); ++p) {
+        if (pattern_[p] != '*') {
+            consistent = consistent && pattern[p] == pattern_[p];
+        } else if (pattern[p] != '*') {
+            consistent = consistent && letter_index(pattern[p]) == index;
+            revealed = true;
+        }
+    }
+
+    if (group_ != nullptr) {
+        if (!revealed) {
+            const uint64_t* has = letter_set(pattern.size(), index);
+            for (uint32_t b : active_blocks_) {
+                candidates_[b] &= ~has[b];
+            }
+        } else {
+            // Буква стоит ровно на открывшихся позициях среди закрытых
+            for (size_t p = 0; p < pattern.size(); ++p) {
+                if (pattern_[p] != '*') {
+                    continue;
+                }
+                const uint64_t* at = letter_set(p, index);
+                uint64_t flip = pattern[p] != '*' ? 0 : ~0ull;
+                for (uint32_t b : active_blocks_) {
+                    candidates_[b] &= at[b] ^ flip;
+                }
+            }
+        }
+        compact_blocks();
+    }
+
+    pattern_ = pattern;
+    return consistent;
+}
+
+size_t WordSolver::candidate_count() const {
+    size_t count = 0;
+    for (uint32_t b : active_blocks_) {
+        count += popcount64(candidates_[b]);
+    }
+    return count;
+}
@@ -0,0 +1,56 @@
+#ifndef WORD_SOLVER_HPP
+#define WORD_SOLVER_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../game/word_dictionary.hpp"
+
+// Подбор букв для бота. Слова словаря группируются по длине; для группы
+// хранятся битовые множества "буква L на позиции p" и "буква L есть в слове".
+// Каждый ответ сервера сужает множество кандидатов несколькими AND по этим
+// битам, без перебора слов. Группы строятся один раз в конструкторе
+// (около 26 бит на букву слова); копии решателя делят их, так что боту на
+// каждую сессию достаточно копии.
+class WordSolver {
+private:
+    struct LengthGroup {
+        std::vector<uint32_t> words;
+        size_t blocks;                  // 64-битных слов на одно множество
+        // Множества подряд: (позиция * 26 + буква) для позиций 0..length-1,
+        // затем (length * 26 + буква) - буква есть хотя бы на одной позиции
+        std::vector<uint64_t> bits;
+        uint32_t letter_counts[26];     // слов группы с каждой буквой - для первого хода
+    };
+
+    const GameLogic::WordDictionary& dictionary_;
+    std::shared_ptr<const std::vector<LengthGroup>> groups_;
+    const LengthGroup* group_;
+    std::vector<uint64_t> candidates_;
+    // Номера ненулевых блоков candidates_: после пары ходов кандидатов
+    // остаётся мало, и обходятся только они
+    std::vector<uint32_t> active_blocks_;
+    std::string pattern_;
+    uint32_t guessed_mask_;
+
+    static std::shared_ptr<const std::vector<LengthGroup>> build_groups(const GameLogic::WordDictionary& dictionary);
+    void compact_blocks();
+    const uint64_t* letter_set(size_t position, int letter) const;
+
+public:
+    explicit WordSolver(const GameLogic::WordDictionary& dictionary);
+
+    // Новая игра по начальному шаблону ('*' - закрытая буква)
+    void start(const std::string& pattern);
+    // Буква, которая есть у наибольшего числа кандидатов; без кандидатов -
+    // по частоте в английском. 0 - все буквы уже названы
+    char next_letter() const;
+    // Учитывает новый шаблон после буквы; false - ответ противоречит прежним
+    // (открылись не те позиции или закрылись открытые)
+    bool apply(char letter, const std::string& pattern);
+
+    size_t candidate_count() const;
+};
+
+#endif
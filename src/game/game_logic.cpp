@@ -1,99 +1,145 @@
 // src/game/game_logic.cpp
 #include "game_logic.hpp"
+#include "random.hpp"
 #include <fstream>
-#include <random>
 #include <algorithm>
+#include <cctype>
 
 namespace GameLogic {
 
+uint32_t letter_bit(char letter) {
+    char lower_letter = std::tolower(static_cast<unsigned char>(letter));
+    return (lower_letter >= 'a' && lower_letter <= 'z') ? 1u << (lower_letter - 'a') : 0;
+}
+
+uint32_t word_letter_mask(std::string_view word) {
+    uint32_t mask = 0;
+    for (char c : word) {
+        mask |= letter_bit(c);
+    }
+    return mask;
+}
+
+uint64_t revealed_positions(std::string_view word, uint32_t guessed_mask) {
+    uint64_t positions = 0;
+    for (size_t i = 0; i < word.size() && i < 64; ++i) {
+        uint32_t bit = letter_bit(word[i]);
+        if (bit == 0 || (guessed_mask & bit) != 0) {
+            positions |= 1ull << i;
+        }
+    }
+    return positions;
+}
+
+std::string display_word(std::string_view word, uint32_t guessed_mask) {
+    std::string display(word);
+    for (char& c : display) {
+        uint32_t bit = letter_bit(c);
+        if (bit != 0 && (guessed_mask & bit) == 0) {
+            c = '*';
+        }
+    }
+    return display;
+}
+
+std::string mask_letters(uint32_t mask) {
+    std::string letters;
+    for (int letter = 0; letter < 26; ++letter) {
+        if ((mask >> letter) & 1) {
+            if (!letters.empty()) letters += ", ";
+            letters += static_cast<char>('a' + letter);
+        }
+    }
+    return letters;
+}
+
+GuessResult apply_guess(uint32_t word_mask, uint32_t& guessed_mask, int& errors, int max_errors, char letter) {
+    uint32_t bit = letter_bit(letter);
+    if ((guessed_mask & bit) != 0) {
+        return GuessResult::REPEATED;
+    }
+    if (bit == 0 || is_game_over(word_mask, guessed_mask, errors, max_errors)) {
+        return GuessResult::IGNORED;
+    }
+    
+    guessed_mask |= bit;
+    if ((word_mask & bit) != 0) {
+        return GuessResult::CORRECT;
+    }
+    ++errors;
+    return GuessResult::WRONG;
+}
+
 HangmanGame::HangmanGame() 
-    : max_errors_(6), current_errors_(0), game_over_(false), game_won_(false) {
+    : word_mask_(0), guessed_mask_(0), revealed_positions_(0),
+      max_errors_(6), current_errors_(0), game_over_(false), game_won_(false) {
+    std::fill(letter_start_, letter_start_ + 27, 0);
 }
 
 void HangmanGame::start_new_game(const std::string& word, int max_errors) {
     secret_word_ = word;
     max_errors_ = max_errors;
     current_errors_ = 0;
-    game_over_ = false;
-    game_won_ = false;
-    guessed_letters_.clear();
-    
-    // Инициализируем display_word звездочками
-    display_word_ = std::string(secret_word_.length(), '*');
-}
-
-bool HangmanGame::guess_letter(char letter) {
-    if (game_over_ || game_won_) return false;
+    guessed_mask_ = 0;
+    word_mask_ = word_letter_mask(secret_word_);
+    revealed_positions_ = revealed_positions(secret_word_, 0);
     
-    char lower_letter = std::tolower(letter);
+    // Инициализируем display_word звездочками; символы вне a-z угадать нельзя, их показываем сразу
+    display_word_ = display_word(secret_word_, 0);
+    game_won_ = is_word_guessed(word_mask_, guessed_mask_);
+    game_over_ = game_won_;
     
-    // Проверяем, не угадывали ли уже эту букву
-    if (guessed_letters_.count(lower_letter) > 0) {
-        return false; // Буква уже была
-    }
-    
-    guessed_letters_.insert(lower_letter);
-    
-    // Проверяем есть ли буква в слове
-    bool letter_found = false;
+    // Подсчёт позиций каждой буквы (сортировка подсчётом)
+    uint16_t counts[26] = {0};
+    size_t letter_count = 0;
     for (char c : secret_word_) {
-        if (std::tolower(c) == lower_letter) {
-            letter_found = true;
-            break;
+        if (letter_bit(c) != 0) {
+            ++counts[std::tolower(static_cast<unsigned char>(c)) - 'a'];
+            ++letter_count;
         }
     }
     
-    if (letter_found) {
-        // Обновляем display_word
-        update_display_word();
-        
-        // Проверяем победу
-        if (display_word_ == secret_word_) {
-            game_won_ = true;
-            game_over_ = true;
-        }
-    } else {
-        // Буквы нет - увеличиваем ошибки
-        current_errors_++;
-        if (current_errors_ >= max_errors_) {
-            game_over_ = true;
-        }
+    letter_start_[0] = 0;
+    for (int letter = 0; letter < 26; ++letter) {
+        letter_start_[letter + 1] = static_cast<uint16_t>(letter_start_[letter] + counts[letter]);
     }
     
-    return letter_found;
+    letter_positions_.resize(letter_count);
+    uint16_t next[26];
+    std::copy(letter_start_, letter_start_ + 26, next);
+    for (size_t i = 0; i < secret_word_.size(); ++i) {
+        if (letter_bit(secret_word_[i]) != 0) {
+            int letter = std::tolower(static_cast<unsigned char>(secret_word_[i])) - 'a';
+            letter_positions_[next[letter]++] = static_cast<uint16_t>(i);
+        }
+    }
 }
 
-void HangmanGame::update_display_word() {
-    display_word_.clear();
-    for (char c : secret_word_) {
-        char lower_c = std::tolower(c);
-        if (guessed_letters_.count(lower_c) > 0) {
-            display_word_ += c; // Показываем угаданную букву
-        } else {
-            display_word_ += '*'; // Скрываем неугаданную
+void HangmanGame::reveal_letter(int letter_index) {
+    for (uint16_t k = letter_start_[letter_index]; k < letter_start_[letter_index + 1]; ++k) {
+        uint16_t position = letter_positions_[k];
+        display_word_[position] = secret_word_[position]; // Показываем угаданную букву
+        if (position < 64) {
+            revealed_positions_ |= 1ull << position;
         }
     }
 }
 
-std::string HangmanGame::get_wrong_letters() const {
-    std::string wrong_letters;
-    for (char letter : guessed_letters_) {
-        // Проверяем, есть ли буква в секретном слове
-        bool found = false;
-        for (char c : secret_word_) {
-            if (std::tolower(c) == letter) {
-                found = true;
-                break;
-            }
-        }
-        
-        // Добавляем ТОЛЬКО если буква НЕ найдена в слове
-        if (!found) {
-            if (!wrong_letters.empty()) wrong_letters += ", ";
-            wrong_letters += letter;
-        }
+bool HangmanGame::guess_letter(char letter) {
+    if (game_over_) return false;
+    
+    GuessResult result = apply_guess(word_mask_, guessed_mask_, current_errors_, max_errors_, letter);
+    if (result == GuessResult::CORRECT) {
+        // Открываем только позиции этой буквы
+        reveal_letter(std::tolower(static_cast<unsigned char>(letter)) - 'a');
     }
-    return wrong_letters;
+    game_won_ = is_word_guessed(word_mask_, guessed_mask_);
+    game_over_ = GameLogic::is_game_over(word_mask_, guessed_mask_, current_errors_, max_errors_);
+    return result == GuessResult::CORRECT;
+}
+
+std::string HangmanGame::get_wrong_letters() const {
+    return mask_letters(get_wrong_mask());
 }
 
 // Реализация утилит словаря
@@ -116,11 +162,7 @@ std::string Dictionary::get_random_word(const std::vector<std::string>& words) {
         return "hangman"; // fallback
     }
     
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dist(0, words.size() - 1);
-    
-    return words[dist(gen)];
+    return words[Random::below(static_cast<uint32_t>(words.size()))];
 }
 
 } // namespace GameLogic
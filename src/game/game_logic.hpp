@@ -2,21 +2,65 @@
 #define GAME_LOGIC_HPP
 
 #include <string>
+#include <string_view>
 #include <vector>
-#include <unordered_set>
+#include <cstdint>
 
 namespace GameLogic {
 
+// Правила игры над словом и маской названных букв (бит 0 - 'a'). По ним играют
+// и HangmanGame, и сессии сервера, которые хранят игру одной маской.
+
+// Бит буквы без учёта регистра; 0 для символов вне a-z
+uint32_t letter_bit(char letter);
+// Буквы слова; символы вне a-z угадать нельзя, в маску они не входят
+uint32_t word_letter_mask(std::string_view word);
+// Открытые позиции (бит 0 - первая буква): угаданные буквы и символы вне a-z
+uint64_t revealed_positions(std::string_view word, uint32_t guessed_mask);
+// Слово с '*' на месте неугаданных букв
+std::string display_word(std::string_view word, uint32_t guessed_mask);
+// Буквы маски по алфавиту через запятую: "a, e, t"
+std::string mask_letters(uint32_t mask);
+
+inline bool is_word_guessed(uint32_t word_mask, uint32_t guessed_mask) {
+    return (word_mask & ~guessed_mask) == 0;
+}
+
+inline bool is_game_over(uint32_t word_mask, uint32_t guessed_mask, int errors, int max_errors) {
+    return is_word_guessed(word_mask, guessed_mask) || errors >= max_errors;
+}
+
+enum class GuessResult {
+    CORRECT,
+    WRONG,      // буквы нет в слове, ошибка засчитана
+    REPEATED,   // буква уже называлась
+    IGNORED     // не буква или игра окончена - ничего не меняется
+};
+
+// Ход: отмечает букву в guessed_mask и при промахе увеличивает errors
+GuessResult apply_guess(uint32_t word_mask, uint32_t& guessed_mask, int& errors, int max_errors, char letter);
+
+// Буквы хранятся битовыми масками (бит 0 - 'a'), позиции каждой буквы в слове
+// считаются один раз в start_new_game: ход - обновление маски и открытие
+// только позиций угаданной буквы.
 class HangmanGame {
 private:
     std::string secret_word_;
     std::string display_word_;  // Например: "c**c**t" для "circuit"
-    std::unordered_set<char> guessed_letters_;
+    uint32_t word_mask_;        // буквы, которые есть в слове
+    uint32_t guessed_mask_;
+    uint64_t revealed_positions_;
+    // Позиции слова, сгруппированные по буквам: буква i занимает
+    // letter_positions_[letter_start_[i]] .. letter_positions_[letter_start_[i + 1] - 1]
+    std::vector<uint16_t> letter_positions_;
+    uint16_t letter_start_[27];
     int max_errors_;
     int current_errors_;
     bool game_over_;
     bool game_won_;
 
+    void reveal_letter(int letter_index);
+
 public:
     HangmanGame();
     
@@ -33,11 +77,15 @@ public:
     bool is_game_over() const { return game_over_; }
     bool is_game_won() const { return game_won_; }
     const std::string& get_secret_word() const { return secret_word_; }
-    const std::unordered_set<char>& get_guessed_letters() const { return guessed_letters_; }
+    bool is_letter_guessed(char letter) const { return (guessed_mask_ & letter_bit(letter)) != 0; }
+    
+    // Маски букв (бит 0 - 'a') и открытых позиций слова (бит 0 - первая буква)
+    uint32_t get_guessed_mask() const { return guessed_mask_; }
+    uint32_t get_wrong_mask() const { return guessed_mask_ & ~word_mask_; }
+    uint64_t get_revealed_positions() const { return revealed_positions_; }
     
     // Вспомогательные методы
     std::string get_wrong_letters() const;
-    void update_display_word();
 };
 
 // Утилиты для работы со словарем
@@ -0,0 +1,62 @@
+#include "random.hpp"
+#include <random>
+
+namespace GameLogic {
+
+static uint64_t rotl(uint64_t value, int shift) {
+    return (value << shift) | (value >> (64 - shift));
+}
+
+static uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+struct RandomState {
+    uint64_t s[4];
+
+    RandomState() {
+        std::random_device device;
+        uint64_t seed = (static_cast<uint64_t>(device()) << 32) ^ device();
+        for (uint64_t& word : s) {
+            word = splitmix64(seed);
+        }
+    }
+};
+
+uint64_t Random::next_u64() {
+    static thread_local RandomState state;
+    uint64_t* s = state.s;
+
+    uint64_t result = rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+}
+
+uint32_t Random::next_u32() {
+    return static_cast<uint32_t>(next_u64() >> 32);
+}
+
+// Умножение вместо деления (Lemire); отбрасывание убирает смещение
+uint32_t Random::below(uint32_t bound) {
+    uint64_t product = static_cast<uint64_t>(next_u32()) * bound;
+    uint32_t low = static_cast<uint32_t>(product);
+    if (low < bound) {
+        uint32_t threshold = (0u - bound) % bound;
+        while (low < threshold) {
+            product = static_cast<uint64_t>(next_u32()) * bound;
+            low = static_cast<uint32_t>(product);
+        }
+    }
+    return static_cast<uint32_t>(product >> 32);
+}
+
+}
@@ -0,0 +1,20 @@
+#ifndef RANDOM_HPP
+#define RANDOM_HPP
+
+#include <cstdint>
+
+namespace GameLogic {
+
+// Быстрый генератор xoshiro256** со своим состоянием в каждом потоке.
+// Сид берётся из std::random_device один раз при первом вызове в потоке;
+// для криптографии не годится, для выбора слов - с запасом.
+namespace Random {
+    uint64_t next_u64();
+    uint32_t next_u32();
+    // Равномерно в [0, bound); bound > 0
+    uint32_t below(uint32_t bound);
+}
+
+}
+
+#endif
@@ -0,0 +1,293 @@
+#include "word_dictionary.hpp"
+#include "game_logic.hpp"
+#include "../protocol/checksum.hpp"
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace GameLogic {
+
+static_assert(sizeof(DictionaryFileHeader) == 48, "dictionary header must match file layout");
+static_assert(sizeof(WordInfo) == 8, "word info must match file layout");
+
+static uint64_t align8(uint64_t value) {
+    return (value + 7) & ~static_cast<uint64_t>(7);
+}
+
+static uint32_t image_checksum(const char* data, size_t size) {
+    DictionaryFileHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    header.checksum = 0;
+    uint32_t crc = Protocol::crc32c(0, reinterpret_cast<const uint8_t*>(&header), sizeof(header));
+    return Protocol::crc32c(crc, reinterpret_cast<const uint8_t*>(data) + sizeof(header), size - sizeof(header));
+}
+
+WordInfo make_word_info(std::string_view word) {
+    WordInfo info;
+    info.letter_mask = word_letter_mask(word);
+    info.length = static_cast<uint8_t>(word.size() < 255 ? word.size() : 255);
+    uint8_t distinct = 0;
+    for (uint32_t mask = info.letter_mask; mask != 0; mask &= mask - 1) {
+        ++distinct;
+    }
+    info.distinct_letters = distinct;
+    info.reserved = 0;
+    return info;
+}
+
+std::vector<char> compile_dictionary(const std::vector<std::string>& words) {
+    // Строки из файлов Windows приходят с '\r' в конце
+    std::vector<std::string_view> entries;
+    entries.reserve(words.size());
+    uint64_t pool_size = 0;
+    for (const std::string& word : words) {
+        std::string_view entry(word);
+        if (!entry.empty() && entry.back() == '\r') {
+            entry.remove_suffix(1);
+        }
+        if (entry.empty() || entry.size() > 255) {
+            continue;
+        }
+        entries.push_back(entry);
+        pool_size += entry.size();
+    }
+
+    DictionaryFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = DICTIONARY_MAGIC;
+    header.version = DICTIONARY_VERSION;
+    header.word_count = static_cast<uint32_t>(entries.size());
+    header.offsets_offset = align8(sizeof(DictionaryFileHeader));
+    header.infos_offset = align8(header.offsets_offset + (entries.size() + 1) * sizeof(uint32_t));
+    header.pool_offset = header.infos_offset + entries.size() * sizeof(WordInfo);
+    header.pool_size = pool_size;
+
+    std::vector<char> image(header.pool_offset + pool_size, 0);
+    std::memcpy(image.data(), &header, sizeof(header));
+
+    uint32_t offset = 0;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        WordInfo info = make_word_info(entries[i]);
+        std::memcpy(&image[header.offsets_offset + i * sizeof(uint32_t)], &offset, sizeof(offset));
+        std::memcpy(&image[header.infos_offset + i * sizeof(WordInfo)], &info, sizeof(info));
+        std::memcpy(&image[header.pool_offset + offset], entries[i].data(), entries[i].size());
+        offset += static_cast<uint32_t>(entries[i].size());
+    }
+    std::memcpy(&image[header.offsets_offset + entries.size() * sizeof(uint32_t)], &offset, sizeof(offset));
+
+    header.checksum = image_checksum(image.data(), image.size());
+    std::memcpy(image.data(), &header, sizeof(header));
+
+    return image;
+}
+
+#ifdef _WIN32
+WordDictionary::WordDictionary()
+    : data_(nullptr), size_(0), header_(nullptr), offsets_(nullptr), infos_(nullptr), pool_(nullptr),
+      file_(INVALID_HANDLE_VALUE), mapping_(NULL) {}
+#else
+WordDictionary::WordDictionary()
+    : data_(nullptr), size_(0), header_(nullptr), offsets_(nullptr), infos_(nullptr), pool_(nullptr),
+      file_(-1) {}
+#endif
+
+WordDictionary::~WordDictionary() {
+    close();
+}
+
+// Слова по одному не разбираются. Порчу файла ловит CRC32C, которую пишет
+// dict_compile, - один последовательный проход со скоростью памяти; границы
+// каждого слова проверяет word() при обращении
+bool WordDictionary::attach(const char* data, size_t size) {
+    if (size < sizeof(DictionaryFileHeader)) {
+        return false;
+    }
+    const DictionaryFileHeader* header = reinterpret_cast<const DictionaryFileHeader*>(data);
+    if (header->magic != DICTIONARY_MAGIC || header->version != DICTIONARY_VERSION) {
+        return false;
+    }
+
+    uint64_t count = header->word_count;
+    if (header->offsets_offset % 8 != 0 || header->infos_offset % 8 != 0 ||
+        header->offsets_offset + (count + 1) * sizeof(uint32_t) > size ||
+        header->infos_offset + count * sizeof(WordInfo) > size ||
+        header->pool_offset > size || header->pool_size > size - header->pool_offset ||
+        header->pool_size > UINT32_MAX) {
+        return false;
+    }
+    const uint32_t* offsets = reinterpret_cast<const uint32_t*>(data + header->offsets_offset);
+    const WordInfo* infos = reinterpret_cast<const WordInfo*>(data + header->infos_offset);
+    if (offsets[0] != 0 || offsets[count] != header->pool_size || image_checksum(data, size) != header->checksum) {
+        return false;
+    }
+
+    data_ = data;
+    size_ = size;
+    header_ = header;
+    offsets_ = offsets;
+    infos_ = infos;
+    pool_ = data + header->pool_offset;
+    return true;
+}
+
+#ifdef _WIN32
+
+bool WordDictionary::open_compiled(const std::string& filename) {
+    close();
+
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    file_ = file;
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+        close();
+        return false;
+    }
+
+    mapping_ = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping_ == NULL) {
+        close();
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+    if (view == NULL) {
+        close();
+        return false;
+    }
+    if (!attach(static_cast<const char*>(view), static_cast<size_t>(file_size.QuadPart))) {
+        UnmapViewOfFile(view);
+        close();
+        return false;
+    }
+    return true;
+}
+
+void WordDictionary::close() {
+    if (data_ != nullptr && owned_.empty()) {
+        UnmapViewOfFile(data_);
+    }
+    if (mapping_ != NULL) {
+        CloseHandle(mapping_);
+        mapping_ = NULL;
+    }
+    if (file_ != INVALID_HANDLE_VALUE) {
+        CloseHandle(file_);
+        file_ = INVALID_HANDLE_VALUE;
+    }
+    owned_.clear();
+    data_ = nullptr;
+    size_ = 0;
+    header_ = nullptr;
+}
+
+#else
+
+bool WordDictionary::open_compiled(const std::string& filename) {
+    close();
+
+    int file = ::open(filename.c_str(), O_RDONLY);
+    if (file < 0) {
+        return false;
+    }
+    file_ = file;
+
+    struct stat st;
+    if (fstat(file, &st) != 0 || st.st_size == 0) {
+        close();
+        return false;
+    }
+
+    // MAP_SHARED только для чтения: страницы берутся из кэша ФС и общие для всех процессов
+    size_t size = static_cast<size_t>(st.st_size);
+    void* view = mmap(nullptr, size, PROT_READ, MAP_SHARED, file, 0);
+    if (view == MAP_FAILED) {
+        close();
+        return false;
+    }
+    if (!attach(static_cast<const char*>(view), size)) {
+        munmap(view, size);
+        close();
+        return false;
+    }
+    return true;
+}
+
+void WordDictionary::close() {
+    if (data_ != nullptr && owned_.empty()) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+    if (file_ >= 0) {
+        ::close(file_);
+        file_ = -1;
+    }
+    owned_.clear();
+    data_ = nullptr;
+    size_ = 0;
+    header_ = nullptr;
+}
+
+#endif
+
+bool WordDictionary::load_text(const std::string& filename) {
+    close();
+
+    std::vector<std::string> words = Dictionary::load_words(filename);
+    if (words.empty()) {
+        return false;
+    }
+    owned_ = compile_dictionary(words);
+    if (!attach(owned_.data(), owned_.size())) {
+        owned_.clear();
+        return false;
+    }
+    return true;
+}
+
+std::string_view WordDictionary::word(size_t index) const {
+    if (index >= size()) {
+        return std::string_view();
+    }
+    uint32_t begin = offsets_[index];
+    uint32_t end = offsets_[index + 1];
+    if (begin > end || end > header_->pool_size) {
+        return std::string_view();
+    }
+    return std::string_view(pool_ + begin, end - begin);
+}
+
+uint64_t WordDictionary::fingerprint() const {
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const char* data, size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ static_cast<unsigned char>(data[i])) * 1099511628211ull;
+        }
+    };
+    if (header_ != nullptr) {
+        mix(reinterpret_cast<const char*>(offsets_), (header_->word_count + 1) * sizeof(uint32_t));
+        mix(pool_, header_->pool_size);
+    }
+    return hash;
+}
+
+WordInfo WordDictionary::info(size_t index) const {
+    if (index >= size()) {
+        WordInfo empty;
+        std::memset(&empty, 0, sizeof(empty));
+        return empty;
+    }
+    return infos_[index];
+}
+
+}
@@ -0,0 +1,88 @@
+#ifndef WORD_DICTIONARY_HPP
+#define WORD_DICTIONARY_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace GameLogic {
+
+// Скомпилированный словарь (tools/dict_compile):
+//   DictionaryFileHeader
+//   uint32_t offsets[word_count + 1]   - начало каждого слова в пуле, последнее - конец пула
+//   WordInfo infos[word_count]
+//   char pool[pool_size]               - слова подряд, без разделителей
+// Все числа - little-endian; секции выровнены на 8 байт.
+const uint32_t DICTIONARY_MAGIC = 0x54434448; // "HDCT"
+const uint32_t DICTIONARY_VERSION = 2;
+
+struct DictionaryFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t word_count;
+    uint32_t checksum;          // CRC32C всего файла, это поле считается нулём
+    uint64_t offsets_offset;
+    uint64_t infos_offset;
+    uint64_t pool_offset;
+    uint64_t pool_size;
+};
+
+struct WordInfo {
+    uint32_t letter_mask;      // буквы слова, бит 0 - 'a'
+    uint8_t length;            // длина, не больше 255
+    uint8_t distinct_letters;
+    uint16_t reserved;
+};
+
+// Словарь только для чтения. Файл отображается в память целиком, поэтому
+// загрузка не зависит от числа слов, а страницы делят все процессы сервера.
+// Текстовый список компилируется в тот же формат в памяти процесса.
+class WordDictionary {
+private:
+    std::vector<char> owned_;   // образ, собранный из текста
+    const char* data_;
+    size_t size_;
+    const DictionaryFileHeader* header_;
+    const uint32_t* offsets_;
+    const WordInfo* infos_;
+    const char* pool_;
+#ifdef _WIN32
+    void* file_;
+    void* mapping_;
+#else
+    int file_;
+#endif
+
+    bool attach(const char* data, size_t size);
+    void close();
+
+public:
+    WordDictionary();
+    ~WordDictionary();
+
+    // Отображает скомпилированный файл; false - файла нет или формат не тот
+    bool open_compiled(const std::string& filename);
+    // Читает текстовый список (слово на строку) и компилирует его в памяти
+    bool load_text(const std::string& filename);
+
+    bool is_loaded() const { return header_ != nullptr; }
+    size_t size() const { return header_ != nullptr ? header_->word_count : 0; }
+    std::string_view word(size_t index) const;
+    WordInfo info(size_t index) const;
+    // FNV-1a по списку слов: совпадает у одинаковых словарей, как бы они ни
+    // были загружены. Читает весь словарь - считается один раз на снимок
+    uint64_t fingerprint() const;
+
+    WordDictionary(const WordDictionary&) = delete;
+    WordDictionary& operator=(const WordDictionary&) = delete;
+};
+
+// Собирает образ словаря из списка слов (пустые строки пропускаются)
+std::vector<char> compile_dictionary(const std::vector<std::string>& words);
+WordInfo make_word_info(std::string_view word);
+
+}
+
+#endif
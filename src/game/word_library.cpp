@@ -0,0 +1,128 @@
+#include "word_library.hpp"
+#include <chrono>
+#include "../log/logger.hpp"
+#include <sys/stat.h>
+
+namespace GameLogic {
+
+// Время изменения и размер файла; файл, которого нет, - нулевая подпись
+struct FileSignature {
+    int64_t modified;
+    int64_t modified_ns;
+    int64_t size;
+
+    bool operator!=(const FileSignature& other) const {
+        return modified != other.modified || modified_ns != other.modified_ns || size != other.size;
+    }
+};
+
+static FileSignature file_signature(const std::string& filename) {
+    FileSignature signature = {0, 0, -1};
+    struct stat st;
+    if (stat(filename.c_str(), &st) == 0) {
+        signature.modified = static_cast<int64_t>(st.st_mtime);
+#ifndef _WIN32
+        signature.modified_ns = static_cast<int64_t>(st.st_mtim.tv_nsec);
+#endif
+        signature.size = static_cast<int64_t>(st.st_size);
+    }
+    return signature;
+}
+
+WordLibrary::WordLibrary(const std::string& dictionary_file, const std::string& text_file)
+    : dictionary_file_(dictionary_file), text_file_(text_file), version_(0), stopping_(false) {}
+
+WordLibrary::~WordLibrary() {
+    stop_watching();
+}
+
+bool WordLibrary::reload() {
+    std::shared_ptr<WordSnapshot> snapshot = std::make_shared<WordSnapshot>();
+    snapshot->source = dictionary_file_;
+    if (!snapshot->dictionary.open_compiled(dictionary_file_) || snapshot->dictionary.size() == 0) {
+        snapshot->source = text_file_;
+        if (!snapshot->dictionary.load_text(text_file_) || snapshot->dictionary.size() == 0) {
+            return false;
+        }
+    }
+    snapshot->selector.reset(new WordSelector(snapshot->dictionary));
+    snapshot->fingerprint = snapshot->dictionary.fingerprint();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    snapshot->version = version_.load(std::memory_order_relaxed) + 1;
+    current_ = snapshot;
+    version_.store(snapshot->version, std::memory_order_release);
+    return true;
+}
+
+void WordLibrary::refresh(std::shared_ptr<const WordSnapshot>& cached, uint64_t& version) {
+    if (cached && version_.load(std::memory_order_acquire) == version) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    cached = current_;
+    version = cached ? cached->version : 0;
+}
+
+std::shared_ptr<const WordSnapshot> WordLibrary::snapshot() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return current_;
+}
+
+void WordLibrary::start_watching(int interval_ms) {
+    if (interval_ms <= 0 || watcher_.joinable()) {
+        return;
+    }
+    stopping_ = false;
+    watcher_ = std::thread(&WordLibrary::watch, this, interval_ms);
+}
+
+void WordLibrary::stop_watching() {
+    {
+        std::lock_guard<std::mutex> lock(watcher_mutex_);
+        stopping_ = true;
+    }
+    watcher_wakeup_.notify_all();
+    if (watcher_.joinable()) {
+        watcher_.join();
+    }
+}
+
+// Перестраиваем не сразу, а когда подпись не менялась целый интервал:
+// так не читается файл, который ещё дописывают
+void WordLibrary::watch(int interval_ms) {
+    FileSignature dictionary_signature = file_signature(dictionary_file_);
+    FileSignature text_signature = file_signature(text_file_);
+    bool pending = false;
+
+    std::unique_lock<std::mutex> lock(watcher_mutex_);
+    while (!watcher_wakeup_.wait_for(lock, std::chrono::milliseconds(interval_ms), [this] { return stopping_; })) {
+        FileSignature dictionary_now = file_signature(dictionary_file_);
+        FileSignature text_now = file_signature(text_file_);
+        if (dictionary_now != dictionary_signature || text_now != text_signature) {
+            dictionary_signature = dictionary_now;
+            text_signature = text_now;
+            pending = true;
+            continue;
+        }
+        if (!pending) {
+            continue;
+        }
+        pending = false;
+
+        lock.unlock();
+        auto start = std::chrono::steady_clock::now();
+        bool reloaded = reload();
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        std::shared_ptr<const WordSnapshot> current = snapshot();
+        if (reloaded) {
+            Log::info("Dictionary reloaded: {} words from {} (version {}, {} ms)", current->dictionary.size(),
+                      current->source, current->version, elapsed.count());
+        } else {
+            Log::warn("Dictionary reload failed, keeping version {}", current ? current->version : 0);
+        }
+        lock.lock();
+    }
+}
+
+}
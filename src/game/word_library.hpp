@@ -0,0 +1,69 @@
+#ifndef WORD_LIBRARY_HPP
+#define WORD_LIBRARY_HPP
+
+#include "word_dictionary.hpp"
+#include "word_selector.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <cstdint>
+
+namespace GameLogic {
+
+// Словарь вместе с построенным по нему индексом; после публикации не меняется
+struct WordSnapshot {
+    WordDictionary dictionary;
+    std::unique_ptr<WordSelector> selector;
+    std::string source;
+    uint64_t version;
+    uint64_t fingerprint;   // WordDictionary::fingerprint
+};
+
+// Текущий словарь сервера с подменой на лету (в духе RCU): новый снимок
+// строится в фоновом потоке и публикуется одной заменой указателя.
+// Поток-обработчик держит свой shared_ptr на снимок и сверяет номер версии
+// при старте игры: мьютекс берётся, только когда версия сменилась. Старый
+// снимок освобождается, когда его отпустят последний обработчик и последняя
+// начатая на нём игра: сессии хранят номер слова в словаре снимка.
+class WordLibrary {
+private:
+    std::string dictionary_file_;
+    std::string text_file_;
+    std::mutex mutex_;
+    std::shared_ptr<const WordSnapshot> current_;
+    std::atomic<uint64_t> version_;
+
+    std::thread watcher_;
+    std::mutex watcher_mutex_;
+    std::condition_variable watcher_wakeup_;
+    bool stopping_;
+
+    void watch(int interval_ms);
+
+public:
+    // Скомпилированный словарь предпочтительнее текстового списка
+    WordLibrary(const std::string& dictionary_file, const std::string& text_file);
+    ~WordLibrary();
+
+    // Строит снимок и публикует его; при ошибке остаётся прежний
+    bool reload();
+
+    // Обновляет cached, если опубликован снимок новее version
+    void refresh(std::shared_ptr<const WordSnapshot>& cached, uint64_t& version);
+    std::shared_ptr<const WordSnapshot> snapshot();
+
+    // Фоновый поток проверяет время изменения и размер файлов словаря
+    // раз в interval_ms и перестраивает снимок, когда файл перестал меняться
+    void start_watching(int interval_ms);
+    void stop_watching();
+
+    WordLibrary(const WordLibrary&) = delete;
+    WordLibrary& operator=(const WordLibrary&) = delete;
+};
+
+}
+
+#endif
@@ -0,0 +1,133 @@
+#include "word_selector.hpp"
+#include "random.hpp"
+#include <cstdlib>
+
+namespace GameLogic {
+
+// Буквы английского текста по убыванию частоты
+static const char FREQUENCY_ORDER[] = "etaoinshrdlcumwfgypbvkjxqz";
+
+uint8_t WordSelector::frequency_misses(uint32_t letter_mask) {
+    uint8_t misses = 0;
+    uint32_t remaining = letter_mask;
+    for (const char* letter = FREQUENCY_ORDER; *letter != '\0' && remaining != 0; ++letter) {
+        uint32_t bit = 1u << (*letter - 'a');
+        if ((letter_mask & bit) != 0) {
+            remaining &= ~bit;
+        } else {
+            ++misses;
+        }
+    }
+    return misses;
+}
+
+// Разных букв не больше 26, длина в WordInfo - не больше 255
+uint32_t WordSelector::difficulty_key(const WordInfo& info) {
+    uint32_t distinct = info.distinct_letters < 26 ? info.distinct_letters : 26;
+    return (frequency_misses(info.letter_mask) * 27 + (26 - distinct)) * 256 + (255 - info.length);
+}
+
+// Метод Воза: каждая ячейка хранит порог и второе слово, выбор - одно
+// случайное число для ячейки и одно для порога
+void WordSelector::build_alias_table(Tier& tier, const std::vector<double>& weights) {
+    size_t count = weights.size();
+    tier.threshold.assign(count, UINT32_MAX);
+    tier.alias.resize(count);
+
+    double total = 0;
+    for (double weight : weights) {
+        total += weight;
+    }
+
+    std::vector<double> scaled(count);
+    std::vector<uint32_t> small;
+    std::vector<uint32_t> large;
+    for (size_t i = 0; i < count; ++i) {
+        tier.alias[i] = static_cast<uint32_t>(i);
+        scaled[i] = weights[i] * count / total;
+        (scaled[i] < 1.0 ? small : large).push_back(static_cast<uint32_t>(i));
+    }
+
+    while (!small.empty() && !large.empty()) {
+        uint32_t less = small.back();
+        small.pop_back();
+        uint32_t more = large.back();
+        large.pop_back();
+
+        double keep = scaled[less] > 0 ? scaled[less] : 0;
+        tier.threshold[less] = static_cast<uint32_t>(keep * 4294967296.0);
+        tier.alias[less] = more;
+        scaled[more] -= 1.0 - scaled[less];
+        (scaled[more] < 1.0 ? small : large).push_back(more);
+    }
+    // Остатки из-за погрешности округления - вероятность 1
+}
+
+WordSelector::WordSelector(const WordDictionary& dictionary)
+    : dictionary_(dictionary) {
+    // Ключей немного, поэтому слова упорядочиваются подсчётом за O(n)
+    const size_t KEY_COUNT = DIFFICULTY_KEYS;
+    size_t word_count = dictionary_.size();
+    std::vector<uint32_t> keys(word_count);
+    std::vector<uint8_t> misses(word_count);
+    std::vector<uint32_t> key_start(KEY_COUNT + 1, 0);
+    for (size_t i = 0; i < word_count; ++i) {
+        WordInfo info = dictionary_.info(i);
+        misses[i] = frequency_misses(info.letter_mask);
+        keys[i] = difficulty_key(info);
+        ++key_start[keys[i] + 1];
+    }
+    for (size_t key = 0; key < KEY_COUNT; ++key) {
+        key_start[key + 1] += key_start[key];
+    }
+    std::vector<uint32_t> sorted(word_count);
+    for (size_t i = 0; i < word_count; ++i) {
+        sorted[key_start[keys[i]]++] = static_cast<uint32_t>(i);
+    }
+
+    for (uint8_t t = 0; t < DIFFICULTY_TIERS; ++t) {
+        Tier& tier = tiers_[t];
+        size_t begin = word_count * t / DIFFICULTY_TIERS;
+        size_t end = word_count * (t + 1) / DIFFICULTY_TIERS;
+        if (begin == end) {
+            continue;
+        }
+
+        tier.words.assign(sorted.begin() + begin, sorted.begin() + end);
+        int center = misses[tier.words[tier.words.size() / 2]];
+        std::vector<double> weights(tier.words.size());
+        for (size_t i = 0; i < tier.words.size(); ++i) {
+            weights[i] = 1.0 / (1 + std::abs(misses[tier.words[i]] - center));
+        }
+        build_alias_table(tier, weights);
+    }
+}
+
+std::string_view WordSelector::pick(uint8_t difficulty) const {
+    if (dictionary_.size() == 0) {
+        return std::string_view();
+    }
+    return dictionary_.word(pick_index(difficulty));
+}
+
+uint32_t WordSelector::pick_index(uint8_t difficulty) const {
+    if (difficulty == DIFFICULTY_ANY || difficulty > DIFFICULTY_TIERS || tiers_[difficulty - 1].words.empty()) {
+        return Random::below(static_cast<uint32_t>(dictionary_.size()));
+    }
+
+    const Tier& tier = tiers_[difficulty - 1];
+    uint32_t cell = Random::below(static_cast<uint32_t>(tier.words.size()));
+    if (Random::next_u32() >= tier.threshold[cell]) {
+        cell = tier.alias[cell];
+    }
+    return tier.words[cell];
+}
+
+size_t WordSelector::tier_size(uint8_t difficulty) const {
+    if (difficulty == DIFFICULTY_ANY || difficulty > DIFFICULTY_TIERS) {
+        return dictionary_.size();
+    }
+    return tiers_[difficulty - 1].words.size();
+}
+
+}
@@ -0,0 +1,58 @@
+#ifndef WORD_SELECTOR_HPP
+#define WORD_SELECTOR_HPP
+
+#include "word_dictionary.hpp"
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+namespace GameLogic {
+
+// Уровни сложности; номера совпадают с Protocol::Difficulty
+const uint8_t DIFFICULTY_ANY = 0;
+const uint8_t DIFFICULTY_TIERS = 3;   // 1 - лёгкий .. 3 - сложный
+
+// Выбор слова за O(1). Слова раскладываются по уровням сложности: оценка -
+// сколько ошибок сделает игрок, называющий буквы по частоте в английском,
+// при равенстве сложнее слово с меньшим числом разных букв (меньше целей
+// для догадки), затем более короткое. Каждый уровень - треть словаря
+// по этой оценке. Внутри уровня слово выбирается по alias-таблице: слова
+// ближе к середине уровня выпадают чаще, поэтому уровни заметно отличаются
+// даже на маленьком словаре.
+class WordSelector {
+private:
+    struct Tier {
+        std::vector<uint32_t> words;
+        std::vector<uint32_t> threshold;  // вероятность оставить слово, из 2^32
+        std::vector<uint32_t> alias;      // номер слова, если не оставили
+    };
+
+    const WordDictionary& dictionary_;
+    Tier tiers_[DIFFICULTY_TIERS];
+
+    static void build_alias_table(Tier& tier, const std::vector<double>& weights);
+
+public:
+    // Словарь должен жить дольше выборщика
+    explicit WordSelector(const WordDictionary& dictionary);
+
+    // Случайное слово уровня (DIFFICULTY_ANY - из всего словаря);
+    // пустой уровень заменяется всем словарём
+    std::string_view pick(uint8_t difficulty) const;
+    // То же, но номер слова в словаре; словарь не должен быть пуст
+    uint32_t pick_index(uint8_t difficulty) const;
+    size_t tier_size(uint8_t difficulty) const;
+
+    // Число ошибок игрока, называющего буквы в порядке частоты
+    static uint8_t frequency_misses(uint32_t letter_mask);
+    // Ключ сложности слова: больше - сложнее, меньше DIFFICULTY_KEYS
+    static uint32_t difficulty_key(const WordInfo& info);
+    static const uint32_t DIFFICULTY_KEYS = 27 * 27 * 256;
+
+    WordSelector(const WordSelector&) = delete;
+    WordSelector& operator=(const WordSelector&) = delete;
+};
+
+}
+
+#endif
@@ -0,0 +1,269 @@
+#include "batched_regions.hpp"
+#include "file_handle.hpp"
+#include "notify.hpp"
+#include "region_ops.hpp"
+#include "ring_buffer.hpp"
+#include "../protocol/protocol.hpp"
+#include <cstring>
+#include <cstddef>
+
+namespace FileSocket {
+
+// user_data запросов: номер копии для чтений слотов
+static const uint64_t WRITE_REQUEST = UINT64_MAX;
+static const uint64_t REFRESH_REQUEST = UINT64_MAX - 1;
+
+static int socket_descriptor() {
+#ifdef _WIN32
+    return -1;
+#else
+    return get_socket_handle().get();
+#endif
+}
+
+BatchedRegions::BatchedRegions()
+    : queue_(socket_descriptor(), QUEUE_ENTRIES),
+      arena_(new char[MAX_FETCH * FETCH_SIZE + STAGING_SIZE]),
+      staging_(arena_.get() + MAX_FETCH * FETCH_SIZE),
+      staging_used_(0),
+      free_count_(0),
+      refreshed_tail_(0),
+      refresh_ok_(false),
+      slot_entries_(IPC::MAX_CHUNKS * IPC::CHUNK_SLOTS, NO_ENTRY),
+      positions_(IPC::MAX_CHUNKS * IPC::CHUNK_SLOTS, ServerPositions{UNKNOWN, UNKNOWN}) {
+    for (uint32_t i = 0; i < MAX_FETCH; ++i) {
+        entries_[i] = Entry{};
+        entries_[i].data = arena_.get() + i * FETCH_SIZE;
+        free_entries_[free_count_++] = static_cast<uint16_t>(MAX_FETCH - 1 - i);
+    }
+    ring_sessions_.reserve(QUEUE_ENTRIES);
+    completions_.reserve(QUEUE_ENTRIES);
+
+    queue_.register_file();
+    queue_.register_buffer(arena_.get(), MAX_FETCH * FETCH_SIZE + STAGING_SIZE);
+}
+
+BatchedRegions::~BatchedRegions() {
+    flush();
+}
+
+BatchedRegions::Entry* BatchedRegions::find(uint32_t slot) {
+    uint16_t index = slot < slot_entries_.size() ? slot_entries_[slot] : NO_ENTRY;
+    return index != NO_ENTRY ? &entries_[index] : nullptr;
+}
+
+void BatchedRegions::release(Entry& entry) {
+    queue_dirty(entry);
+    slot_entries_[entry.slot] = NO_ENTRY;
+    free_entries_[free_count_++] = static_cast<uint16_t>(&entry - entries_);
+}
+
+// Сдвиги tail и head - по одной записи на копию, сколько бы сообщений и ответов через неё ни прошло
+void BatchedRegions::queue_dirty(Entry& entry) {
+    const ServerPositions& positions = positions_[entry.slot];
+    if (entry.tail_dirty) {
+        queue_value(IPC::get_client_to_server_offset(entry.slot) + offsetof(IPC::RingControl, tail), positions.tail);
+        entry.tail_dirty = false;
+    }
+    if (entry.reply_dirty) {
+        queue_value(IPC::get_server_to_client_offset(entry.slot) + offsetof(IPC::RingControl, head),
+                    positions.reply_head);
+        entry.reply_dirty = false;
+    }
+}
+
+bool BatchedRegions::queue_value(uint32_t offset, uint32_t value) {
+    char* copy = staging_ + staging_used_;
+    std::memcpy(copy, &value, sizeof(value));
+    staging_used_ += sizeof(value);
+    return queue_.queue_write(offset, copy, sizeof(value), UringQueue::LINK, WRITE_REQUEST);
+}
+
+// Записи связаны в одну цепочку: данные ответа ложатся раньше его head, а
+// сдвиги одного кольца - по порядку (чтения в цепочку не входят: связанные
+// запросы ядро выполняет по одному). Место под записи освобождаемых копий и
+// под чтения следующей пачки держится в запасе.
+bool BatchedRegions::reserve_writes(uint32_t writes, uint32_t bytes) {
+    const uint32_t reserved_writes = 2 * MAX_FETCH;
+    if (queue_.prepared() + writes + reserved_writes + MAX_FETCH > queue_.capacity() ||
+        staging_used_ + bytes + reserved_writes * sizeof(uint32_t) > STAGING_SIZE) {
+        return flush();
+    }
+    return true;
+}
+
+bool BatchedRegions::submit() {
+    bool ok = queue_.submit_and_wait(completions_);
+    for (const UringQueue::Completion& completion : completions_) {
+        if (completion.user_data < MAX_FETCH) {
+            Entry& entry = entries_[completion.user_data];
+            entry.failed = completion.result != static_cast<int32_t>(FETCH_SIZE);
+            if (!entry.failed) {
+                // Свои поля в копии могут отставать от записей той же пачки
+                const char* reply = entry.data + IPC::CLIENT_TO_SERVER_SIZE;
+                ServerPositions& positions = positions_[entry.slot];
+                std::memcpy(&entry.head, entry.data + offsetof(IPC::RingControl, head), sizeof(entry.head));
+                std::memcpy(&entry.reply_tail, reply + offsetof(IPC::RingControl, tail), sizeof(entry.reply_tail));
+                if (positions.tail == UNKNOWN) {
+                    std::memcpy(&positions.tail, entry.data + offsetof(IPC::RingControl, tail), sizeof(positions.tail));
+                }
+                if (positions.reply_head == UNKNOWN) {
+                    std::memcpy(&positions.reply_head, reply + offsetof(IPC::RingControl, head),
+                                sizeof(positions.reply_head));
+                }
+            }
+        } else if (completion.user_data == REFRESH_REQUEST) {
+            refresh_ok_ = completion.result == static_cast<int32_t>(sizeof(refreshed_tail_));
+        }
+        // Ошибка записи, как и в файловом режиме, не повторяется: клиент переспросит
+    }
+    staging_used_ = 0;
+
+    // Клиент, разбуженный звонком, уже видит ответ в файле
+    for (uint32_t session_id : ring_sessions_) {
+        client_doorbell(session_id).ring();
+    }
+    ring_sessions_.clear();
+    return ok;
+}
+
+void BatchedRegions::invalidate(uint32_t slot) {
+    Entry* entry = find(slot);
+    if (entry != nullptr) {
+        entry->complete = false;
+    }
+}
+
+BatchedRegions::SlotRead BatchedRegions::read(uint32_t slot, char* buffer, size_t capacity, size_t& size) {
+    Entry* entry = find(slot);
+    if (entry == nullptr) {
+        return SlotRead::NOT_CACHED;
+    }
+    if (entry->failed) {
+        // Как и в файловом режиме: непрочитанный регион считается пустым
+        release(*entry);
+        return SlotRead::EMPTY;
+    }
+
+    const char* ring = entry->data + IPC::RING_CONTROL_SIZE;
+    uint32_t& tail = positions_[slot].tail;
+    uint32_t message_pos = 0;
+    uint32_t message_size = 0;
+    uint32_t new_tail;
+    Ring::ReadResult result = Ring::next_record(ring, entry->head, tail, message_pos, message_size, new_tail);
+    if (result == Ring::ReadResult::CORRUPT || message_size > capacity) {
+        // Содержимое не разбирается - отбрасываем всё, что успел записать писатель
+        new_tail = Ring::is_valid_position(entry->head) ? entry->head : 0;
+        result = Ring::ReadResult::EMPTY;
+    }
+    if (new_tail != tail) {
+        tail = new_tail;
+        entry->tail_dirty = true;
+    }
+
+    if (result == Ring::ReadResult::MESSAGE) {
+        std::memcpy(buffer, ring + message_pos, message_size);
+        size = message_size;
+        return SlotRead::MESSAGE;
+    }
+
+    bool complete = entry->complete;
+    release(*entry);
+    return complete ? SlotRead::EMPTY : SlotRead::NOT_CACHED;
+}
+
+bool BatchedRegions::fetch(const uint32_t* slots, uint32_t count) {
+    if (!queue_.is_valid()) {
+        return false;
+    }
+    for (Entry& entry : entries_) {
+        if (find(entry.slot) == &entry) {
+            queue_dirty(entry);
+        }
+    }
+
+    for (uint32_t i = 0; i < count && free_count_ > 0; ++i) {
+        if (find(slots[i]) != nullptr) {
+            continue;
+        }
+        uint16_t index = free_entries_[--free_count_];
+        Entry& entry = entries_[index];
+        entry.slot = slots[i];
+        entry.complete = true;
+        entry.failed = true;
+        entry.tail_dirty = false;
+        entry.reply_dirty = false;
+        slot_entries_[entry.slot] = index;
+        queue_.queue_read(IPC::get_client_to_server_offset(entry.slot), entry.data, FETCH_SIZE, 0, index);
+    }
+    return submit();
+}
+
+bool BatchedRegions::write(uint32_t slot, uint32_t session_id, const char* data, size_t size) {
+    if (size < sizeof(Protocol::MessageHeader) || size > IPC::MAX_MESSAGE_SIZE) {
+        return false;
+    }
+
+    Entry* entry = find(slot);
+    if (entry == nullptr || entry->failed) {
+        // Слот не из текущей пачки: очередь уходит, а ответ пишется сразу, и
+        // head этого слота дальше снова берётся из файла
+        bool written = flush() &&
+                       write_to_region_impl(IPC::SOCKET_FILE, IPC::get_server_to_client_offset(slot), data, size);
+        positions_[slot].reply_head = UNKNOWN;
+        if (written) {
+            client_doorbell(session_id).ring();
+        }
+        return written;
+    }
+
+    uint32_t& reply_head = positions_[slot].reply_head;
+    uint32_t write_pos;
+    bool wrap;
+    uint32_t new_head;
+    if (!Ring::plan_write(reply_head, entry->reply_tail, static_cast<uint32_t>(size), write_pos, wrap, new_head)) {
+        // По копии места нет, но клиент мог прочитать ответы уже после неё
+        refresh_ok_ = false;
+        if (!queue_.queue_read(IPC::get_server_to_client_offset(slot) + offsetof(IPC::RingControl, tail),
+                               reinterpret_cast<char*>(&refreshed_tail_), sizeof(refreshed_tail_), 0,
+                               REFRESH_REQUEST) ||
+            !submit() || !refresh_ok_) {
+            return false;
+        }
+        entry->reply_tail = refreshed_tail_;
+        if (!Ring::plan_write(reply_head, entry->reply_tail, static_cast<uint32_t>(size), write_pos, wrap, new_head)) {
+            return false;
+        }
+    }
+
+    uint32_t record = Ring::record_size(static_cast<uint32_t>(size));
+    if (!reserve_writes(2, record + sizeof(uint32_t))) {
+        return false;
+    }
+    uint32_t data_offset = IPC::get_server_to_client_offset(slot) + IPC::RING_CONTROL_SIZE;
+    if (wrap) {
+        queue_value(data_offset + reply_head, IPC::RING_WRAP_MARKER);
+    }
+    char* copy = staging_ + staging_used_;
+    std::memcpy(copy, data, size);
+    staging_used_ += record;
+    queue_.queue_write(data_offset + write_pos, copy, static_cast<uint32_t>(size), UringQueue::LINK, WRITE_REQUEST);
+
+    reply_head = new_head;
+    entry->reply_dirty = true;
+    if (ring_sessions_.empty() || ring_sessions_.back() != session_id) {
+        ring_sessions_.push_back(session_id);
+    }
+    return true;
+}
+
+bool BatchedRegions::flush() {
+    for (Entry& entry : entries_) {
+        if (find(entry.slot) == &entry) {
+            queue_dirty(entry);
+        }
+    }
+    return submit();
+}
+
+}
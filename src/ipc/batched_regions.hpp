@@ -0,0 +1,104 @@
+#ifndef BATCHED_REGIONS_HPP
+#define BATCHED_REGIONS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "ipc_common.hpp"
+#include "uring_queue.hpp"
+
+namespace FileSocket {
+
+// Ввод-вывод регионов одного потока сервера в режиме Backend::URING.
+// Половины клиент→сервер ожидающих слотов читаются пачкой - до MAX_FETCH
+// слотов одним io_uring_enter - вместе с управляющим блоком встречной
+// половины, и сообщения разбираются из этих копий. Ответы клиентам и сдвиги
+// tail не пишутся сразу, а копятся цепочкой записей: она уходит тем же
+// вызовом, что и следующие чтения (или flush перед ожиданием звонка), и
+// только после её завершения звонят звонки клиентов.
+//
+// Чтения не ждут записей пачки: поля колец, которые пишет сервер (tail
+// очереди к серверу и head очереди к клиенту), поток помнит сам и берёт из
+// файла только для слотов, которых ещё не касался.
+class BatchedRegions {
+public:
+    static constexpr uint32_t MAX_FETCH = 64;
+
+    enum class SlotRead {
+        MESSAGE,
+        EMPTY,      // копия свежая и кончилась - слот пуст
+        NOT_CACHED  // копии нет или клиент писал после её чтения - слот читается в следующей пачке
+    };
+
+private:
+    // Копия половины клиент→сервер и управляющего блока за ней
+    static constexpr uint32_t FETCH_SIZE = IPC::CLIENT_TO_SERVER_SIZE + IPC::RING_CONTROL_SIZE;
+    static constexpr uint32_t STAGING_SIZE = 32 * 1024;
+    static constexpr uint32_t QUEUE_ENTRIES = 512;
+    static constexpr uint16_t NO_ENTRY = UINT16_MAX;
+
+    static constexpr uint32_t UNKNOWN = UINT32_MAX;
+
+    // Поля колец слота, которые пишет только сервер
+    struct ServerPositions {
+        uint32_t tail;          // клиент→сервер
+        uint32_t reply_head;    // сервер→клиент
+    };
+
+    struct Entry {
+        uint32_t slot;
+        uint32_t head;          // клиент→сервер, по копии
+        uint32_t reply_tail;    // сервер→клиент, по копии
+        bool complete;          // после чтения клиент не отмечал слот
+        bool failed;
+        bool tail_dirty;        // positions_ ещё не записаны в файл
+        bool reply_dirty;
+        char* data;             // FETCH_SIZE байт в arena_
+    };
+
+    UringQueue queue_;
+    std::unique_ptr<char[]> arena_;     // копии слотов, затем буфер записей
+    char* staging_;
+    uint32_t staging_used_;
+    Entry entries_[MAX_FETCH];
+    uint16_t free_entries_[MAX_FETCH];
+    uint32_t free_count_;
+    uint32_t refreshed_tail_;
+    bool refresh_ok_;
+    std::vector<uint16_t> slot_entries_;
+    std::vector<ServerPositions> positions_;
+    std::vector<uint32_t> ring_sessions_;
+    std::vector<UringQueue::Completion> completions_;
+
+    Entry* find(uint32_t slot);
+    void release(Entry& entry);
+    void queue_dirty(Entry& entry);
+    bool queue_value(uint32_t offset, uint32_t value);
+    bool reserve_writes(uint32_t writes, uint32_t bytes);
+    bool submit();
+
+public:
+    BatchedRegions();
+    ~BatchedRegions();
+
+    bool is_valid() const { return queue_.is_valid(); }
+
+    // Клиент снова отметил слот: его копия больше не полная
+    void invalidate(uint32_t slot);
+    // Следующее сообщение слота из копии; size - его размер для MESSAGE
+    SlotRead read(uint32_t slot, char* buffer, size_t capacity, size_t& size);
+    // Отправляет накопленные записи и читает слоты (не больше MAX_FETCH) одной пачкой
+    bool fetch(const uint32_t* slots, uint32_t count);
+    // Ставит ответ в очередь; звонок клиенту session_id - после отправки
+    bool write(uint32_t slot, uint32_t session_id, const char* data, size_t size);
+    // Отправляет накопленные записи и звонит клиентам
+    bool flush();
+
+    BatchedRegions(const BatchedRegions&) = delete;
+    BatchedRegions& operator=(const BatchedRegions&) = delete;
+};
+
+}
+
+#endif
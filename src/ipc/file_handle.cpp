@@ -1,8 +1,13 @@
 #include "file_handle.hpp"
-#include <windows.h>
+#include "ipc_common.hpp"
+#ifndef _WIN32
+#include <unistd.h>
+#endif
 
 namespace FileSocket {
 
+#ifdef _WIN32
+
 FileHandle::FileHandle(const std::string& filename, DWORD desiredAccess, DWORD shareMode) 
     : filename_(filename) {
     handle_ = CreateFileA(filename.c_str(), desiredAccess, shareMode,
@@ -32,4 +37,41 @@ FileHandle& FileHandle::operator=(FileHandle&& other) noexcept {
     return *this;
 }
 
+#else
+
+FileHandle::FileHandle(const std::string& filename, int flags, mode_t mode)
+    : filename_(filename) {
+    handle_ = ::open(filename.c_str(), flags | O_CLOEXEC, mode);
+}
+
+FileHandle::~FileHandle() {
+    if (is_valid()) {
+        ::close(handle_);
+    }
+}
+
+FileHandle::FileHandle(FileHandle&& other) noexcept 
+    : handle_(other.handle_), filename_(std::move(other.filename_)) {
+    other.handle_ = -1;
+}
+
+FileHandle& FileHandle::operator=(FileHandle&& other) noexcept {
+    if (this != &other) {
+        if (is_valid()) {
+            ::close(handle_);
+        }
+        handle_ = other.handle_;
+        filename_ = std::move(other.filename_);
+        other.handle_ = -1;
+    }
+    return *this;
+}
+
+FileHandle& get_socket_handle() {
+    static FileHandle handle(IPC::SOCKET_FILE);
+    return handle;
+}
+
+#endif
+
 } 
@@ -2,21 +2,37 @@
 #define FILE_HANDLE_HPP
 
 #include <string>
+#ifdef _WIN32
 #include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/types.h>
+#endif
 
 namespace FileSocket {
 
+#ifdef _WIN32
+typedef HANDLE NativeHandle;
+#else
+typedef int NativeHandle;
+#endif
+
 class FileHandle {
 private:
-    HANDLE handle_;
+    NativeHandle handle_;
     std::string filename_;
     
 public:
+#ifdef _WIN32
     FileHandle(const std::string& filename, DWORD desiredAccess, DWORD shareMode);
+    bool is_valid() const { return handle_ != INVALID_HANDLE_VALUE; }
+#else
+    FileHandle(const std::string& filename, int flags = O_RDWR | O_CREAT, mode_t mode = 0666);
+    bool is_valid() const { return handle_ >= 0; }
+#endif
     ~FileHandle();
     
-    bool is_valid() const { return handle_ != INVALID_HANDLE_VALUE; }
-    HANDLE get() const { return handle_; }
+    NativeHandle get() const { return handle_; }
     const std::string& get_filename() const { return filename_; }
     
     FileHandle(const FileHandle&) = delete;
@@ -26,6 +42,11 @@ public:
     FileHandle& operator=(FileHandle&& other) noexcept;
 };
 
+#ifndef _WIN32
+// Долгоживущий дескриптор IPC::SOCKET_FILE, общий на процесс
+FileHandle& get_socket_handle();
+#endif
+
 }
 
-#endif
\ No newline at end of file
+#endif
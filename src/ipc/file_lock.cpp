@@ -1,10 +1,15 @@
 #include "file_lock.hpp"
-#include <windows.h>
+#include "mapped_file.hpp"
 #include <thread>
+#include <chrono>
+#ifndef _WIN32
+#include <cerrno>
+#include <cstring>
+#endif
 
 namespace FileSocket {
 
-FileLock::FileLock(HANDLE file_handle, DWORD offset, DWORD size, bool auto_lock)
+FileLock::FileLock(NativeHandle file_handle, uint32_t offset, uint32_t size, bool auto_lock)
     : file_handle_(file_handle), offset_(offset), size_(size), is_locked_(false) {
     if (auto_lock) {
         lock();
@@ -15,23 +20,56 @@ FileLock::~FileLock() {
     unlock();
 }
 
+// Счётчики медленного пути в статистике сервера (если файл уже отображён)
+static void add_lock_stat(std::atomic<uint64_t> IPC::StatsRegion::*counter, uint64_t value) {
+    IPC::StatsRegion* stats = get_stats_region();
+    if (stats != nullptr) {
+        (stats->*counter).fetch_add(value, std::memory_order_relaxed);
+    }
+}
+
+static uint64_t elapsed_ns(std::chrono::steady_clock::time_point start) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+}
+
+#ifdef _WIN32
+
 bool FileLock::lock(int max_retries) {
     if (is_locked_ || file_handle_ == INVALID_HANDLE_VALUE) return false;
     
     for (int attempt = 0; attempt < max_retries; ++attempt) {
+        if (attempt > 0) {
+            add_lock_stat(&IPC::StatsRegion::lock_retries, 1);
+        }
         OVERLAPPED ov = {};
         ov.Offset = offset_;
         
-        if (LockFileEx(file_handle_, LOCKFILE_EXCLUSIVE_LOCK, 0, size_, 0, &ov)) {
+        // Сначала без ожидания: так видно, что диапазон держал кто-то другой
+        if (LockFileEx(file_handle_, LOCKFILE_EXCLUSIVE_LOCK | LOCKFILE_FAIL_IMMEDIATELY, 0, size_, 0, &ov)) {
             is_locked_ = true;
             return true;
         }
         
+        if (GetLastError() == ERROR_LOCK_VIOLATION) {
+            add_lock_stat(&IPC::StatsRegion::lock_contended, 1);
+            auto wait_start = std::chrono::steady_clock::now();
+            ov = OVERLAPPED();
+            ov.Offset = offset_;
+            bool locked = LockFileEx(file_handle_, LOCKFILE_EXCLUSIVE_LOCK, 0, size_, 0, &ov) != 0;
+            add_lock_stat(&IPC::StatsRegion::lock_wait_ns, elapsed_ns(wait_start));
+            if (locked) {
+                is_locked_ = true;
+                return true;
+            }
+        }
+        
         if (attempt < max_retries - 1) {
             Sleep(100 * (attempt + 1));
         }
     }
     
+    add_lock_stat(&IPC::StatsRegion::lock_failures, 1);
     return false;
 }
 
@@ -45,4 +83,70 @@ bool FileLock::unlock() {
     return result;
 }
 
+#else
+
+static bool set_ofd_lock(int fd, short type, uint32_t offset, uint32_t size, int cmd) {
+    struct flock fl;
+    std::memset(&fl, 0, sizeof(fl));
+    fl.l_type = type;
+    fl.l_whence = SEEK_SET;
+    fl.l_start = offset;
+    fl.l_len = size;
+    // Для OFD-блокировок l_pid обязан быть нулём
+    fl.l_pid = 0;
+    
+    while (fcntl(fd, cmd, &fl) != 0) {
+        if (errno != EINTR) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FileLock::lock(int max_retries) {
+    if (is_locked_ || file_handle_ < 0) return false;
+    
+    for (int attempt = 0; attempt < max_retries; ++attempt) {
+        if (attempt > 0) {
+            add_lock_stat(&IPC::StatsRegion::lock_retries, 1);
+        }
+        
+        // Сначала без ожидания: так видно, что диапазон держал кто-то другой.
+        // Без конкуренции это тот же один вызов fcntl.
+        if (set_ofd_lock(file_handle_, F_WRLCK, offset_, size_, F_OFD_SETLK)) {
+            is_locked_ = true;
+            return true;
+        }
+        
+        if (errno == EAGAIN || errno == EACCES) {
+            // Как и LockFileEx без LOCKFILE_FAIL_IMMEDIATELY - ждём освобождения диапазона
+            add_lock_stat(&IPC::StatsRegion::lock_contended, 1);
+            auto wait_start = std::chrono::steady_clock::now();
+            bool locked = set_ofd_lock(file_handle_, F_WRLCK, offset_, size_, F_OFD_SETLKW);
+            add_lock_stat(&IPC::StatsRegion::lock_wait_ns, elapsed_ns(wait_start));
+            if (locked) {
+                is_locked_ = true;
+                return true;
+            }
+        }
+        
+        if (attempt < max_retries - 1) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100 * (attempt + 1)));
+        }
+    }
+    
+    add_lock_stat(&IPC::StatsRegion::lock_failures, 1);
+    return false;
+}
+
+bool FileLock::unlock() {
+    if (!is_locked_ || file_handle_ < 0) return false;
+    
+    bool result = set_ofd_lock(file_handle_, F_UNLCK, offset_, size_, F_OFD_SETLK);
+    is_locked_ = false;
+    return result;
+}
+
+#endif
+
 } 
@@ -1,19 +1,24 @@
 #ifndef FILE_LOCK_HPP
 #define FILE_LOCK_HPP
 
-#include <windows.h>
+#include <cstdint>
+#include "file_handle.hpp"
 
 namespace FileSocket {
 
+// Эксклюзивная блокировка диапазона байт файла.
+// Windows: LockFileEx. POSIX: блокировки open file description (F_OFD_SETLKW) -
+// они принадлежат дескриптору, а не процессу, поэтому не снимаются при закрытии
+// других дескрипторов того же файла.
 class FileLock {
 private:
-    HANDLE file_handle_;
-    DWORD offset_;
-    DWORD size_;
+    NativeHandle file_handle_;
+    uint32_t offset_;
+    uint32_t size_;
     bool is_locked_;
     
 public:
-    FileLock(HANDLE file_handle, DWORD offset, DWORD size, bool auto_lock = true);
+    FileLock(NativeHandle file_handle, uint32_t offset, uint32_t size, bool auto_lock = true);
     ~FileLock();
     
     bool lock(int max_retries = 3);
@@ -26,4 +31,4 @@ public:
 
 } 
 
-#endif
\ No newline at end of file
+#endif
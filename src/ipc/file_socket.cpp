@@ -1,43 +1,453 @@
 #include "file_socket.hpp"
 #include "region_ops.hpp"
+#include "mapped_file.hpp"
+#include "notify.hpp"
+#include "slot_table.hpp"
+#include "uring_queue.hpp"
 #include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
 
 namespace FileSocket {
 
-bool write_to_client_region(uint32_t session_id, const std::vector<char>& data) {
+static Backend available_backend(Backend backend) {
+    if (backend == Backend::URING && !UringQueue::is_supported()) {
+        std::cout << "io_uring is not available, using " << backend_name(Backend::FILE_IO) << std::endl;
+        return Backend::FILE_IO;
+    }
+    return backend;
+}
+
+static Backend default_backend() {
+    Backend backend = Backend::FILE_IO;
+    const char* env = std::getenv("HANGMAN_IPC_BACKEND");
+    if (env != nullptr && !parse_backend(env, backend)) {
+        std::cout << "Unknown IPC backend '" << env << "', using " << backend_name(backend) << std::endl;
+    }
+    return available_backend(backend);
+}
+
+static Backend& current_backend() {
+    static Backend backend = default_backend();
+    return backend;
+}
+
+Backend get_backend() {
+    return current_backend();
+}
+
+void set_backend(Backend backend) {
+    current_backend() = available_backend(backend);
+}
+
+bool parse_backend(const std::string& name, Backend& backend) {
+    if (name == "file") {
+        backend = Backend::FILE_IO;
+        return true;
+    }
+    if (name == "mmap") {
+        backend = Backend::MAPPED;
+        return true;
+    }
+    if (name == "uring") {
+        backend = Backend::URING;
+        return true;
+    }
+    return false;
+}
+
+const char* backend_name(Backend backend) {
+    switch (backend) {
+        case Backend::FILE_IO: return "file";
+        case Backend::MAPPED: return "mmap";
+        case Backend::URING: return "uring";
+    }
+    return "unknown";
+}
+
+// Отображение создаётся и в файловом режиме: через него проверяется версия
+// раскладки файла, ведётся таблица слотов и работают звонки
+static bool write_region(uint32_t offset, const char* data, size_t size) {
+    get_socket_mapping();
+    if (get_backend() == Backend::MAPPED) {
+        return write_to_region_mapped(offset, data, size);
+    }
+    return write_to_region_impl(IPC::SOCKET_FILE, offset, data, size);
+}
+
+static size_t read_region(uint32_t offset, uint32_t size, char* buffer, size_t capacity) {
+    get_socket_mapping();
+    if (get_backend() == Backend::MAPPED) {
+        return read_from_region_mapped(offset, size, buffer, capacity);
+    }
+    return read_from_region_impl(IPC::SOCKET_FILE, offset, size, buffer, capacity);
+}
+
+// Пакеты потока сервера в режиме uring; nullptr в остальных режимах и если
+// очередь не создалась - тогда поток работает как в файловом режиме
+static BatchedRegions* server_batch() {
+    if (get_backend() != Backend::URING) {
+        return nullptr;
+    }
+    get_socket_mapping();
+    static thread_local std::unique_ptr<BatchedRegions> batch(new BatchedRegions());
+    return batch->is_valid() ? batch.get() : nullptr;
+}
+
+static thread_local uint32_t server_worker_id = 0;
+static thread_local uint32_t server_worker_count = 1;
+
+bool start_server(uint32_t worker_count) {
+    SocketMapping& mapping = get_socket_mapping();
+    if (!mapping.is_valid() || worker_count == 0 || worker_count > static_cast<uint32_t>(IPC::MAX_SERVER_WORKERS)) {
+        return false;
+    }
+    
+    // Каждому потоку - хотя бы по блоку, иначе все первые сессии попадут к нулевому
+    for (uint32_t count = mapping.chunk_count(); count < worker_count; count = mapping.chunk_count()) {
+        if (!mapping.grow(count)) {
+            return false;
+        }
+    }
+    
+    // Статистика прошлого запуска сервера не смешивается с новой
+    IPC::StatsRegion* stats = get_stats_region();
+    std::memset(static_cast<void*>(stats), 0, sizeof(IPC::StatsRegion));
+#ifdef _WIN32
+    stats->server_pid.store(GetCurrentProcessId(), std::memory_order_relaxed);
+#else
+    stats->server_pid.store(static_cast<uint64_t>(getpid()), std::memory_order_relaxed);
+#endif
+    stats->started_ms.store(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count()), std::memory_order_release);
+    
+    mapping.header()->worker_count.store(worker_count, std::memory_order_release);
+    return true;
+}
+
+void set_server_worker(uint32_t worker_id, uint32_t worker_count) {
+    server_worker_id = worker_id;
+    server_worker_count = worker_count;
+}
+
+uint32_t get_server_worker_id() {
+    return server_worker_id;
+}
+
+uint32_t get_server_worker_count() {
+    return server_worker_count;
+}
+
+bool connect_session(uint32_t session_id) {
+    uint32_t slot = find_session_slot(session_id);
+    if (slot != IPC::INVALID_SLOT && get_slot_owner(slot) == session_id) {
+        return true;
+    }
+    
+    slot = claim_slot(session_id);
+    if (slot == IPC::INVALID_SLOT) {
+        return false;
+    }
+    
+    bind_session_slot(session_id, slot);
+    return true;
+}
+
+void release_session(uint32_t session_id) {
+    uint32_t slot = find_session_slot(session_id);
+    if (slot != IPC::INVALID_SLOT) {
+        release_slot(slot, session_id);
+        unbind_session_slot(session_id);
+    }
+}
+
+void collect_session_slots(std::unordered_map<uint32_t, uint32_t>& slots) {
+    slots.clear();
+    SocketMapping& mapping = get_socket_mapping();
+    uint32_t chunk_count = mapping.chunk_count();
+    for (uint32_t slot = 0; slot < chunk_count * IPC::CHUNK_SLOTS; ++slot) {
+        uint32_t owner = get_slot_owner(slot);
+        if (IPC::is_valid_session_id(owner)) {
+            slots[owner] = slot;
+        }
+    }
+}
+
+void adopt_session(uint32_t session_id, uint32_t slot) {
+    bind_session_slot(session_id, slot);
+}
+
+// Слот клиента: если сервер успел освободить его (например, после долгого
+// простоя), занимаем новый - сервер узнает его по следующему сообщению
+static uint32_t client_slot(uint32_t session_id) {
+    if (!connect_session(session_id)) {
+        return IPC::INVALID_SLOT;
+    }
+    return find_session_slot(session_id);
+}
+
+// Отмечает слот как ожидающий чтения и будит поток сервера, владеющий блоком
+static void notify_server(uint32_t slot) {
+    SocketMapping& mapping = get_socket_mapping();
+    uint32_t chunk = IPC::get_slot_chunk(slot);
+    IPC::ChunkHeader* chunk_header = mapping.chunk_header(chunk);
+    if (chunk_header == nullptr) {
+        return;
+    }
+    
+    // Сначала бит слота, затем бит блока: сервер забирает их в обратном порядке
+    IPC::SocketFileHeader* header = mapping.header();
+    chunk_header->pending.fetch_or(1ull << IPC::get_slot_index_in_chunk(slot), std::memory_order_release);
+    header->pending_chunks[chunk / 64].fetch_or(1ull << (chunk % 64), std::memory_order_release);
+    
+    uint32_t worker_count = header->worker_count.load(std::memory_order_relaxed);
+    server_doorbell(IPC::get_chunk_worker(chunk, worker_count)).ring();
+}
+
+bool write_to_client_region(uint32_t session_id, const char* data, size_t size) {
     if (!IPC::is_valid_session_id(session_id)) {
         return false;
     }
     
-    uint32_t offset = IPC::get_client_to_server_offset(session_id);
-    return write_to_region_impl(IPC::SOCKET_FILE, offset, data);
+    uint32_t slot = client_slot(session_id);
+    if (slot == IPC::INVALID_SLOT) {
+        return false;
+    }
+    
+    uint32_t offset = IPC::get_client_to_server_offset(slot);
+    if (!write_region(offset, data, size)) {
+        return false;
+    }
+    
+    notify_server(slot);
+    return true;
 }
 
-bool write_to_server_region(uint32_t session_id, const std::vector<char>& data) {
+bool write_to_server_region(uint32_t session_id, const char* data, size_t size) {
     if (!IPC::is_valid_session_id(session_id)) {
         return false;
     }
     
-    uint32_t offset = IPC::get_server_to_client_offset(session_id);
-    return write_to_region_impl(IPC::SOCKET_FILE, offset, data);
+    // Слот могли освободить и отдать другому клиенту: ответ в него ушёл бы чужой сессии
+    uint32_t slot = find_session_slot(session_id);
+    if (slot == IPC::INVALID_SLOT) {
+        return false;
+    }
+    if (get_slot_owner(slot) != session_id) {
+        unbind_session_slot(session_id);
+        return false;
+    }
+    
+    // В режиме uring ответ уходит со следующей пачкой, звонок - после неё
+    BatchedRegions* batch = server_batch();
+    if (batch != nullptr) {
+        return batch->write(slot, session_id, data, size);
+    }
+    
+    uint32_t offset = IPC::get_server_to_client_offset(slot);
+    if (!write_region(offset, data, size)) {
+        return false;
+    }
+    
+    client_doorbell(session_id).ring();
+    return true;
 }
 
-std::vector<char> read_from_client_region(uint32_t session_id) {
+size_t read_from_client_region(uint32_t session_id, char* buffer, size_t capacity) {
     if (!IPC::is_valid_session_id(session_id)) {
-        return {};
+        return 0;
     }
     
-    uint32_t offset = IPC::get_client_to_server_offset(session_id);
-    return read_from_region_impl(IPC::SOCKET_FILE, offset, IPC::CLIENT_TO_SERVER_SIZE);
+    uint32_t slot = find_session_slot(session_id);
+    if (slot == IPC::INVALID_SLOT) {
+        return 0;
+    }
+    return read_from_client_slot(slot, buffer, capacity);
 }
 
-std::vector<char> read_from_server_region(uint32_t session_id) {
+size_t read_from_server_region(uint32_t session_id, char* buffer, size_t capacity) {
     if (!IPC::is_valid_session_id(session_id)) {
-        return {};
+        return 0;
+    }
+    
+    uint32_t slot = client_slot(session_id);
+    if (slot == IPC::INVALID_SLOT) {
+        return 0;
+    }
+    
+    uint32_t offset = IPC::get_server_to_client_offset(slot);
+    return read_region(offset, IPC::SERVER_TO_CLIENT_SIZE, buffer, capacity);
+}
+
+size_t read_from_client_slot(uint32_t slot, char* buffer, size_t capacity) {
+    if (!IPC::is_valid_slot(slot)) {
+        return 0;
     }
     
-    uint32_t offset = IPC::get_server_to_client_offset(session_id);
-    return read_from_region_impl(IPC::SOCKET_FILE, offset, IPC::SERVER_TO_CLIENT_SIZE);
+    uint32_t offset = IPC::get_client_to_server_offset(slot);
+    while (true) {
+        size_t size = read_region(offset, IPC::CLIENT_TO_SERVER_SIZE, buffer, capacity);
+        if (size < sizeof(uint32_t)) {
+            return size;
+        }
+        
+        // Сообщения прежнего владельца слота отбрасываются
+        uint32_t session_id;
+        std::memcpy(&session_id, buffer, sizeof(session_id));
+        if (get_slot_owner(slot) == session_id) {
+            bind_session_slot(session_id, slot);
+            return size;
+        }
+    }
+}
+
+void flush_server_writes() {
+    BatchedRegions* batch = server_batch();
+    if (batch != nullptr) {
+        batch->flush();
+    }
 }
 
-} 
+// Сообщение из копии слота; false - копии нет, слот читается следующей пачкой
+static bool read_batched_slot(BatchedRegions& batch, uint32_t slot, char* buffer, size_t capacity, size_t& size) {
+    while (true) {
+        size = 0;
+        BatchedRegions::SlotRead result = batch.read(slot, buffer, capacity, size);
+        if (result != BatchedRegions::SlotRead::MESSAGE) {
+            return result == BatchedRegions::SlotRead::EMPTY;
+        }
+        
+        // Сообщения прежнего владельца слота отбрасываются
+        uint32_t session_id;
+        std::memcpy(&session_id, buffer, sizeof(session_id));
+        if (get_slot_owner(slot) == session_id) {
+            bind_session_slot(session_id, slot);
+            return true;
+        }
+    }
+}
+
+ClientRegionScanner::ClientRegionScanner(uint32_t worker_id, uint32_t worker_count)
+    : worker_id_(worker_id), worker_count_(worker_count == 0 ? 1 : worker_count),
+      next_chunk_(worker_id), next_index_(0), fetch_count_(0) {
+    std::memset(pending_slots_, 0, sizeof(pending_slots_));
+    std::memset(owned_chunks_, 0, sizeof(owned_chunks_));
+    for (uint32_t chunk = worker_id_; chunk < static_cast<uint32_t>(IPC::MAX_CHUNKS); chunk += worker_count_) {
+        owned_chunks_[chunk / 64] |= 1ull << (chunk % 64);
+    }
+}
+
+void ClientRegionScanner::collect_pending(BatchedRegions* batch) {
+    SocketMapping& mapping = get_socket_mapping();
+    IPC::SocketFileHeader* header = mapping.header();
+    if (header == nullptr) {
+        return;
+    }
+    
+    // Биты чужих блоков не трогаем - их забирают другие потоки
+    for (int word = 0; word < IPC::MAX_CHUNKS / 64; ++word) {
+        uint64_t owned = owned_chunks_[word];
+        if ((header->pending_chunks[word].load(std::memory_order_relaxed) & owned) == 0) {
+            continue;
+        }
+        
+        uint64_t chunks = header->pending_chunks[word].fetch_and(~owned, std::memory_order_acquire) & owned;
+        while (chunks != 0) {
+            uint32_t chunk = word * 64 + lowest_bit(chunks);
+            chunks &= chunks - 1;
+            
+            IPC::ChunkHeader* chunk_header = mapping.chunk_header(chunk);
+            if (chunk_header == nullptr) {
+                continue;
+            }
+            uint64_t slots = chunk_header->pending.exchange(0, std::memory_order_acquire);
+            pending_slots_[chunk] |= slots;
+            // Копия, прочитанная до новой записи клиента, не может сказать, что слот пуст
+            for (; batch != nullptr && slots != 0; slots &= slots - 1) {
+                batch->invalidate(chunk * IPC::CHUNK_SLOTS + lowest_bit(slots));
+            }
+        }
+    }
+}
+
+size_t ClientRegionScanner::read_next(char* buffer, size_t capacity) {
+    BatchedRegions* batch = server_batch();
+    collect_pending(batch);
+    
+    // Пока в копиях есть сообщения, они разбираются без ввода-вывода; когда
+    // кончились - слоты без копий читаются одной пачкой, и обход повторяется
+    while (true) {
+        fetch_count_ = 0;
+        size_t size = scan(buffer, capacity, batch);
+        if (size != 0 || fetch_count_ == 0) {
+            return size;
+        }
+        if (!batch->fetch(fetch_slots_, fetch_count_)) {
+            // Очередь сломалась - дальше поток читает регионы как в файловом режиме
+            batch = nullptr;
+        }
+    }
+}
+
+size_t ClientRegionScanner::scan(char* buffer, size_t capacity, BatchedRegions* batch) {
+    // Обход начинается после слота, ответившего последним, чтобы один
+    // активный клиент не заслонял остальных
+    uint32_t owned_chunks = (IPC::MAX_CHUNKS - worker_id_ + worker_count_ - 1) / worker_count_;
+    for (uint32_t step = 0; step <= owned_chunks; ++step) {
+        uint32_t chunk = (next_chunk_ + step * worker_count_) % (owned_chunks * worker_count_);
+        uint64_t bits = pending_slots_[chunk];
+        if (step == 0) {
+            bits &= ~0ull << next_index_;
+        }
+        
+        while (bits != 0) {
+            uint32_t index = lowest_bit(bits);
+            bits &= bits - 1;
+            
+            uint32_t slot = chunk * IPC::CHUNK_SLOTS + index;
+            size_t size = 0;
+            if (batch == nullptr) {
+                size = read_from_client_slot(slot, buffer, capacity);
+            } else if (!read_batched_slot(*batch, slot, buffer, capacity, size)) {
+                if (fetch_count_ < BatchedRegions::MAX_FETCH) {
+                    fetch_slots_[fetch_count_++] = slot;
+                }
+                continue;
+            }
+            if (size == 0) {
+                pending_slots_[chunk] &= ~(1ull << index);
+                continue;
+            }
+            
+            next_chunk_ = chunk;
+            next_index_ = index + 1;
+            if (next_index_ == static_cast<uint32_t>(IPC::CHUNK_SLOTS)) {
+                next_chunk_ = (chunk + worker_count_) % (owned_chunks * worker_count_);
+                next_index_ = 0;
+            }
+            return size;
+        }
+    }
+    
+    return 0;
+}
+
+uint32_t ClientRegionScanner::lowest_bit(uint64_t bits) {
+#if defined(__GNUC__)
+    return static_cast<uint32_t>(__builtin_ctzll(bits));
+#else
+    uint32_t index = 0;
+    while ((bits & 1) == 0) {
+        bits >>= 1;
+        ++index;
+    }
+    return index;
+#endif
+}
+
+}
@@ -2,20 +2,91 @@
 #define FILE_SOCKET_HPP
 
 #include <string>
-#include <vector>
+#include <cstddef>
 #include <cstdint>
+#include <unordered_map>
 #include "ipc_common.hpp"
 
+#include "batched_regions.hpp"
 #include "file_handle.hpp"
 #include "file_lock.hpp"
+#include "notify.hpp"
 
 namespace FileSocket {
 
-bool write_to_client_region(uint32_t session_id, const std::vector<char>& data);
-bool write_to_server_region(uint32_t session_id, const std::vector<char>& data);
-std::vector<char> read_from_client_region(uint32_t session_id);
-std::vector<char> read_from_server_region(uint32_t session_id);
+// Способ доступа к регионам файла-сокета
+enum class Backend {
+    FILE_IO,   // открытие файла, блокировка диапазона и ReadFile/WriteFile на каждое сообщение
+    MAPPED,    // файл отображается в память один раз, сообщения копируются прямо в регионы
+    URING      // как FILE_IO, но сервер читает и пишет регионы пачками через io_uring (Linux)
+};
+
+// По умолчанию берётся из переменной окружения HANGMAN_IPC_BACKEND ("file" / "mmap" / "uring").
+// Сервер и клиент должны использовать один и тот же режим; клиент в режиме uring
+// работает как в file. Без io_uring set_backend(URING) выбирает FILE_IO.
+Backend get_backend();
+void set_backend(Backend backend);
+bool parse_backend(const std::string& name, Backend& backend);
+const char* backend_name(Backend backend);
+
+// Сервер из нескольких потоков без общих данных: поток worker_id обслуживает
+// только блоки файла с chunk % worker_count == worker_id и ждёт на своём звонке.
+// start_server публикует число потоков для клиентов; set_server_worker
+// вызывается в каждом потоке-обработчике до первого чтения.
+bool start_server(uint32_t worker_count);
+void set_server_worker(uint32_t worker_id, uint32_t worker_count);
+uint32_t get_server_worker_id();
+uint32_t get_server_worker_count();
+
+// Клиент занимает свободный слот файла при подключении; запись в регион
+// неподключённой сессии подключает её автоматически
+bool connect_session(uint32_t session_id);
+// Освобождает слот сессии (клиент при выходе, сервер при удалении сессии)
+void release_session(uint32_t session_id);
+// Сервер после перезапуска: какие сессии держат слоты файла (session_id -> слот);
+// adopt_session привязывает сессию к слоту в текущем потоке до её первого сообщения
+void collect_session_slots(std::unordered_map<uint32_t, uint32_t>& slots);
+void adopt_session(uint32_t session_id, uint32_t slot);
+
+// Запись будит ожидающего читателя через звонок в заголовке файла (см. notify.hpp)
+// Чтение копирует одно сообщение в buffer вызывающего (не меньше IPC::MAX_MESSAGE_SIZE)
+// и возвращает его размер; 0 - сообщений нет. Память при этом не выделяется.
+bool write_to_client_region(uint32_t session_id, const char* data, size_t size);
+bool write_to_server_region(uint32_t session_id, const char* data, size_t size);
+size_t read_from_client_region(uint32_t session_id, char* buffer, size_t capacity);
+size_t read_from_server_region(uint32_t session_id, char* buffer, size_t capacity);
+// Сервер: чтение из слота; сессия-владелец запоминается для ответа
+size_t read_from_client_slot(uint32_t slot, char* buffer, size_t capacity);
+// Сервер в режиме uring: отправляет отложенные ответы; вызывается перед ожиданием звонка
+void flush_server_writes();
+
+// Сервер: обход регионов своих блоков, в которые клиенты писали. Флаги забираются из
+// заголовков файла и блоков; пока писать никто не начал, опрос - одно чтение
+// заголовка файла. Слот остаётся в локальном наборе, пока чтение не вернёт пусто.
+// В режиме uring сначала разбираются уже прочитанные копии слотов, а слоты без
+// копий читаются следующей пачкой.
+class ClientRegionScanner {
+private:
+    uint64_t pending_slots_[IPC::MAX_CHUNKS];
+    uint64_t owned_chunks_[IPC::MAX_CHUNKS / 64];
+    uint32_t worker_id_;
+    uint32_t worker_count_;
+    uint32_t next_chunk_;
+    uint32_t next_index_;
+    uint32_t fetch_slots_[BatchedRegions::MAX_FETCH];
+    uint32_t fetch_count_;
+    
+    void collect_pending(BatchedRegions* batch);
+    size_t scan(char* buffer, size_t capacity, BatchedRegions* batch);
+    static uint32_t lowest_bit(uint64_t bits);
+    
+public:
+    ClientRegionScanner(uint32_t worker_id = 0, uint32_t worker_count = 1);
+    
+    // Следующее сообщение от любого клиента; 0, если очереди пусты
+    size_t read_next(char* buffer, size_t capacity);
+};
 
 } 
 
-#endif
\ No newline at end of file
+#endif
@@ -3,50 +3,173 @@
 
 #include <string>
 #include <cstdint>
+#include <atomic>
 
 namespace IPC {
     // Основные константы
     const std::string SOCKET_FILE = "hangman_socket.txt";
     const int MAX_MESSAGE_SIZE = 256;
-    const int MAX_SESSIONS = 10;
-    const int SESSION_REGION_SIZE = 1024;    // 1KB на сессию
+    const int SESSION_REGION_SIZE = 2048;    // 2KB на сессию
     const int FILE_HEADER_SIZE = 128;
-    const int CLIENT_TO_SERVER_SIZE = 512;   // Половина региона для клиента→сервера
-    const int SERVER_TO_CLIENT_SIZE = 512;   // Половина для сервера→клиента
+    const int CLIENT_TO_SERVER_SIZE = 1024;  // Половина региона для клиента→сервера
+    const int SERVER_TO_CLIENT_SIZE = 1024;  // Половина для сервера→клиента
     const int LOCK_TIMEOUT_MS = 5000;
     const int READ_TIMEOUT_MS = 10000;
     const int MAX_RETRY_ATTEMPTS = 3;
     const int RETRY_DELAY_MS = 100;
     
+    // Файл растёт блоками (chunk) по CHUNK_SLOTS регионов. Нулевой слот блока
+    // занят его заголовком (таблица слотов, флаги, звонки), в блоке 0 перед ним
+    // лежит ещё и заголовок файла. Размер блока кратен гранулярности
+    // отображения Windows (64KB), поэтому каждый блок отображается отдельно.
+    const int CHUNK_SLOTS = 64;
+    const int CHUNK_SIZE = CHUNK_SLOTS * SESSION_REGION_SIZE;
+    const int MAX_CHUNKS = 256;
+    const int SESSIONS_PER_CHUNK = CHUNK_SLOTS - 1;
+    const uint32_t INVALID_SLOT = UINT32_MAX;
+    // Слот 1 блока 0 отдан под статистику сервера (StatsRegion) и сессиям не выдаётся
+    const uint32_t STATS_SLOT = 1;
+    const int MAX_SESSIONS = MAX_CHUNKS * SESSIONS_PER_CHUNK - 1;
+    
+    // Многопоточный сервер: поток-обработчик w обслуживает блоки c, у которых c % worker_count == w
+    const int MAX_SERVER_WORKERS = 8;
+    
     // Константы для бинарного протокола
     const int BINARY_HEADER_SIZE = 20;  
     const int MAX_PAYLOAD_SIZE = MAX_MESSAGE_SIZE - BINARY_HEADER_SIZE;
     
+    // Каждая половина региона - кольцевой буфер одного писателя и одного читателя:
+    // управляющий блок, за ним RING_CAPACITY байт записей MessageHeader+payload,
+    // выровненных на 4 байта. Позиции head/tail - смещения внутри буфера данных.
+    const int RING_CONTROL_SIZE = 16;
+    const int RING_CAPACITY = CLIENT_TO_SERVER_SIZE - RING_CONTROL_SIZE;
+    const uint32_t RING_WRAP_MARKER = UINT32_MAX;  // session_id-маркер «продолжение с начала буфера»
+    
+    struct RingControl {
+        std::atomic<uint32_t> head;  // пишет только производитель
+        std::atomic<uint32_t> tail;  // пишет только потребитель
+        uint32_t reserved[2];
+    };
+    static_assert(sizeof(RingControl) == RING_CONTROL_SIZE, "ring control size mismatch");
+    
+    // Версия раскладки файла; файл с другой версией обнуляется при открытии
+    const uint32_t SOCKET_FILE_MAGIC = 0x484E474D;  // "HNGM"
+    const uint32_t SOCKET_FILE_VERSION = 5;
+    
+    // Раскладка заголовка файла (первые FILE_HEADER_SIZE байт).
+    // Слова-«звонки» увеличиваются писателем после записи сообщения,
+    // счётчики ожидающих позволяют не делать системный вызов пробуждения впустую.
+    struct SocketFileHeader {
+        std::atomic<uint32_t> magic;
+        std::atomic<uint32_t> version;
+        std::atomic<uint32_t> chunk_count;     // растёт под блокировкой заголовка файла
+        std::atomic<uint32_t> worker_count;    // публикует сервер при старте
+        std::atomic<uint32_t> server_doorbells[MAX_SERVER_WORKERS];
+        std::atomic<uint32_t> server_waiters[MAX_SERVER_WORKERS];
+        // Бит c - в блоке c есть регионы с флагом в ChunkHeader::pending
+        std::atomic<uint64_t> pending_chunks[MAX_CHUNKS / 64];
+    };
+    static_assert(sizeof(SocketFileHeader) <= FILE_HEADER_SIZE, "file header overflow");
+    
+    // Заголовок блока (в нулевом слоте блока сразу после FILE_HEADER_SIZE байт)
+    struct ChunkHeader {
+        // Бит i выставляется клиентом после записи в регион i клиент→сервер;
+        // сервер забирает слово целиком и читает только отмеченные регионы
+        std::atomic<uint64_t> pending;
+        std::atomic<uint32_t> used_slots;
+        uint32_t reserved;
+        std::atomic<uint32_t> owners[CHUNK_SLOTS];  // session_id владельца слота, 0 - свободен
+        std::atomic<uint32_t> client_doorbells[CHUNK_SLOTS];
+        std::atomic<uint32_t> client_waiters[CHUNK_SLOTS];
+    };
+    static_assert(FILE_HEADER_SIZE + sizeof(ChunkHeader) <= SESSION_REGION_SIZE, "chunk header overflow");
+    
+    // Виды сообщений в статистике сервера
+    namespace StatsMessage {
+        const int START = 0;
+        const int GUESS = 1;
+        const int BATCH = 2;
+        const int INVALID = 3;   // неразобранные, чужого типа или с неверной сессией
+        const int KINDS = 4;
+    }
+    
+    // Время обработки сообщения: корзина i < 2^(i+10) нс, последняя - всё остальное
+    const int STATS_LATENCY_BUCKETS = 10;
+    
+    // Счётчики одного потока сервера. Пишет их только сам поток (load + store,
+    // без атомарных RMW), читатели вроде hangman-top только читают. Размер кратен
+    // 64 байтам, чтобы потоки не делили строки кэша.
+    struct WorkerStats {
+        std::atomic<uint64_t> messages[StatsMessage::KINDS];
+        std::atomic<uint64_t> duplicates;
+        std::atomic<uint64_t> guesses;          // букв, включая буквы пакетов
+        std::atomic<uint64_t> games_won;
+        std::atomic<uint64_t> games_lost;
+        std::atomic<uint64_t> active_sessions;
+        std::atomic<uint64_t> busy_ns;          // обработка сообщений
+        std::atomic<uint64_t> idle_ns;          // ожидание сообщений
+        std::atomic<uint64_t> cleanups;
+        std::atomic<uint64_t> cleanup_ns;
+        std::atomic<uint64_t> cleanup_max_ns;
+        std::atomic<uint64_t> latency[STATS_LATENCY_BUCKETS];
+    };
+    static_assert(sizeof(WorkerStats) % 64 == 0, "worker stats must fill whole cache lines");
+    
+    struct StatsRegion {
+        std::atomic<uint64_t> started_ms;       // время старта сервера (system_clock), 0 - не запускался
+        std::atomic<uint64_t> server_pid;
+        // FileLock::lock всех процессов; считается только медленный путь,
+        // поэтому общие fetch_add здесь допустимы
+        std::atomic<uint64_t> lock_contended;   // диапазон был занят, пришлось ждать
+        std::atomic<uint64_t> lock_retries;
+        std::atomic<uint64_t> lock_failures;
+        std::atomic<uint64_t> lock_wait_ns;
+        uint64_t reserved[2];
+        WorkerStats workers[MAX_SERVER_WORKERS];
+    };
+    static_assert(sizeof(StatsRegion) <= SESSION_REGION_SIZE, "stats region overflow");
+    
     // Вспомогательные функции
     inline bool is_valid_session_id(uint32_t session_id) {
         return session_id != 0 && session_id != UINT32_MAX;
     }
     
-    inline uint32_t get_session_file_offset(uint32_t session_id) {
-        if (!is_valid_session_id(session_id)) {
-            return FILE_HEADER_SIZE; 
-        }
-        return FILE_HEADER_SIZE + (session_id % MAX_SESSIONS) * SESSION_REGION_SIZE;
+    inline uint32_t get_slot_chunk(uint32_t slot) {
+        return slot / CHUNK_SLOTS;
+    }
+    
+    inline uint32_t get_slot_index_in_chunk(uint32_t slot) {
+        return slot % CHUNK_SLOTS;
+    }
+    
+    inline bool is_valid_slot(uint32_t slot) {
+        return slot < static_cast<uint32_t>(MAX_CHUNKS * CHUNK_SLOTS) && get_slot_index_in_chunk(slot) != 0 &&
+               slot != STATS_SLOT;
+    }
+    
+    inline uint32_t get_chunk_worker(uint32_t chunk, uint32_t worker_count) {
+        return worker_count > 1 ? chunk % worker_count : 0;
+    }
+    
+    inline uint32_t get_chunk_file_offset(uint32_t chunk) {
+        return chunk * CHUNK_SIZE;
+    }
+    
+    inline uint32_t get_slot_file_offset(uint32_t slot) {
+        return slot * SESSION_REGION_SIZE;
     }
     
-    inline uint32_t get_client_to_server_offset(uint32_t session_id) {
-        return get_session_file_offset(session_id);
+    inline uint32_t get_client_to_server_offset(uint32_t slot) {
+        return get_slot_file_offset(slot);
     }
     
-    inline uint32_t get_server_to_client_offset(uint32_t session_id) {
-        uint32_t base_offset = get_session_file_offset(session_id);
-        return base_offset + CLIENT_TO_SERVER_SIZE;
+    inline uint32_t get_server_to_client_offset(uint32_t slot) {
+        return get_slot_file_offset(slot) + CLIENT_TO_SERVER_SIZE;
     }
     
     inline bool is_valid_region_offset(uint32_t offset) {
-        return offset >= FILE_HEADER_SIZE && 
-               offset < FILE_HEADER_SIZE + (MAX_SESSIONS * SESSION_REGION_SIZE);
+        return is_valid_slot(offset / SESSION_REGION_SIZE);
     }
 }
 
-#endif 
+#endif
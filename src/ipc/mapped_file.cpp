@@ -0,0 +1,303 @@
+#include "mapped_file.hpp"
+#include "file_lock.hpp"
+#include "ring_buffer.hpp"
+#include "../protocol/protocol.hpp"
+#include <atomic>
+#include <cstring>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace FileSocket {
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "uint32_t atomics must be lock-free");
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "atomic word must match file layout");
+
+// Публикуется, когда блок 0 отображён; FileLock читает его без обращения к
+// get_socket_mapping(), которое могло ещё не завершиться
+static std::atomic<IPC::StatsRegion*> stats_region(nullptr);
+
+#ifdef _WIN32
+
+MappedView::MappedView(NativeHandle file, uint32_t offset, size_t size)
+    : data_(nullptr), size_(0) {
+    // CreateFileMapping сам дорастит файл до нужного размера; объект отображения
+    // живёт, пока открыто представление, поэтому его дескриптор сразу закрываем
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READWRITE, 0, static_cast<DWORD>(offset + size), NULL);
+    if (mapping == NULL) {
+        return;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, offset, size);
+    CloseHandle(mapping);
+    if (view != NULL) {
+        data_ = static_cast<char*>(view);
+        size_ = size;
+    }
+}
+
+MappedView::~MappedView() {
+    if (data_ != nullptr) {
+        UnmapViewOfFile(data_);
+    }
+}
+
+static bool extend_file(NativeHandle file, uint32_t size) {
+    (void)file;
+    (void)size;
+    return true;
+}
+
+#else
+
+MappedView::MappedView(NativeHandle file, uint32_t offset, size_t size)
+    : data_(nullptr), size_(0) {
+    void* view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, offset);
+    if (view != MAP_FAILED) {
+        data_ = static_cast<char*>(view);
+        size_ = size;
+    }
+}
+
+MappedView::~MappedView() {
+    if (data_ != nullptr) {
+        munmap(data_, size_);
+    }
+}
+
+// Файл может быть создан другим процессом меньшего размера - только растим
+static bool extend_file(NativeHandle file, uint32_t size) {
+    struct stat st;
+    if (fstat(file, &st) != 0) {
+        return false;
+    }
+    return static_cast<uint64_t>(st.st_size) >= size || ftruncate(file, static_cast<off_t>(size)) == 0;
+}
+
+#endif
+
+#ifdef _WIN32
+SocketMapping::SocketMapping(const std::string& filename)
+    : file_(filename, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE) {
+#else
+SocketMapping::SocketMapping(const std::string& filename)
+    : file_(filename) {
+#endif
+    for (int i = 0; i < IPC::MAX_CHUNKS; ++i) {
+        chunks_[i].store(nullptr, std::memory_order_relaxed);
+    }
+    if (!file_.is_valid()) {
+        return;
+    }
+
+    // Проверка и инициализация раскладки - под блокировкой заголовка файла,
+    // чтобы одновременно стартующие сервер и клиенты не затёрли друг друга
+    FileLock header_lock(file_.get(), 0, IPC::FILE_HEADER_SIZE);
+    if (!header_lock.is_locked() || !extend_file(file_.get(), IPC::CHUNK_SIZE)) {
+        return;
+    }
+
+    views_[0].reset(new MappedView(file_.get(), 0, IPC::CHUNK_SIZE));
+    if (!views_[0]->is_valid()) {
+        return;
+    }
+
+    // Файл со старой раскладкой (или новый, заполненный нулями) приводится
+    // к текущей версии: остаётся один пустой блок, остальные обнулятся при росте
+    char* data = views_[0]->data();
+    IPC::SocketFileHeader* file_header = reinterpret_cast<IPC::SocketFileHeader*>(data);
+    if (file_header->magic.load(std::memory_order_acquire) != IPC::SOCKET_FILE_MAGIC ||
+        file_header->version.load(std::memory_order_acquire) != IPC::SOCKET_FILE_VERSION) {
+        std::memset(data, 0, IPC::CHUNK_SIZE);
+        file_header->chunk_count.store(1);
+        // Слот статистики занят невозможным session_id - claim_slot его не выдаст
+        IPC::ChunkHeader* chunk_header = reinterpret_cast<IPC::ChunkHeader*>(data + IPC::FILE_HEADER_SIZE);
+        chunk_header->owners[IPC::STATS_SLOT].store(UINT32_MAX);
+        chunk_header->used_slots.store(1);
+        file_header->version.store(IPC::SOCKET_FILE_VERSION, std::memory_order_release);
+        file_header->magic.store(IPC::SOCKET_FILE_MAGIC, std::memory_order_release);
+    }
+
+    chunks_[0].store(data, std::memory_order_release);
+    stats_region.store(reinterpret_cast<IPC::StatsRegion*>(data + IPC::get_slot_file_offset(IPC::STATS_SLOT)),
+                       std::memory_order_release);
+}
+
+IPC::SocketFileHeader* SocketMapping::header() const {
+    return reinterpret_cast<IPC::SocketFileHeader*>(chunks_[0].load(std::memory_order_acquire));
+}
+
+uint32_t SocketMapping::chunk_count() const {
+    IPC::SocketFileHeader* file_header = header();
+    return file_header != nullptr ? file_header->chunk_count.load(std::memory_order_acquire) : 0;
+}
+
+char* SocketMapping::map_chunk(uint32_t chunk) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    char* data = chunks_[chunk].load(std::memory_order_acquire);
+    if (data != nullptr) {
+        return data;
+    }
+
+    std::unique_ptr<MappedView> view(new MappedView(file_.get(), IPC::get_chunk_file_offset(chunk), IPC::CHUNK_SIZE));
+    if (!view->is_valid()) {
+        return nullptr;
+    }
+    data = view->data();
+    views_[chunk] = std::move(view);
+    chunks_[chunk].store(data, std::memory_order_release);
+    return data;
+}
+
+char* SocketMapping::chunk(uint32_t chunk) {
+    if (chunk >= chunk_count()) {
+        return nullptr;
+    }
+    char* data = chunks_[chunk].load(std::memory_order_acquire);
+    return data != nullptr ? data : map_chunk(chunk);
+}
+
+IPC::ChunkHeader* SocketMapping::chunk_header(uint32_t chunk) {
+    char* data = this->chunk(chunk);
+    return data != nullptr ? reinterpret_cast<IPC::ChunkHeader*>(data + IPC::FILE_HEADER_SIZE) : nullptr;
+}
+
+char* SocketMapping::at(uint32_t offset) {
+    char* data = chunk(offset / IPC::CHUNK_SIZE);
+    return data != nullptr ? data + offset % IPC::CHUNK_SIZE : nullptr;
+}
+
+bool SocketMapping::grow(uint32_t known_count) {
+    IPC::SocketFileHeader* file_header = header();
+    if (file_header == nullptr) {
+        return false;
+    }
+
+    // OFD-блокировка не разделяет потоки одного процесса - их упорядочивает мьютекс
+    std::lock_guard<std::mutex> lock(mutex_);
+    FileLock header_lock(file_.get(), 0, IPC::FILE_HEADER_SIZE);
+    if (!header_lock.is_locked()) {
+        return false;
+    }
+
+    uint32_t count = file_header->chunk_count.load(std::memory_order_acquire);
+    if (count != known_count) {
+        return true;
+    }
+    if (count >= static_cast<uint32_t>(IPC::MAX_CHUNKS)) {
+        return false;
+    }
+
+    if (!extend_file(file_.get(), IPC::get_chunk_file_offset(count + 1))) {
+        return false;
+    }
+    std::unique_ptr<MappedView> view(new MappedView(file_.get(), IPC::get_chunk_file_offset(count), IPC::CHUNK_SIZE));
+    if (!view->is_valid()) {
+        return false;
+    }
+
+    // В файле могли остаться данные прежней раскладки
+    std::memset(view->data(), 0, IPC::CHUNK_SIZE);
+    chunks_[count].store(view->data(), std::memory_order_release);
+    views_[count] = std::move(view);
+    file_header->chunk_count.store(count + 1, std::memory_order_release);
+    return true;
+}
+
+SocketMapping& get_socket_mapping() {
+    static SocketMapping mapping(IPC::SOCKET_FILE);
+    return mapping;
+}
+
+IPC::SocketFileHeader* get_socket_header() {
+    return get_socket_mapping().header();
+}
+
+IPC::StatsRegion* get_stats_region() {
+    return stats_region.load(std::memory_order_acquire);
+}
+
+static IPC::RingControl* ring_control(char* half) {
+    return reinterpret_cast<IPC::RingControl*>(half);
+}
+
+bool write_to_region_mapped(uint32_t offset, const char* data, size_t size) {
+    if (!IPC::is_valid_region_offset(offset)) {
+        return false;
+    }
+    
+    if (size < sizeof(Protocol::MessageHeader) || size > IPC::MAX_MESSAGE_SIZE) {
+        return false;
+    }
+    
+    char* half = get_socket_mapping().at(offset);
+    if (half == nullptr) {
+        return false;
+    }
+    
+    char* ring = half + IPC::RING_CONTROL_SIZE;
+    IPC::RingControl* control = ring_control(half);
+    
+    // head меняет только этот процесс, tail - читатель на другой стороне
+    uint32_t head = control->head.load(std::memory_order_relaxed);
+    uint32_t tail = control->tail.load(std::memory_order_acquire);
+    
+    uint32_t write_pos;
+    bool wrap;
+    uint32_t new_head;
+    if (!Ring::plan_write(head, tail, static_cast<uint32_t>(size), write_pos, wrap, new_head)) {
+        return false;
+    }
+    
+    if (wrap) {
+        std::memcpy(ring + head, &IPC::RING_WRAP_MARKER, sizeof(IPC::RING_WRAP_MARKER));
+    }
+    std::memcpy(ring + write_pos, data, size);
+    control->head.store(new_head, std::memory_order_release);
+    
+    return true;
+}
+
+size_t read_from_region_mapped(uint32_t offset, uint32_t size, char* buffer, size_t capacity) {
+    if (!IPC::is_valid_region_offset(offset) || size != IPC::RING_CONTROL_SIZE + IPC::RING_CAPACITY ||
+        capacity < IPC::MAX_MESSAGE_SIZE) {
+        return 0;
+    }
+    
+    char* half = get_socket_mapping().at(offset);
+    if (half == nullptr) {
+        return 0;
+    }
+    
+    const char* ring = half + IPC::RING_CONTROL_SIZE;
+    IPC::RingControl* control = ring_control(half);
+    
+    uint32_t head = control->head.load(std::memory_order_acquire);
+    uint32_t tail = control->tail.load(std::memory_order_relaxed);
+    
+    uint32_t message_pos = 0;
+    uint32_t message_size = 0;
+    uint32_t new_tail;
+    Ring::ReadResult result = Ring::next_record(ring, head, tail, message_pos, message_size, new_tail);
+    
+    if (result == Ring::ReadResult::CORRUPT || message_size > capacity) {
+        // Содержимое не разбирается - отбрасываем всё, что успел записать писатель
+        control->tail.store(Ring::is_valid_position(head) ? head : 0, std::memory_order_release);
+        return 0;
+    }
+    
+    if (result == Ring::ReadResult::MESSAGE) {
+        std::memcpy(buffer, ring + message_pos, message_size);
+    }
+    
+    if (new_tail != tail) {
+        control->tail.store(new_tail, std::memory_order_release);
+    }
+    
+    return result == Ring::ReadResult::MESSAGE ? message_size : 0;
+}
+
+}
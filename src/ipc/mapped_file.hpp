@@ -0,0 +1,75 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include "ipc_common.hpp"
+#include "file_handle.hpp"
+
+namespace FileSocket {
+
+// Отображение диапазона файла в память процесса
+class MappedView {
+private:
+    char* data_;
+    size_t size_;
+
+public:
+    MappedView(NativeHandle file, uint32_t offset, size_t size);
+    ~MappedView();
+
+    bool is_valid() const { return data_ != nullptr; }
+    char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+    MappedView(const MappedView&) = delete;
+    MappedView& operator=(const MappedView&) = delete;
+};
+
+// Файл-сокет, отображённый поблочно. Блоки отображаются по мере надобности
+// и не переотображаются при росте файла, поэтому указатели на них стабильны.
+class SocketMapping {
+private:
+    FileHandle file_;
+    std::unique_ptr<MappedView> views_[IPC::MAX_CHUNKS];
+    std::atomic<char*> chunks_[IPC::MAX_CHUNKS];
+    std::mutex mutex_;
+
+    char* map_chunk(uint32_t chunk);
+
+public:
+    explicit SocketMapping(const std::string& filename);
+
+    bool is_valid() const { return chunks_[0].load(std::memory_order_acquire) != nullptr; }
+    IPC::SocketFileHeader* header() const;
+    uint32_t chunk_count() const;
+    // nullptr, если блока ещё нет в файле
+    char* chunk(uint32_t chunk);
+    IPC::ChunkHeader* chunk_header(uint32_t chunk);
+    // Указатель на байт файла со смещением offset внутри существующего блока
+    char* at(uint32_t offset);
+    // Добавляет блок, если их по-прежнему known_count; false - файл достиг IPC::MAX_CHUNKS
+    bool grow(uint32_t known_count);
+
+    SocketMapping(const SocketMapping&) = delete;
+    SocketMapping& operator=(const SocketMapping&) = delete;
+};
+
+// Общее на процесс отображение IPC::SOCKET_FILE (создаётся при первом обращении)
+SocketMapping& get_socket_mapping();
+// Заголовок файла в отображении; nullptr, если файл отобразить не удалось
+IPC::SocketFileHeader* get_socket_header();
+// Статистика сервера в слоте IPC::STATS_SLOT; nullptr, пока файл в этом
+// процессе не отображён (само отображение не создаёт)
+IPC::StatsRegion* get_stats_region();
+
+bool write_to_region_mapped(uint32_t offset, const char* data, size_t size);
+size_t read_from_region_mapped(uint32_t offset, uint32_t size, char* buffer, size_t capacity);
+
+}
+
+#endif
@@ -0,0 +1,172 @@
+#include "notify.hpp"
+#include "mapped_file.hpp"
+#include "slot_table.hpp"
+#include <chrono>
+#include <thread>
+#include <cstdlib>
+#include <cstdio>
+#include <climits>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#include <ctime>
+#endif
+
+namespace FileSocket {
+
+static WaitStrategy default_wait_strategy() {
+    WaitStrategy strategy = {2000, 64};
+    const char* env = std::getenv("HANGMAN_WAIT_STRATEGY");
+    if (env != nullptr) {
+        int spin = 0;
+        int yield = 0;
+        if (std::sscanf(env, "%d,%d", &spin, &yield) == 2 && spin >= 0 && yield >= 0) {
+            strategy.spin_iterations = spin;
+            strategy.yield_iterations = yield;
+        }
+    }
+    return strategy;
+}
+
+static WaitStrategy& current_wait_strategy() {
+    static WaitStrategy strategy = default_wait_strategy();
+    return strategy;
+}
+
+const WaitStrategy& get_wait_strategy() {
+    return current_wait_strategy();
+}
+
+void set_wait_strategy(const WaitStrategy& strategy) {
+    current_wait_strategy() = strategy;
+}
+
+Doorbell server_doorbell(uint32_t worker_id) {
+    IPC::SocketFileHeader* header = get_socket_header();
+    if (header == nullptr || worker_id >= static_cast<uint32_t>(IPC::MAX_SERVER_WORKERS)) {
+        return Doorbell(nullptr, nullptr);
+    }
+    return Doorbell(&header->server_doorbells[worker_id], &header->server_waiters[worker_id]);
+}
+
+Doorbell client_doorbell(uint32_t session_id) {
+    uint32_t slot = find_session_slot(session_id);
+    if (!IPC::is_valid_session_id(session_id) || slot == IPC::INVALID_SLOT) {
+        return Doorbell(nullptr, nullptr);
+    }
+    
+    IPC::ChunkHeader* chunk_header = get_socket_mapping().chunk_header(IPC::get_slot_chunk(slot));
+    if (chunk_header == nullptr) {
+        return Doorbell(nullptr, nullptr);
+    }
+    uint32_t index = IPC::get_slot_index_in_chunk(slot);
+    return Doorbell(&chunk_header->client_doorbells[index], &chunk_header->client_waiters[index]);
+}
+
+#ifdef _WIN32
+
+// WaitOnAddress не работает между процессами - спим короткими интервалами
+static void block_on_word(std::atomic<uint32_t>* word, uint32_t seen, int timeout_ms) {
+    (void)word;
+    (void)seen;
+    Sleep(timeout_ms < 1 ? 0 : 1);
+}
+
+static void block_on_file(int timeout_ms) {
+    Sleep(timeout_ms < 1 ? 0 : 1);
+}
+
+static void wake_word(std::atomic<uint32_t>* word) {
+    (void)word;
+}
+
+#else
+
+// Файл отображён с MAP_SHARED, поэтому futex обязан быть не-private
+static void block_on_word(std::atomic<uint32_t>* word, uint32_t seen, int timeout_ms) {
+    struct timespec timeout;
+    timeout.tv_sec = timeout_ms / 1000;
+    timeout.tv_nsec = static_cast<long>(timeout_ms % 1000) * 1000000L;
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT, seen, &timeout, nullptr, 0);
+}
+
+// Запасной путь, когда заголовок не удалось отобразить: ждём изменения файла через inotify
+static void block_on_file(int timeout_ms) {
+    int fd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    if (fd < 0 || inotify_add_watch(fd, IPC::SOCKET_FILE.c_str(), IN_MODIFY) < 0) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms < 10 ? timeout_ms : 10));
+        return;
+    }
+    
+    struct pollfd pfd = {fd, POLLIN, 0};
+    poll(&pfd, 1, timeout_ms);
+    close(fd);
+}
+
+static void wake_word(std::atomic<uint32_t>* word) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+#endif
+
+uint32_t Doorbell::value() const {
+    return word_ != nullptr ? word_->load(std::memory_order_seq_cst) : 0;
+}
+
+void Doorbell::ring() {
+    if (word_ == nullptr) {
+        return;
+    }
+    
+    word_->fetch_add(1, std::memory_order_seq_cst);
+    if (waiters_->load(std::memory_order_seq_cst) != 0) {
+        wake_word(word_);
+    }
+}
+
+bool Doorbell::wait(uint32_t seen, int timeout_ms) const {
+    if (timeout_ms <= 0) {
+        return value() != seen;
+    }
+    
+    if (word_ == nullptr) {
+        block_on_file(timeout_ms);
+        return true;
+    }
+    
+    const WaitStrategy& strategy = get_wait_strategy();
+    
+    for (int i = 0; i < strategy.spin_iterations; ++i) {
+        if (word_->load(std::memory_order_acquire) != seen) {
+            return true;
+        }
+    }
+    
+    for (int i = 0; i < strategy.yield_iterations; ++i) {
+        std::this_thread::yield();
+        if (word_->load(std::memory_order_acquire) != seen) {
+            return true;
+        }
+    }
+    
+    // Регистрируемся как ожидающий до повторной проверки - иначе писатель
+    // может не заметить нас и не разбудить
+    waiters_->fetch_add(1, std::memory_order_seq_cst);
+    if (word_->load(std::memory_order_seq_cst) == seen) {
+        block_on_word(word_, seen, timeout_ms);
+    }
+    waiters_->fetch_sub(1, std::memory_order_seq_cst);
+    
+    return word_->load(std::memory_order_acquire) != seen;
+}
+
+} 
@@ -0,0 +1,45 @@
+#ifndef NOTIFY_HPP
+#define NOTIFY_HPP
+
+#include <cstdint>
+#include <atomic>
+#include "ipc_common.hpp"
+
+namespace FileSocket {
+
+// Стратегия ожидания: сначала крутимся, затем уступаем процессор,
+// затем засыпаем до звонка писателя (futex на Linux).
+struct WaitStrategy {
+    int spin_iterations;
+    int yield_iterations;
+};
+
+// По умолчанию читается из HANGMAN_WAIT_STRATEGY в виде "<spin>,<yield>"
+const WaitStrategy& get_wait_strategy();
+void set_wait_strategy(const WaitStrategy& strategy);
+
+// Звонок - счётчик в заголовке файла-сокета. Читатель запоминает значение,
+// проверяет регион и, если он пуст, ждёт, пока значение не изменится.
+class Doorbell {
+private:
+    std::atomic<uint32_t>* word_;
+    std::atomic<uint32_t>* waiters_;
+    
+public:
+    Doorbell(std::atomic<uint32_t>* word, std::atomic<uint32_t>* waiters)
+        : word_(word), waiters_(waiters) {}
+    
+    bool is_valid() const { return word_ != nullptr; }
+    uint32_t value() const;
+    void ring();
+    // Возвращает true, если звонок изменился до истечения таймаута
+    bool wait(uint32_t seen, int timeout_ms) const;
+};
+
+// У каждого потока-обработчика сервера свой звонок
+Doorbell server_doorbell(uint32_t worker_id = 0);
+Doorbell client_doorbell(uint32_t session_id);
+
+} 
+
+#endif
@@ -1,10 +1,19 @@
 #include "region_ops.hpp"
+#include "ring_buffer.hpp"
 #include "../protocol/protocol.hpp"
 #include <iostream>
 #include <cstring>
+#include <cstddef>
+#include <memory>
+#ifndef _WIN32
+#include <unistd.h>
+#include <cerrno>
+#endif
 
 namespace FileSocket {
 
+#ifdef _WIN32
+
 std::string get_last_windows_error() {
     DWORD error = GetLastError();
     if (error == 0) return "No error";
@@ -20,85 +29,143 @@ std::string get_last_windows_error() {
     return "Error " + std::to_string(error) + ": " + message;
 }
 
-bool write_to_region_impl(const std::string& filename, uint32_t offset, const std::vector<char>& data) {
+// Windows: файл открывается на время операции
+static FileHandle* acquire_handle(const std::string& filename, std::unique_ptr<FileHandle>& temporary) {
+    temporary.reset(new FileHandle(filename, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE));
+    return temporary.get();
+}
+
+static bool read_at(NativeHandle handle, uint32_t offset, void* buffer, uint32_t size) {
+    SetFilePointer(handle, offset, NULL, FILE_BEGIN);
+    DWORD bytes_read;
+    BOOL result = ReadFile(handle, buffer, size, &bytes_read, NULL);
+    return result && bytes_read == size;
+}
+
+static bool write_at(NativeHandle handle, uint32_t offset, const void* buffer, uint32_t size) {
+    SetFilePointer(handle, offset, NULL, FILE_BEGIN);
+    DWORD bytes_written;
+    BOOL result = WriteFile(handle, buffer, size, &bytes_written, NULL);
+    return result && bytes_written == size;
+}
+
+#else
+
+std::string get_last_system_error() {
+    int error = errno;
+    if (error == 0) return "No error";
+    return "Error " + std::to_string(error) + ": " + std::strerror(error);
+}
+
+// POSIX: дескриптор файла-сокета живёт весь процесс; прочие файлы открываются на время операции
+static FileHandle* acquire_handle(const std::string& filename, std::unique_ptr<FileHandle>& temporary) {
+    if (filename == IPC::SOCKET_FILE) {
+        return &get_socket_handle();
+    }
+    temporary.reset(new FileHandle(filename));
+    return temporary.get();
+}
+
+static bool read_at(NativeHandle handle, uint32_t offset, void* buffer, uint32_t size) {
+    return pread(handle, buffer, size, offset) == static_cast<ssize_t>(size);
+}
+
+static bool write_at(NativeHandle handle, uint32_t offset, const void* buffer, uint32_t size) {
+    return pwrite(handle, buffer, size, offset) == static_cast<ssize_t>(size);
+}
+
+#endif
+
+// Кольцо без блокировок: производитель пишет запись, затем head; потребитель
+// читает половину региона одним вызовом (управляющий блок лежит раньше данных)
+// и сдвигает tail. Записи выполняются по порядку, поэтому читатель, увидевший
+// новый head, видит и данные.
+
+bool write_to_region_impl(const std::string& filename, uint32_t offset, const char* data, size_t size) {
     if (!IPC::is_valid_region_offset(offset)) {
         return false;
     }
     
-    if (data.empty() || data.size() > IPC::CLIENT_TO_SERVER_SIZE) {
+    if (size < sizeof(Protocol::MessageHeader) || size > IPC::MAX_MESSAGE_SIZE) {
         return false;
     }
     
-    FileHandle file_handle(filename, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE);
+    std::unique_ptr<FileHandle> temporary;
+    FileHandle& file_handle = *acquire_handle(filename, temporary);
     if (!file_handle.is_valid()) {
         return false;
     }
     
-    FileLock region_lock(file_handle.get(), offset, static_cast<DWORD>(data.size()));
-    if (!region_lock.is_locked()) {
+    uint32_t control[2];
+    if (!read_at(file_handle.get(), offset, control, sizeof(control))) {
         return false;
     }
     
-    SetFilePointer(file_handle.get(), offset, NULL, FILE_BEGIN);
+    uint32_t head = control[0];
+    uint32_t tail = control[1];
+    uint32_t write_pos;
+    bool wrap;
+    uint32_t new_head;
+    if (!Ring::plan_write(head, tail, static_cast<uint32_t>(size), write_pos, wrap, new_head)) {
+        return false;
+    }
     
-    DWORD bytes_written;
-    BOOL result = WriteFile(file_handle.get(), data.data(), 
-                          static_cast<DWORD>(data.size()), &bytes_written, NULL);
+    uint32_t data_offset = offset + IPC::RING_CONTROL_SIZE;
+    if (wrap && !write_at(file_handle.get(), data_offset + head, &IPC::RING_WRAP_MARKER, sizeof(IPC::RING_WRAP_MARKER))) {
+        return false;
+    }
+    
+    if (!write_at(file_handle.get(), data_offset + write_pos, data, static_cast<uint32_t>(size))) {
+        return false;
+    }
     
-    return result && (bytes_written == data.size());
+    return write_at(file_handle.get(), offset + offsetof(IPC::RingControl, head), &new_head, sizeof(new_head));
 }
 
-std::vector<char> read_from_region_impl(const std::string& filename, uint32_t offset, uint32_t size) {
-    if (!IPC::is_valid_region_offset(offset) || size == 0 || size > IPC::SESSION_REGION_SIZE) {
-        return {};
+size_t read_from_region_impl(const std::string& filename, uint32_t offset, uint32_t size, char* buffer, size_t capacity) {
+    if (!IPC::is_valid_region_offset(offset) || size != IPC::RING_CONTROL_SIZE + IPC::RING_CAPACITY ||
+        capacity < IPC::MAX_MESSAGE_SIZE) {
+        return 0;
     }
     
-    FileHandle file_handle(filename, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE);
+    std::unique_ptr<FileHandle> temporary;
+    FileHandle& file_handle = *acquire_handle(filename, temporary);
     if (!file_handle.is_valid()) {
-        return {};
+        return 0;
     }
     
-    FileLock region_lock(file_handle.get(), offset, size);
-    if (!region_lock.is_locked()) {
-        return {};
+    char half[IPC::RING_CONTROL_SIZE + IPC::RING_CAPACITY];
+    if (!read_at(file_handle.get(), offset, half, size)) {
+        return 0;
     }
     
-    SetFilePointer(file_handle.get(), offset, NULL, FILE_BEGIN);
-    
-    // Читаем заголовок для проверки валидности
-    Protocol::MessageHeader header;
-    DWORD bytes_read;
-    BOOL result = ReadFile(file_handle.get(), &header, sizeof(Protocol::MessageHeader), &bytes_read, NULL);
-    
-    if (!result || bytes_read != sizeof(Protocol::MessageHeader)) {
-        return {};
+    uint32_t head;
+    uint32_t tail;
+    std::memcpy(&head, half + offsetof(IPC::RingControl, head), sizeof(head));
+    std::memcpy(&tail, half + offsetof(IPC::RingControl, tail), sizeof(tail));
+    
+    const char* ring = half + IPC::RING_CONTROL_SIZE;
+    uint32_t message_pos = 0;
+    uint32_t message_size = 0;
+    uint32_t new_tail;
+    Ring::ReadResult result = Ring::next_record(ring, head, tail, message_pos, message_size, new_tail);
+    
+    if (result == Ring::ReadResult::CORRUPT || message_size > capacity) {
+        // Содержимое не разбирается - отбрасываем всё, что успел записать писатель
+        new_tail = Ring::is_valid_position(head) ? head : 0;
+        write_at(file_handle.get(), offset + offsetof(IPC::RingControl, tail), &new_tail, sizeof(new_tail));
+        return 0;
     }
     
-    if (header.session_id == 0 || header.payload_size > IPC::MAX_PAYLOAD_SIZE) {
-        return {};
+    if (result == Ring::ReadResult::MESSAGE) {
+        std::memcpy(buffer, ring + message_pos, message_size);
     }
     
-    uint32_t total_message_size = sizeof(Protocol::MessageHeader) + header.payload_size;
-    if (total_message_size > size) {
-        return {};
+    if (new_tail != tail) {
+        write_at(file_handle.get(), offset + offsetof(IPC::RingControl, tail), &new_tail, sizeof(new_tail));
     }
     
-    // Читаем всё сообщение
-    SetFilePointer(file_handle.get(), offset, NULL, FILE_BEGIN);
-    std::vector<char> buffer(total_message_size);
-    
-    result = ReadFile(file_handle.get(), buffer.data(), total_message_size, &bytes_read, NULL);
-    if (!result || bytes_read != total_message_size) {
-        return {};
-    }
-    
-    // Очищаем регион после чтения
-    SetFilePointer(file_handle.get(), offset, NULL, FILE_BEGIN);
-    std::vector<char> empty_data(size, 0);
-    DWORD bytes_written;
-    WriteFile(file_handle.get(), empty_data.data(), size, &bytes_written, NULL);
-    
-    return buffer;
+    return result == Ring::ReadResult::MESSAGE ? message_size : 0;
 }
 
-} 
+}
@@ -1,8 +1,8 @@
 #ifndef REGION_OPS_HPP
 #define REGION_OPS_HPP
 
-#include <vector>
 #include <cstdint>
+#include <cstddef>
 #include <string>
 #include "file_handle.hpp"
 #include "file_lock.hpp"
@@ -10,9 +10,14 @@
 
 namespace FileSocket {
 
+#ifdef _WIN32
 std::string get_last_windows_error();
-bool write_to_region_impl(const std::string& filename, uint32_t offset, const std::vector<char>& data);
-std::vector<char> read_from_region_impl(const std::string& filename, uint32_t offset, uint32_t size);
+#else
+std::string get_last_system_error();
+#endif
+bool write_to_region_impl(const std::string& filename, uint32_t offset, const char* data, size_t size);
+// Сообщение копируется в buffer; 0, если кольцо пусто (capacity - не меньше IPC::MAX_MESSAGE_SIZE)
+size_t read_from_region_impl(const std::string& filename, uint32_t offset, uint32_t size, char* buffer, size_t capacity);
 
 } 
 
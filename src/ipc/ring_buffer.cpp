@@ -0,0 +1,91 @@
+#include "ring_buffer.hpp"
+#include "../protocol/protocol.hpp"
+#include <cstring>
+
+namespace FileSocket {
+namespace Ring {
+
+static const uint32_t CAPACITY = IPC::RING_CAPACITY;
+
+// Между head и tail всегда остаётся зазор в одно слово, чтобы полный буфер
+// отличался от пустого
+static uint32_t free_space(uint32_t head, uint32_t tail) {
+    uint32_t used = (head + CAPACITY - tail) % CAPACITY;
+    return CAPACITY - used - 4;
+}
+
+bool plan_write(uint32_t head, uint32_t tail, uint32_t message_size,
+                uint32_t& write_pos, bool& wrap, uint32_t& new_head) {
+    if (!is_valid_position(head) || !is_valid_position(tail)) {
+        return false;
+    }
+    
+    uint32_t record = record_size(message_size);
+    uint32_t space = free_space(head, tail);
+    
+    if (head + record <= CAPACITY) {
+        if (record > space) {
+            return false;
+        }
+        write_pos = head;
+        wrap = false;
+        new_head = (head + record) % CAPACITY;
+        return true;
+    }
+    
+    // Запись не помещается до конца буфера - хвост пропускается целиком
+    if ((CAPACITY - head) + record > space) {
+        return false;
+    }
+    write_pos = 0;
+    wrap = true;
+    new_head = record;
+    return true;
+}
+
+ReadResult next_record(const char* data, uint32_t head, uint32_t tail,
+                       uint32_t& message_pos, uint32_t& message_size, uint32_t& new_tail) {
+    new_tail = tail;
+    if (!is_valid_position(head) || !is_valid_position(tail)) {
+        return ReadResult::CORRUPT;
+    }
+    
+    if (tail == head) {
+        return ReadResult::EMPTY;
+    }
+    
+    uint32_t marker;
+    std::memcpy(&marker, data + tail, sizeof(marker));
+    if (marker == IPC::RING_WRAP_MARKER) {
+        tail = 0;
+        new_tail = 0;
+        if (tail == head) {
+            return ReadResult::EMPTY;
+        }
+    }
+    
+    uint32_t used = (head + CAPACITY - tail) % CAPACITY;
+    if (tail + sizeof(Protocol::MessageHeader) > CAPACITY || used < sizeof(Protocol::MessageHeader)) {
+        return ReadResult::CORRUPT;
+    }
+    
+    Protocol::MessageHeader header;
+    std::memcpy(&header, data + tail, sizeof(header));
+    if (header.session_id == 0 || header.payload_size > IPC::MAX_PAYLOAD_SIZE) {
+        return ReadResult::CORRUPT;
+    }
+    
+    uint32_t size = sizeof(Protocol::MessageHeader) + header.payload_size;
+    uint32_t record = record_size(size);
+    if (tail + record > CAPACITY || record > used) {
+        return ReadResult::CORRUPT;
+    }
+    
+    message_pos = tail;
+    message_size = size;
+    new_tail = (tail + record) % CAPACITY;
+    return ReadResult::MESSAGE;
+}
+
+}
+}
@@ -0,0 +1,42 @@
+#ifndef RING_BUFFER_HPP
+#define RING_BUFFER_HPP
+
+#include <cstdint>
+#include "ipc_common.hpp"
+
+namespace FileSocket {
+
+// Разметка кольцевого буфера половины региона (см. IPC::RingControl).
+// Функции не делают ввода-вывода и работают одинаково поверх отображения
+// файла и поверх прочитанной копии половины региона.
+namespace Ring {
+
+enum class ReadResult {
+    EMPTY,
+    MESSAGE,
+    CORRUPT
+};
+
+inline uint32_t record_size(uint32_t message_size) {
+    return (message_size + 3u) & ~3u;
+}
+
+inline bool is_valid_position(uint32_t position) {
+    return position < static_cast<uint32_t>(IPC::RING_CAPACITY) && position % 4 == 0;
+}
+
+// Куда положить сообщение размера message_size. При wrap == true в позицию head
+// пишется IPC::RING_WRAP_MARKER, а сама запись начинается с начала буфера.
+bool plan_write(uint32_t head, uint32_t tail, uint32_t message_size,
+                uint32_t& write_pos, bool& wrap, uint32_t& new_head);
+
+// Разбор записи в позиции tail. new_tail заполняется всегда: маркер переноса
+// сдвигает tail даже когда сообщений больше нет.
+ReadResult next_record(const char* data, uint32_t head, uint32_t tail,
+                       uint32_t& message_pos, uint32_t& message_size, uint32_t& new_tail);
+
+}
+
+}
+
+#endif
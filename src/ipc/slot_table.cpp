@@ -0,0 +1,115 @@
+#include "slot_table.hpp"
+#include "mapped_file.hpp"
+#include <unordered_map>
+
+namespace FileSocket {
+
+static thread_local std::unordered_map<uint32_t, uint32_t> session_slots;
+
+// Новый владелец начинает с пустых колец. Каждое поле меняет его собственная
+// сторона: клиент - head своей очереди к серверу и tail очереди от сервера.
+static void reset_client_rings(char* region) {
+    IPC::RingControl* to_server = reinterpret_cast<IPC::RingControl*>(region);
+    IPC::RingControl* to_client = reinterpret_cast<IPC::RingControl*>(region + IPC::CLIENT_TO_SERVER_SIZE);
+    to_server->head.store(to_server->tail.load(std::memory_order_acquire), std::memory_order_release);
+    to_client->tail.store(to_client->head.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+static uint32_t claim_in_chunk(SocketMapping& mapping, uint32_t chunk, uint32_t session_id) {
+    IPC::ChunkHeader* chunk_header = mapping.chunk_header(chunk);
+    if (chunk_header == nullptr ||
+        chunk_header->used_slots.load(std::memory_order_relaxed) >= static_cast<uint32_t>(IPC::SESSIONS_PER_CHUNK)) {
+        return IPC::INVALID_SLOT;
+    }
+    
+    for (uint32_t index = 1; index < static_cast<uint32_t>(IPC::CHUNK_SLOTS); ++index) {
+        uint32_t expected = 0;
+        if (chunk_header->owners[index].load(std::memory_order_relaxed) != 0 ||
+            !chunk_header->owners[index].compare_exchange_strong(expected, session_id, std::memory_order_acq_rel)) {
+            continue;
+        }
+        
+        chunk_header->used_slots.fetch_add(1, std::memory_order_relaxed);
+        uint32_t slot = chunk * IPC::CHUNK_SLOTS + index;
+        reset_client_rings(mapping.at(IPC::get_slot_file_offset(slot)));
+        return slot;
+    }
+    
+    return IPC::INVALID_SLOT;
+}
+
+uint32_t claim_slot(uint32_t session_id) {
+    if (!IPC::is_valid_session_id(session_id)) {
+        return IPC::INVALID_SLOT;
+    }
+    
+    SocketMapping& mapping = get_socket_mapping();
+    if (!mapping.is_valid()) {
+        return IPC::INVALID_SLOT;
+    }
+    
+    while (true) {
+        // Начальный блок зависит от session_id, чтобы сессии распределялись
+        // между потоками сервера, а не заполняли сначала нулевой блок
+        uint32_t count = mapping.chunk_count();
+        for (uint32_t i = 0; i < count; ++i) {
+            uint32_t chunk = (session_id + i) % count;
+            uint32_t slot = claim_in_chunk(mapping, chunk, session_id);
+            if (slot != IPC::INVALID_SLOT) {
+                return slot;
+            }
+        }
+        
+        // Свободных слотов нет - добавляем блок (или подхватываем добавленный другим процессом)
+        if (!mapping.grow(count)) {
+            return IPC::INVALID_SLOT;
+        }
+    }
+}
+
+bool release_slot(uint32_t slot, uint32_t session_id) {
+    if (!IPC::is_valid_slot(slot)) {
+        return false;
+    }
+    
+    IPC::ChunkHeader* chunk_header = get_socket_mapping().chunk_header(IPC::get_slot_chunk(slot));
+    if (chunk_header == nullptr) {
+        return false;
+    }
+    
+    uint32_t expected = session_id;
+    if (!chunk_header->owners[IPC::get_slot_index_in_chunk(slot)].compare_exchange_strong(
+            expected, 0, std::memory_order_acq_rel)) {
+        return false;
+    }
+    
+    chunk_header->used_slots.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+uint32_t get_slot_owner(uint32_t slot) {
+    if (!IPC::is_valid_slot(slot)) {
+        return 0;
+    }
+    
+    IPC::ChunkHeader* chunk_header = get_socket_mapping().chunk_header(IPC::get_slot_chunk(slot));
+    if (chunk_header == nullptr) {
+        return 0;
+    }
+    return chunk_header->owners[IPC::get_slot_index_in_chunk(slot)].load(std::memory_order_acquire);
+}
+
+void bind_session_slot(uint32_t session_id, uint32_t slot) {
+    session_slots[session_id] = slot;
+}
+
+uint32_t find_session_slot(uint32_t session_id) {
+    auto it = session_slots.find(session_id);
+    return it != session_slots.end() ? it->second : IPC::INVALID_SLOT;
+}
+
+void unbind_session_slot(uint32_t session_id) {
+    session_slots.erase(session_id);
+}
+
+}
@@ -0,0 +1,26 @@
+#ifndef SLOT_TABLE_HPP
+#define SLOT_TABLE_HPP
+
+#include <cstdint>
+#include "ipc_common.hpp"
+
+namespace FileSocket {
+
+// Таблица слотов в заголовках блоков файла-сокета. Клиент занимает свободный
+// слот при подключении, слот освобождается по окончании сессии.
+
+// IPC::INVALID_SLOT, если все IPC::MAX_CHUNKS блоков заняты
+uint32_t claim_slot(uint32_t session_id);
+bool release_slot(uint32_t slot, uint32_t session_id);
+uint32_t get_slot_owner(uint32_t slot);
+
+// Какой слот занимает сессия - известно процессу-клиенту после claim_slot
+// и серверу после первого сообщения из слота. Таблица своя у каждого потока:
+// поток сервера отвечает только тем сессиям, сообщения которых сам прочитал.
+void bind_session_slot(uint32_t session_id, uint32_t slot);
+uint32_t find_session_slot(uint32_t session_id);
+void unbind_session_slot(uint32_t session_id);
+
+}
+
+#endif
@@ -0,0 +1,245 @@
+#include "uring_queue.hpp"
+#include <cstring>
+#ifdef HANGMAN_HAVE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace FileSocket {
+
+#ifdef HANGMAN_HAVE_IO_URING
+
+static int uring_setup(uint32_t entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int uring_enter(int ring_fd, uint32_t to_submit, uint32_t min_complete, uint32_t flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+static int uring_register(int ring_fd, uint32_t opcode, const void* arg, uint32_t count) {
+    return static_cast<int>(syscall(__NR_io_uring_register, ring_fd, opcode, arg, count));
+}
+
+static void* map_ring(int ring_fd, size_t size, uint64_t offset) {
+    void* ring = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                      static_cast<off_t>(offset));
+    return ring == MAP_FAILED ? nullptr : ring;
+}
+
+UringQueue::UringQueue(int file, uint32_t entries)
+    : ring_fd_(-1), file_(file), fixed_file_(false), fixed_buffer_(nullptr), fixed_size_(0),
+      sq_ring_(nullptr), sq_ring_size_(0), cq_ring_(nullptr), cq_ring_size_(0), sqes_(nullptr), sqes_size_(0),
+      sq_tail_(nullptr), sq_array_(nullptr), sq_mask_(0), sq_entries_(0), cq_head_(nullptr), cq_tail_(nullptr),
+      cq_mask_(0), cqes_(nullptr), local_tail_(0), prepared_(0), last_sqe_(nullptr) {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    int ring_fd = uring_setup(entries, &params);
+    if (ring_fd < 0) {
+        return;
+    }
+
+    // С IORING_FEAT_SINGLE_MMAP кольца отправки и завершения - одно отображение
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+        sq_ring_size_ = cq_ring_size_ = sq_ring_size_ > cq_ring_size_ ? sq_ring_size_ : cq_ring_size_;
+    }
+    sq_ring_ = map_ring(ring_fd, sq_ring_size_, IORING_OFF_SQ_RING);
+    cq_ring_ = single_mmap ? sq_ring_ : map_ring(ring_fd, cq_ring_size_, IORING_OFF_CQ_RING);
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = map_ring(ring_fd, sqes_size_, IORING_OFF_SQES);
+    if (sq_ring_ == nullptr || cq_ring_ == nullptr || sqes_ == nullptr) {
+        unmap();
+        close(ring_fd);
+        return;
+    }
+
+    char* sq = static_cast<char*>(sq_ring_);
+    char* cq = static_cast<char*>(cq_ring_);
+    sq_tail_ = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+    sq_array_ = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+    sq_mask_ = *reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+    sq_entries_ = params.sq_entries;
+    cq_head_ = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+    cqes_ = cq + params.cq_off.cqes;
+    local_tail_ = *sq_tail_;
+
+    // Запрос i всегда лежит в sqes[i]: массив индексов заполняется один раз
+    for (uint32_t i = 0; i < sq_entries_; ++i) {
+        sq_array_[i] = i;
+    }
+    ring_fd_ = ring_fd;
+}
+
+UringQueue::~UringQueue() {
+    unmap();
+    if (ring_fd_ >= 0) {
+        close(ring_fd_);
+    }
+}
+
+void UringQueue::unmap() {
+    if (sqes_ != nullptr) {
+        munmap(sqes_, sqes_size_);
+    }
+    if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+        munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_ != nullptr) {
+        munmap(sq_ring_, sq_ring_size_);
+    }
+    sq_ring_ = cq_ring_ = sqes_ = nullptr;
+}
+
+bool UringQueue::is_supported() {
+    static const bool supported = [] {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        int ring_fd = uring_setup(1, &params);
+        if (ring_fd < 0) {
+            return false;
+        }
+        close(ring_fd);
+        // IORING_OP_READ/WRITE - с ядра 5.6, вместе с этим флагом
+        return (params.features & IORING_FEAT_RW_CUR_POS) != 0;
+    }();
+    return supported;
+}
+
+bool UringQueue::register_file() {
+    if (!is_valid() || uring_register(ring_fd_, IORING_REGISTER_FILES, &file_, 1) != 0) {
+        return false;
+    }
+    fixed_file_ = true;
+    return true;
+}
+
+bool UringQueue::register_buffer(const char* buffer, size_t size) {
+    iovec buffer_vector;
+    buffer_vector.iov_base = const_cast<char*>(buffer);
+    buffer_vector.iov_len = size;
+    if (!is_valid() || uring_register(ring_fd_, IORING_REGISTER_BUFFERS, &buffer_vector, 1) != 0) {
+        return false;
+    }
+    fixed_buffer_ = buffer;
+    fixed_size_ = size;
+    return true;
+}
+
+bool UringQueue::queue(bool write, uint32_t offset, const char* buffer, uint32_t size, uint8_t flags,
+                       uint64_t user_data) {
+    if (!is_valid() || prepared_ == sq_entries_) {
+        return false;
+    }
+
+    io_uring_sqe* sqe = static_cast<io_uring_sqe*>(sqes_) + (local_tail_ & sq_mask_);
+    std::memset(sqe, 0, sizeof(*sqe));
+    bool fixed = fixed_buffer_ != nullptr && buffer >= fixed_buffer_ && buffer + size <= fixed_buffer_ + fixed_size_;
+    if (fixed) {
+        sqe->opcode = write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+        sqe->buf_index = 0;
+    } else {
+        sqe->opcode = write ? IORING_OP_WRITE : IORING_OP_READ;
+    }
+    sqe->fd = fixed_file_ ? 0 : file_;
+    sqe->flags = fixed_file_ ? IOSQE_FIXED_FILE : 0;
+    if ((flags & LINK) != 0) {
+        sqe->flags |= IOSQE_IO_LINK;
+    }
+    sqe->off = offset;
+    sqe->addr = reinterpret_cast<uint64_t>(buffer);
+    sqe->len = size;
+    sqe->user_data = user_data;
+
+    last_sqe_ = sqe;
+    ++local_tail_;
+    ++prepared_;
+    return true;
+}
+
+bool UringQueue::submit_and_wait(std::vector<Completion>& completions) {
+    completions.clear();
+    if (prepared_ == 0) {
+        return true;
+    }
+    if (!is_valid()) {
+        return false;
+    }
+
+    // Цепочка заканчивается на последнем запросе пачки
+    static_cast<io_uring_sqe*>(last_sqe_)->flags &= static_cast<uint8_t>(~IOSQE_IO_LINK);
+    __atomic_store_n(sq_tail_, local_tail_, __ATOMIC_RELEASE);
+
+    uint32_t to_submit = prepared_;
+    uint32_t expected = prepared_;
+    prepared_ = 0;
+    const io_uring_cqe* cqes = static_cast<const io_uring_cqe*>(cqes_);
+    while (completions.size() < expected) {
+        int result = uring_enter(ring_fd_, to_submit, static_cast<uint32_t>(expected - completions.size()),
+                                 IORING_ENTER_GETEVENTS);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // Запросы остались в кольце, и следующие пачки перепутаются с ними
+            close(ring_fd_);
+            ring_fd_ = -1;
+            return false;
+        }
+        to_submit -= static_cast<uint32_t>(result);
+
+        uint32_t head = *cq_head_;
+        uint32_t tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head) {
+            const io_uring_cqe& cqe = cqes[head & cq_mask_];
+            completions.push_back(Completion{cqe.user_data, cqe.res});
+        }
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    }
+    return true;
+}
+
+#else
+
+UringQueue::UringQueue(int file, uint32_t)
+    : ring_fd_(-1), file_(file), fixed_file_(false), fixed_buffer_(nullptr), fixed_size_(0),
+      sq_ring_(nullptr), sq_ring_size_(0), cq_ring_(nullptr), cq_ring_size_(0), sqes_(nullptr), sqes_size_(0),
+      sq_tail_(nullptr), sq_array_(nullptr), sq_mask_(0), sq_entries_(0), cq_head_(nullptr), cq_tail_(nullptr),
+      cq_mask_(0), cqes_(nullptr), local_tail_(0), prepared_(0), last_sqe_(nullptr) {}
+
+UringQueue::~UringQueue() {}
+
+void UringQueue::unmap() {}
+
+bool UringQueue::is_supported() {
+    return false;
+}
+
+bool UringQueue::register_file() {
+    return false;
+}
+
+bool UringQueue::register_buffer(const char*, size_t) {
+    return false;
+}
+
+bool UringQueue::queue(bool, uint32_t, const char*, uint32_t, uint8_t, uint64_t) {
+    return false;
+}
+
+bool UringQueue::submit_and_wait(std::vector<Completion>& completions) {
+    completions.clear();
+    return prepared_ == 0;
+}
+
+#endif
+
+}
@@ -0,0 +1,93 @@
+#ifndef URING_QUEUE_HPP
+#define URING_QUEUE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define HANGMAN_HAVE_IO_URING 1
+#endif
+#endif
+
+namespace FileSocket {
+
+// Очередь io_uring прямо на системных вызовах (без liburing): чтение и запись
+// по смещению в один файл, отправка пачкой одним io_uring_enter и ожидание
+// завершения всех запросов пачки. Где io_uring нет (Windows, старое ядро,
+// запрет seccomp), is_valid() == false.
+class UringQueue {
+public:
+    struct Completion {
+        uint64_t user_data;
+        int32_t result;     // байт или -errno
+    };
+
+    // Следующий запрос начнётся только после этого (цепочка не переходит через отправку)
+    static constexpr uint8_t LINK = 1;
+
+private:
+    int ring_fd_;
+    int file_;
+    bool fixed_file_;
+    const char* fixed_buffer_;
+    size_t fixed_size_;
+
+    void* sq_ring_;
+    size_t sq_ring_size_;
+    void* cq_ring_;
+    size_t cq_ring_size_;
+    void* sqes_;
+    size_t sqes_size_;
+    uint32_t* sq_tail_;
+    uint32_t* sq_array_;
+    uint32_t sq_mask_;
+    uint32_t sq_entries_;
+    uint32_t* cq_head_;
+    uint32_t* cq_tail_;
+    uint32_t cq_mask_;
+    void* cqes_;
+
+    uint32_t local_tail_;
+    uint32_t prepared_;
+    void* last_sqe_;
+
+    void unmap();
+    bool queue(bool write, uint32_t offset, const char* buffer, uint32_t size, uint8_t flags, uint64_t user_data);
+
+public:
+    UringQueue(int file, uint32_t entries);
+    ~UringQueue();
+
+    // Пробует создать очередь один раз на процесс
+    static bool is_supported();
+
+    bool is_valid() const { return ring_fd_ >= 0; }
+    uint32_t capacity() const { return sq_entries_; }
+    uint32_t prepared() const { return prepared_; }
+
+    // Зарегистрированные файл и буфер избавляют ядро от поиска дескриптора и
+    // закрепления страниц на каждом запросе; false - работаем без регистрации
+    bool register_file();
+    bool register_buffer(const char* buffer, size_t size);
+
+    // false - очередь полна (нужно сначала submit_and_wait)
+    bool queue_read(uint32_t offset, char* buffer, uint32_t size, uint8_t flags, uint64_t user_data) {
+        return queue(false, offset, buffer, size, flags, user_data);
+    }
+    bool queue_write(uint32_t offset, const char* data, uint32_t size, uint8_t flags, uint64_t user_data) {
+        return queue(true, offset, data, size, flags, user_data);
+    }
+
+    // Отправляет поставленные запросы и ждёт все их завершения; результаты - в
+    // completions (порядок завершения). false - сама очередь сломалась.
+    bool submit_and_wait(std::vector<Completion>& completions);
+
+    UringQueue(const UringQueue&) = delete;
+    UringQueue& operator=(const UringQueue&) = delete;
+};
+
+}
+
+#endif
@@ -0,0 +1,265 @@
+#include "logger.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Log {
+
+static_assert(sizeof(Record) == 256, "log record should stay at four cache lines");
+
+// 1MB на поток: при выводе раз в FLUSH_INTERVAL_MS кольцо вмещает до ~400 тысяч
+// записей в секунду - с запасом и для уровня debug (несколько записей на сообщение)
+const uint32_t RING_RECORDS = 4096;
+const int FLUSH_INTERVAL_MS = 10;
+
+// Кольцо одного потока: head двигает поток-писатель, tail - фоновый поток
+struct ThreadRing {
+    alignas(64) std::atomic<uint32_t> head;
+    std::atomic<uint64_t> dropped;
+    alignas(64) std::atomic<uint32_t> tail;
+    uint64_t reported_dropped;
+    Record records[RING_RECORDS];
+
+    ThreadRing() : head(0), dropped(0), tail(0), reported_dropped(0) {}
+};
+
+static std::atomic<uint8_t> current_level(static_cast<uint8_t>(Level::INFO));
+
+class Logger {
+private:
+    std::mutex rings_mutex_;
+    std::vector<std::shared_ptr<ThreadRing>> rings_;
+    // Вывод из фонового потока и из flush() не перемешивается
+    std::mutex output_mutex_;
+    std::string buffer_;
+    std::mutex wakeup_mutex_;
+    std::condition_variable wakeup_;
+    bool stopping_;
+    std::thread flusher_;
+
+    void run() {
+        std::unique_lock<std::mutex> lock(wakeup_mutex_);
+        while (!wakeup_.wait_for(lock, std::chrono::milliseconds(FLUSH_INTERVAL_MS), [this] { return stopping_; })) {
+            lock.unlock();
+            drain();
+            lock.lock();
+        }
+    }
+
+public:
+    Logger() : stopping_(false) {
+        buffer_.reserve(64 * 1024);
+        flusher_ = std::thread(&Logger::run, this);
+    }
+
+    ~Logger() {
+        {
+            std::lock_guard<std::mutex> lock(wakeup_mutex_);
+            stopping_ = true;
+        }
+        wakeup_.notify_all();
+        if (flusher_.joinable()) {
+            flusher_.join();
+        }
+        drain();
+    }
+
+    std::shared_ptr<ThreadRing> register_ring() {
+        std::shared_ptr<ThreadRing> ring = std::make_shared<ThreadRing>();
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        rings_.push_back(ring);
+        return ring;
+    }
+
+    void drain();
+};
+
+static Logger& logger() {
+    static Logger instance;
+    return instance;
+}
+
+static thread_local std::shared_ptr<ThreadRing> thread_ring;
+
+static void format_time(uint64_t time_ns, std::string& out) {
+    std::time_t seconds = static_cast<std::time_t>(time_ns / 1000000000ull);
+    std::tm local;
+#ifdef _WIN32
+    localtime_s(&local, &seconds);
+#else
+    localtime_r(&seconds, &local);
+#endif
+    char text[32];
+    std::snprintf(text, sizeof(text), "%02d:%02d:%02d.%03u ", local.tm_hour, local.tm_min, local.tm_sec,
+                  static_cast<unsigned>(time_ns / 1000000ull % 1000));
+    out += text;
+}
+
+static void format_arg(const Record& record, const Arg& arg, std::string& out) {
+    char text[32];
+    switch (arg.type) {
+        case ArgType::INT:
+            std::snprintf(text, sizeof(text), "%lld", static_cast<long long>(arg.i));
+            out += text;
+            break;
+        case ArgType::UINT:
+            std::snprintf(text, sizeof(text), "%llu", static_cast<unsigned long long>(arg.u));
+            out += text;
+            break;
+        case ArgType::DOUBLE:
+            std::snprintf(text, sizeof(text), "%g", arg.d);
+            out += text;
+            break;
+        case ArgType::CHAR:
+            out += arg.c;
+            break;
+        case ArgType::BOOL:
+            out += arg.u != 0 ? "true" : "false";
+            break;
+        case ArgType::TEXT:
+            out.append(record.text + arg.text_offset, arg.text_size);
+            break;
+    }
+}
+
+static void format_record(const Record& record, std::string& out) {
+    format_time(record.time_ns, out);
+    if (record.level != Level::INFO) {
+        out += level_name(record.level);
+        out += ": ";
+    }
+
+    int next = 0;
+    for (const char* p = record.format; *p != '\0'; ++p) {
+        if (p[0] == '{' && p[1] == '}' && next < record.arg_count) {
+            format_arg(record, record.args[next++], out);
+            ++p;
+        } else {
+            out += *p;
+        }
+    }
+    out += '\n';
+}
+
+void Logger::drain() {
+    std::vector<std::shared_ptr<ThreadRing>> rings;
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        // Кольца завершившихся потоков удаляются, когда из них всё выведено
+        for (size_t i = 0; i < rings_.size(); ) {
+            ThreadRing& ring = *rings_[i];
+            bool empty = ring.head.load(std::memory_order_acquire) == ring.tail.load(std::memory_order_relaxed);
+            if (rings_[i].use_count() == 1 && empty) {
+                rings_[i] = rings_.back();
+                rings_.pop_back();
+            } else {
+                ++i;
+            }
+        }
+        rings = rings_;
+    }
+
+    std::lock_guard<std::mutex> lock(output_mutex_);
+    buffer_.clear();
+    for (const std::shared_ptr<ThreadRing>& ring : rings) {
+        uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+        uint32_t head = ring->head.load(std::memory_order_acquire);
+        for (; tail != head; ++tail) {
+            format_record(ring->records[tail % RING_RECORDS], buffer_);
+        }
+        ring->tail.store(tail, std::memory_order_release);
+
+        uint64_t dropped = ring->dropped.load(std::memory_order_relaxed);
+        if (dropped != ring->reported_dropped) {
+            buffer_ += "WARN: log ring full, ";
+            buffer_ += std::to_string(dropped - ring->reported_dropped);
+            buffer_ += " record(s) dropped\n";
+            ring->reported_dropped = dropped;
+        }
+    }
+
+    if (!buffer_.empty()) {
+        std::fwrite(buffer_.data(), 1, buffer_.size(), stdout);
+        std::fflush(stdout);
+    }
+}
+
+bool parse_level(const std::string& name, Level& level) {
+    static const Level levels[] = {Level::DEBUG, Level::INFO, Level::WARN, Level::ERR, Level::OFF};
+    for (Level candidate : levels) {
+        std::string candidate_name = level_name(candidate);
+        for (char& c : candidate_name) {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+        if (name == candidate_name) {
+            level = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* level_name(Level level) {
+    switch (level) {
+        case Level::DEBUG: return "DEBUG";
+        case Level::INFO: return "INFO";
+        case Level::WARN: return "WARN";
+        case Level::ERR: return "ERROR";
+        case Level::OFF: return "OFF";
+    }
+    return "UNKNOWN";
+}
+
+void set_level(Level level) {
+    current_level.store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+}
+
+Level get_level() {
+    return static_cast<Level>(current_level.load(std::memory_order_relaxed));
+}
+
+bool enabled(Level level) {
+    return level != Level::OFF && static_cast<uint8_t>(level) >= current_level.load(std::memory_order_relaxed);
+}
+
+void flush() {
+    logger().drain();
+}
+
+Record* begin_record(Level level, const char* format) {
+    if (!enabled(level)) {
+        return nullptr;
+    }
+    if (!thread_ring) {
+        thread_ring = logger().register_ring();
+    }
+
+    ThreadRing& ring = *thread_ring;
+    uint32_t head = ring.head.load(std::memory_order_relaxed);
+    if (head - ring.tail.load(std::memory_order_acquire) >= RING_RECORDS) {
+        ring.dropped.store(ring.dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    Record& record = ring.records[head % RING_RECORDS];
+    record.time_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    record.format = format;
+    record.level = level;
+    record.arg_count = 0;
+    record.text_used = 0;
+    return &record;
+}
+
+void commit_record() {
+    ThreadRing& ring = *thread_ring;
+    ring.head.store(ring.head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+}
@@ -0,0 +1,179 @@
+#ifndef LOGGER_HPP
+#define LOGGER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Асинхронный журнал сервера. Поток-писатель только копирует строку формата
+// (указатель на литерал) и аргументы в запись своего кольцевого буфера -
+// без блокировок, форматирования и системных вызовов. Фоновый поток раз в
+// несколько миллисекунд разбирает кольца всех потоков, подставляет аргументы
+// вместо "{}" и пишет накопленное в stdout одним вызовом. Если кольцо полно,
+// запись отбрасывается (число потерянных записей попадает в журнал), писатель не ждёт.
+namespace Log {
+
+// ERR, а не ERROR: windows.h определяет макрос ERROR
+enum class Level : uint8_t {
+    DEBUG,
+    INFO,
+    WARN,
+    ERR,
+    OFF
+};
+
+bool parse_level(const std::string& name, Level& level);
+const char* level_name(Level level);
+void set_level(Level level);
+Level get_level();
+bool enabled(Level level);
+// Синхронно выводит всё накопленное (вызывается и при завершении процесса)
+void flush();
+
+const int MAX_ARGS = 8;
+const int RECORD_TEXT_SIZE = 104;   // строки-аргументы копируются сюда и при нехватке места обрезаются
+
+enum class ArgType : uint8_t {
+    INT,
+    UINT,
+    DOUBLE,
+    CHAR,
+    BOOL,
+    TEXT
+};
+
+struct Arg {
+    ArgType type;
+    uint16_t text_offset;
+    uint16_t text_size;
+    union {
+        int64_t i;
+        uint64_t u;
+        double d;
+        char c;
+    };
+};
+
+// Запись кольца; форматирование откладывается до фонового потока
+struct Record {
+    uint64_t time_ns;               // system_clock
+    const char* format;             // строка формата должна жить до вывода - литерал
+    Level level;
+    uint8_t arg_count;
+    uint16_t text_used;
+    Arg args[MAX_ARGS];
+    char text[RECORD_TEXT_SIZE];
+};
+
+// Запись в кольце текущего потока; nullptr - уровень отключён или кольцо полно
+Record* begin_record(Level level, const char* format);
+void commit_record();
+
+inline Arg* next_arg(Record& record) {
+    return record.arg_count < MAX_ARGS ? &record.args[record.arg_count++] : nullptr;
+}
+
+inline void append(Record& record, std::string_view value) {
+    Arg* arg = next_arg(record);
+    if (arg == nullptr) {
+        return;
+    }
+    size_t size = value.size();
+    size_t room = RECORD_TEXT_SIZE - record.text_used;
+    if (size > room) {
+        size = room;
+    }
+    arg->type = ArgType::TEXT;
+    arg->text_offset = record.text_used;
+    arg->text_size = static_cast<uint16_t>(size);
+    std::memcpy(record.text + record.text_used, value.data(), size);
+    record.text_used = static_cast<uint16_t>(record.text_used + size);
+}
+
+inline void append(Record& record, const std::string& value) {
+    append(record, std::string_view(value));
+}
+
+inline void append(Record& record, const char* value) {
+    append(record, std::string_view(value != nullptr ? value : "(null)"));
+}
+
+inline void append(Record& record, char value) {
+    Arg* arg = next_arg(record);
+    if (arg != nullptr) {
+        arg->type = ArgType::CHAR;
+        arg->c = value;
+    }
+}
+
+inline void append(Record& record, bool value) {
+    Arg* arg = next_arg(record);
+    if (arg != nullptr) {
+        arg->type = ArgType::BOOL;
+        arg->u = value ? 1 : 0;
+    }
+}
+
+template <typename T>
+inline typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type
+append(Record& record, T value) {
+    Arg* arg = next_arg(record);
+    if (arg == nullptr) {
+        return;
+    }
+    if (std::is_signed<T>::value) {
+        arg->type = ArgType::INT;
+        arg->i = static_cast<int64_t>(value);
+    } else {
+        arg->type = ArgType::UINT;
+        arg->u = static_cast<uint64_t>(value);
+    }
+}
+
+template <typename T>
+inline typename std::enable_if<std::is_floating_point<T>::value>::type
+append(Record& record, T value) {
+    Arg* arg = next_arg(record);
+    if (arg != nullptr) {
+        arg->type = ArgType::DOUBLE;
+        arg->d = static_cast<double>(value);
+    }
+}
+
+// Каждый "{}" в format заменяется очередным аргументом
+template <typename... Args>
+void write(Level level, const char* format, const Args&... args) {
+    Record* record = begin_record(level, format);
+    if (record == nullptr) {
+        return;
+    }
+    (append(*record, args), ...);
+    commit_record();
+}
+
+template <typename... Args>
+void debug(const char* format, const Args&... args) {
+    write(Level::DEBUG, format, args...);
+}
+
+template <typename... Args>
+void info(const char* format, const Args&... args) {
+    write(Level::INFO, format, args...);
+}
+
+template <typename... Args>
+void warn(const char* format, const Args&... args) {
+    write(Level::WARN, format, args...);
+}
+
+template <typename... Args>
+void error(const char* format, const Args&... args) {
+    write(Level::ERR, format, args...);
+}
+
+}
+
+#endif
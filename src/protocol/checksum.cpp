@@ -0,0 +1,120 @@
+#include "checksum.hpp"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CHECKSUM_X86 1
+#include <nmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// Функция с инструкциями SSE4.2 в файле, собранном без -msse4.2
+#if defined(CHECKSUM_X86) && defined(__GNUC__)
+#define CHECKSUM_TARGET_SSE42 __attribute__((target("sse4.2")))
+#else
+#define CHECKSUM_TARGET_SSE42
+#endif
+
+namespace Protocol {
+
+uint32_t xor_checksum(uint32_t checksum, const uint8_t* data, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        checksum ^= data[i];
+    }
+    return checksum;
+}
+
+// ==================== Табличная реализация ====================
+
+// Отражённый полином Castagnoli
+static const uint32_t CRC32C_POLY = 0x82F63B78;
+
+struct Crc32cTable {
+    uint32_t entries[256];
+
+    Crc32cTable() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc >> 1) ^ (CRC32C_POLY & (0u - (crc & 1)));
+            }
+            entries[i] = crc;
+        }
+    }
+};
+
+uint32_t crc32c_software(uint32_t crc, const uint8_t* data, size_t size) {
+    static const Crc32cTable table;
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i) {
+        crc = table.entries[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+// ==================== SSE4.2 ====================
+
+#ifdef CHECKSUM_X86
+
+bool crc32c_hardware_available() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 20)) != 0;
+#else
+    return __builtin_cpu_supports("sse4.2");
+#endif
+}
+
+CHECKSUM_TARGET_SSE42
+uint32_t crc32c_hardware(uint32_t crc, const uint8_t* data, size_t size) {
+    crc = ~crc;
+
+#if defined(__x86_64__) || defined(_M_X64)
+    uint64_t crc64 = crc;
+    while (size >= sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, data, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+        data += sizeof(word);
+        size -= sizeof(word);
+    }
+    crc = static_cast<uint32_t>(crc64);
+#endif
+
+    while (size >= sizeof(uint32_t)) {
+        uint32_t word;
+        std::memcpy(&word, data, sizeof(word));
+        crc = _mm_crc32_u32(crc, word);
+        data += sizeof(word);
+        size -= sizeof(word);
+    }
+    while (size > 0) {
+        crc = _mm_crc32_u8(crc, *data);
+        ++data;
+        --size;
+    }
+    return ~crc;
+}
+
+#else
+
+bool crc32c_hardware_available() {
+    return false;
+}
+
+uint32_t crc32c_hardware(uint32_t crc, const uint8_t* data, size_t size) {
+    return crc32c_software(crc, data, size);
+}
+
+#endif
+
+uint32_t crc32c(uint32_t crc, const uint8_t* data, size_t size) {
+    typedef uint32_t (*Crc32cFunction)(uint32_t, const uint8_t*, size_t);
+    static const Crc32cFunction implementation = crc32c_hardware_available() ? crc32c_hardware : crc32c_software;
+    return implementation(crc, data, size);
+}
+
+}
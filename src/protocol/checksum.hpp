@@ -0,0 +1,24 @@
+#ifndef CHECKSUM_HPP
+#define CHECKSUM_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+namespace Protocol {
+
+// Побайтовый XOR - прежняя контрольная сумма, её понимают все версии
+uint32_t xor_checksum(uint32_t checksum, const uint8_t* data, size_t size);
+
+// CRC32C (полином Castagnoli). Реализация выбирается при первом вызове:
+// инструкция crc32 из SSE4.2, если процессор её поддерживает, иначе таблица.
+// crc - значение для продолжения расчёта, 0 для начала.
+uint32_t crc32c(uint32_t crc, const uint8_t* data, size_t size);
+
+// Обе реализации доступны напрямую для сравнения в бенчмарке
+uint32_t crc32c_software(uint32_t crc, const uint8_t* data, size_t size);
+uint32_t crc32c_hardware(uint32_t crc, const uint8_t* data, size_t size);
+bool crc32c_hardware_available();
+
+}
+
+#endif
@@ -0,0 +1,387 @@
+#include "codec.hpp"
+#include "checksum.hpp"
+#include <cstring>
+#include <cctype>
+
+namespace Protocol {
+
+// Последовательная запись в буфер фиксированного размера; переполнение
+// запоминается и проверяется один раз в конце
+class Writer {
+private:
+    uint8_t* data_;
+    size_t capacity_;
+    size_t size_;
+    bool overflow_;
+
+public:
+    Writer(MutableByteSpan out, size_t offset)
+        : data_(out.data), capacity_(out.size), size_(offset), overflow_(offset > out.size) {}
+
+    void put_u8(uint8_t value) {
+        put_bytes(&value, 1);
+    }
+
+    void put_u16(uint16_t value) {
+        uint8_t bytes[2] = {static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value & 0xFF)};
+        put_bytes(bytes, 2);
+    }
+
+    void put_bytes(const void* bytes, size_t count) {
+        if (overflow_ || count > capacity_ - size_) {
+            overflow_ = true;
+            return;
+        }
+        std::memcpy(data_ + size_, bytes, count);
+        size_ += count;
+    }
+
+    void put_u32(uint32_t value) {
+        put_u16(static_cast<uint16_t>(value >> 16));
+        put_u16(static_cast<uint16_t>(value & 0xFFFF));
+    }
+
+    // Маска позиций слова: младшие байты вперёд, ровно столько байтов, сколько нужно длине слова
+    void put_mask(uint64_t mask, size_t bytes) {
+        for (size_t i = 0; i < bytes; ++i) {
+            put_u8(static_cast<uint8_t>(mask >> (8 * i)));
+        }
+    }
+
+    void put_string(std::string_view text) {
+        if (text.size() > 0xFFFF) {
+            overflow_ = true;
+            return;
+        }
+        put_u16(static_cast<uint16_t>(text.size()));
+        put_bytes(text.data(), text.size());
+    }
+
+    // Данные не кодируются - сообщение не собирается, как и при переполнении
+    void fail() { overflow_ = true; }
+
+    bool ok() const { return !overflow_; }
+    size_t size() const { return size_; }
+};
+
+class Reader {
+private:
+    ByteSpan in_;
+    size_t offset_;
+    bool ok_;
+
+public:
+    explicit Reader(ByteSpan in) : in_(in), offset_(0), ok_(true) {}
+
+    uint8_t get_u8() {
+        if (!ok_ || offset_ + 1 > in_.size) {
+            ok_ = false;
+            return 0;
+        }
+        return in_.data[offset_++];
+    }
+
+    uint16_t get_u16() {
+        uint16_t high = get_u8();
+        uint16_t low = get_u8();
+        return static_cast<uint16_t>((high << 8) | low);
+    }
+
+    uint32_t get_u32() {
+        uint32_t high = get_u16();
+        uint32_t low = get_u16();
+        return (high << 16) | low;
+    }
+
+    uint64_t get_mask(size_t bytes) {
+        uint64_t mask = 0;
+        for (size_t i = 0; i < bytes; ++i) {
+            mask |= static_cast<uint64_t>(get_u8()) << (8 * i);
+        }
+        return mask;
+    }
+
+    ByteSpan get_bytes(size_t count) {
+        if (!ok_ || count > in_.size - offset_) {
+            ok_ = false;
+            return ByteSpan{nullptr, 0};
+        }
+        ByteSpan bytes{in_.data + offset_, count};
+        offset_ += count;
+        return bytes;
+    }
+
+    std::string_view get_string() {
+        size_t length = get_u16();
+        ByteSpan bytes = get_bytes(length);
+        return std::string_view(reinterpret_cast<const char*>(bytes.data), bytes.size);
+    }
+
+    ByteSpan rest() const {
+        return ok_ ? ByteSpan{in_.data + offset_, in_.size - offset_} : ByteSpan{nullptr, 0};
+    }
+
+    bool ok() const { return ok_; }
+};
+
+static size_t position_mask_bytes(size_t word_length) {
+    return (word_length + 7) / 8;
+}
+
+static size_t count_bits(uint64_t bits) {
+    size_t count = 0;
+    for (; bits != 0; bits &= bits - 1) {
+        ++count;
+    }
+    return count;
+}
+
+uint32_t calculate_checksum(const MessageHeader& header, ByteSpan payload, ChecksumType type) {
+    const uint8_t* header_bytes = reinterpret_cast<const uint8_t*>(&header);
+    size_t header_size = sizeof(MessageHeader) - sizeof(header.checksum);
+
+    if (type == ChecksumType::CRC32C) {
+        return crc32c(crc32c(0, header_bytes, header_size), payload.data, payload.size);
+    }
+    return xor_checksum(xor_checksum(0, header_bytes, header_size), payload.data, payload.size);
+}
+
+GameStateView make_game_state_view(const GameState& state) {
+    return GameStateView{state.display_word, state.errors_left, state.status, state.additional_info};
+}
+
+CompactStateView make_compact_state_view(const CompactState& state) {
+    return CompactStateView{state.word_length, state.errors_left, state.status, state.code,
+                            state.guessed_mask, state.wrong_mask, state.base_sequence,
+                            state.changed_positions, state.letters, state.secret_word};
+}
+
+// Заголовок дописывается последним: размер и контрольная сумма известны только после payload
+static size_t finish_message(MutableByteSpan out, const Writer& writer, uint32_t session_id,
+                             uint32_t sequence, uint32_t message_type, ChecksumType checksum) {
+    if (!writer.ok()) {
+        return 0;
+    }
+
+    MessageHeader header;
+    header.session_id = session_id;
+    header.sequence = sequence;
+    header.message_type = message_type | (checksum == ChecksumType::CRC32C ? MessageFlags::CRC32C : 0);
+    header.payload_size = static_cast<uint32_t>(writer.size() - sizeof(MessageHeader));
+    header.checksum = calculate_checksum(header, ByteSpan{out.data + sizeof(MessageHeader), header.payload_size},
+                                         checksum);
+    std::memcpy(out.data, &header, sizeof(header));
+    return writer.size();
+}
+
+static void put_game_state(Writer& writer, const GameStateView& state) {
+    writer.put_u8(PayloadType::GAME_STATE);
+    writer.put_string(state.display_word);
+    writer.put_u8(state.errors_left);
+    writer.put_u8(state.status);
+    writer.put_string(state.additional_info);
+}
+
+// [тип][длина слова][ошибок осталось][статус][код][угаданные u32][ошибочные u32]
+// [base_sequence u32][маска изменённых позиций][буквы этих позиций][загаданное слово]
+static void put_compact_state(Writer& writer, const CompactStateView& state) {
+    if (state.word_length > MAX_COMPACT_WORD_LENGTH ||
+        state.letters.size() != count_bits(state.changed_positions) ||
+        state.secret_word.size() > 0xFF) {
+        writer.fail();
+        return;
+    }
+
+    writer.put_u8(PayloadType::COMPACT_STATE);
+    writer.put_u8(state.word_length);
+    writer.put_u8(state.errors_left);
+    writer.put_u8(state.status);
+    writer.put_u8(state.code);
+    writer.put_u32(state.guessed_mask);
+    writer.put_u32(state.wrong_mask);
+    writer.put_u32(state.base_sequence);
+    writer.put_mask(state.changed_positions, position_mask_bytes(state.word_length));
+    writer.put_bytes(state.letters.data(), state.letters.size());
+    writer.put_u8(static_cast<uint8_t>(state.secret_word.size()));
+    writer.put_bytes(state.secret_word.data(), state.secret_word.size());
+}
+
+size_t encode_ping(MutableByteSpan out, uint32_t session_id, uint32_t sequence, std::string_view payload,
+                   ChecksumType checksum, uint32_t ack_sequence) {
+    Writer writer(out, sizeof(MessageHeader));
+
+    if (payload == "start") {
+        writer.put_u8(PayloadType::GAME_START);
+        writer.put_u8(Capability::CRC32C | Capability::COMPACT_STATE);
+    } else if (payload.length() == 1 && std::isalpha(static_cast<unsigned char>(payload[0]))) {
+        writer.put_u8(PayloadType::LETTER_GUESS);
+        writer.put_u8(static_cast<uint8_t>(payload[0]));
+        if (ack_sequence != 0) {
+            writer.put_u32(ack_sequence);
+        }
+    }
+
+    return finish_message(out, writer, session_id, sequence, MessageType::PING, checksum);
+}
+
+size_t encode_start(MutableByteSpan out, uint32_t session_id, uint32_t sequence, uint8_t difficulty,
+                    ChecksumType checksum) {
+    Writer writer(out, sizeof(MessageHeader));
+    writer.put_u8(PayloadType::GAME_START);
+    writer.put_u8(Capability::CRC32C | Capability::COMPACT_STATE);
+    if (difficulty != Difficulty::ANY) {
+        writer.put_u8(difficulty);
+    }
+    return finish_message(out, writer, session_id, sequence, MessageType::PING, checksum);
+}
+
+size_t encode_guess_batch(MutableByteSpan out, uint32_t session_id, uint32_t sequence, std::string_view letters,
+                          ChecksumType checksum, uint32_t ack_sequence) {
+    if (letters.empty() || letters.size() > MAX_BATCH_LETTERS) {
+        return 0;
+    }
+
+    Writer writer(out, sizeof(MessageHeader));
+    writer.put_u8(PayloadType::LETTER_BATCH);
+    writer.put_u8(static_cast<uint8_t>(letters.size()));
+    writer.put_bytes(letters.data(), letters.size());
+    if (ack_sequence != 0) {
+        writer.put_u32(ack_sequence);
+    }
+
+    return finish_message(out, writer, session_id, sequence, MessageType::PING, checksum);
+}
+
+size_t encode_pong(MutableByteSpan out, uint32_t session_id, uint32_t sequence, const GameStateView& state,
+                   ChecksumType checksum) {
+    Writer writer(out, sizeof(MessageHeader));
+    put_game_state(writer, state);
+
+    return finish_message(out, writer, session_id, sequence, MessageType::PONG, checksum);
+}
+
+size_t encode_compact_pong(MutableByteSpan out, uint32_t session_id, uint32_t sequence,
+                           const CompactStateView& state, ChecksumType checksum) {
+    Writer writer(out, sizeof(MessageHeader));
+    put_compact_state(writer, state);
+
+    return finish_message(out, writer, session_id, sequence, MessageType::PONG, checksum);
+}
+
+size_t encode_batch_pong(MutableByteSpan out, uint32_t session_id, uint32_t sequence,
+                         ByteSpan outcomes, const GameStateView& state, ChecksumType checksum) {
+    if (outcomes.size > MAX_BATCH_LETTERS) {
+        return 0;
+    }
+
+    Writer writer(out, sizeof(MessageHeader));
+    writer.put_u8(PayloadType::BATCH_STATE);
+    writer.put_u8(static_cast<uint8_t>(outcomes.size));
+    writer.put_bytes(outcomes.data, outcomes.size);
+    put_game_state(writer, state);
+
+    return finish_message(out, writer, session_id, sequence, MessageType::PONG, checksum);
+}
+
+size_t encode_compact_batch_pong(MutableByteSpan out, uint32_t session_id, uint32_t sequence,
+                                 ByteSpan outcomes, const CompactStateView& state, ChecksumType checksum) {
+    if (outcomes.size > MAX_BATCH_LETTERS) {
+        return 0;
+    }
+
+    Writer writer(out, sizeof(MessageHeader));
+    writer.put_u8(PayloadType::BATCH_STATE);
+    writer.put_u8(static_cast<uint8_t>(outcomes.size));
+    writer.put_bytes(outcomes.data, outcomes.size);
+    put_compact_state(writer, state);
+
+    return finish_message(out, writer, session_id, sequence, MessageType::PONG, checksum);
+}
+
+bool decode_message(ByteSpan in, MessageView& message) {
+    if (in.size < sizeof(MessageHeader)) {
+        return false;
+    }
+
+    std::memcpy(&message.header, in.data, sizeof(MessageHeader));
+    if (in.size - sizeof(MessageHeader) < message.header.payload_size) {
+        return false;
+    }
+    message.payload = ByteSpan{in.data + sizeof(MessageHeader), message.header.payload_size};
+
+    if (message.header.session_id == 0) return false;
+    if ((message.header.message_type & ~(MessageFlags::TYPE_MASK | MessageFlags::CRC32C)) != 0) return false;
+
+    message.checksum = (message.header.message_type & MessageFlags::CRC32C) != 0 ? ChecksumType::CRC32C
+                                                                                  : ChecksumType::XOR;
+    if (calculate_checksum(message.header, message.payload, message.checksum) != message.header.checksum) {
+        return false;
+    }
+
+    message.header.message_type &= MessageFlags::TYPE_MASK;
+    return message.header.message_type == MessageType::PING ||
+           message.header.message_type == MessageType::PONG;
+}
+
+static bool get_game_state(Reader& reader, GameStateView& state) {
+    if (reader.get_u8() != PayloadType::GAME_STATE) {
+        return false;
+    }
+    state.display_word = reader.get_string();
+    state.errors_left = reader.get_u8();
+    state.status = reader.get_u8();
+    state.additional_info = reader.get_string();
+    return reader.ok();
+}
+
+bool decode_game_state(ByteSpan payload, GameStateView& state) {
+    Reader reader(payload);
+    return get_game_state(reader, state);
+}
+
+bool decode_compact_state(ByteSpan payload, CompactStateView& state) {
+    Reader reader(payload);
+    if (reader.get_u8() != PayloadType::COMPACT_STATE) {
+        return false;
+    }
+
+    state.word_length = reader.get_u8();
+    if (state.word_length > MAX_COMPACT_WORD_LENGTH) {
+        return false;
+    }
+    state.errors_left = reader.get_u8();
+    state.status = reader.get_u8();
+    state.code = reader.get_u8();
+    state.guessed_mask = reader.get_u32();
+    state.wrong_mask = reader.get_u32();
+    state.base_sequence = reader.get_u32();
+    state.changed_positions = reader.get_mask(position_mask_bytes(state.word_length));
+
+    // Позиции за концом слова означают повреждённое сообщение
+    if (state.word_length < 64 && (state.changed_positions >> state.word_length) != 0) {
+        return false;
+    }
+
+    ByteSpan letters = reader.get_bytes(count_bits(state.changed_positions));
+    state.letters = std::string_view(reinterpret_cast<const char*>(letters.data), letters.size);
+    ByteSpan secret = reader.get_bytes(reader.get_u8());
+    state.secret_word = std::string_view(reinterpret_cast<const char*>(secret.data), secret.size);
+    return reader.ok();
+}
+
+bool decode_batch_state(ByteSpan payload, ByteSpan& outcomes, ByteSpan& state) {
+    Reader reader(payload);
+    if (reader.get_u8() != PayloadType::BATCH_STATE) {
+        return false;
+    }
+
+    size_t count = reader.get_u8();
+    if (count > MAX_BATCH_LETTERS) {
+        return false;
+    }
+    outcomes = reader.get_bytes(count);
+    state = reader.rest();
+    return reader.ok() && state.size > 0;
+}
+
+}
@@ -0,0 +1,90 @@
+#ifndef CODEC_HPP
+#define CODEC_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+#include "protocol.hpp"
+
+namespace Protocol {
+
+// Кодек без выделения памяти: сообщение собирается прямо в буфере вызывающего,
+// а разбирается как представление поверх принятых байтов. Представления
+// действительны, пока жив буфер, из которого они получены.
+
+// Непрерывный диапазон байтов (std::span до C++20)
+struct ByteSpan {
+    const uint8_t* data;
+    size_t size;
+};
+
+struct MutableByteSpan {
+    uint8_t* data;
+    size_t size;
+};
+
+struct GameStateView {
+    std::string_view display_word;
+    uint8_t errors_left;
+    uint8_t status;
+    std::string_view additional_info;
+};
+
+struct CompactStateView {
+    uint8_t word_length;
+    uint8_t errors_left;
+    uint8_t status;
+    uint8_t code;
+    uint32_t guessed_mask;
+    uint32_t wrong_mask;
+    uint32_t base_sequence;
+    uint64_t changed_positions;
+    std::string_view letters;
+    std::string_view secret_word;
+};
+
+struct MessageView {
+    MessageHeader header;
+    ByteSpan payload;
+    ChecksumType checksum;
+};
+
+// Сумма по заголовку (без поля checksum) и payload
+uint32_t calculate_checksum(const MessageHeader& header, ByteSpan payload, ChecksumType type);
+
+GameStateView make_game_state_view(const GameState& state);
+CompactStateView make_compact_state_view(const CompactState& state);
+
+// Кодирование: размер сообщения в out или 0, если оно не помещается
+size_t encode_ping(MutableByteSpan out, uint32_t session_id, uint32_t sequence, std::string_view payload,
+                   ChecksumType checksum = ChecksumType::XOR, uint32_t ack_sequence = 0);
+// GAME_START с возможностями клиента; байт сложности - только если она задана
+size_t encode_start(MutableByteSpan out, uint32_t session_id, uint32_t sequence, uint8_t difficulty,
+                    ChecksumType checksum = ChecksumType::XOR);
+size_t encode_guess_batch(MutableByteSpan out, uint32_t session_id, uint32_t sequence, std::string_view letters,
+                          ChecksumType checksum = ChecksumType::XOR, uint32_t ack_sequence = 0);
+size_t encode_pong(MutableByteSpan out, uint32_t session_id, uint32_t sequence, const GameStateView& state,
+                   ChecksumType checksum = ChecksumType::XOR);
+size_t encode_compact_pong(MutableByteSpan out, uint32_t session_id, uint32_t sequence,
+                           const CompactStateView& state, ChecksumType checksum = ChecksumType::XOR);
+size_t encode_batch_pong(MutableByteSpan out, uint32_t session_id, uint32_t sequence,
+                         ByteSpan outcomes, const GameStateView& state,
+                         ChecksumType checksum = ChecksumType::XOR);
+size_t encode_compact_batch_pong(MutableByteSpan out, uint32_t session_id, uint32_t sequence,
+                                 ByteSpan outcomes, const CompactStateView& state,
+                                 ChecksumType checksum = ChecksumType::XOR);
+
+// Разбор: заголовок копируется, payload указывает внутрь in; false - сообщение повреждено.
+// Флаги снимаются с header.message_type и попадают в checksum.
+bool decode_message(ByteSpan in, MessageView& message);
+bool decode_game_state(ByteSpan payload, GameStateView& state);
+bool decode_compact_state(ByteSpan payload, CompactStateView& state);
+// state - вложенное состояние (GAME_STATE или COMPACT_STATE), разбирается по своему типу
+bool decode_batch_state(ByteSpan payload, ByteSpan& outcomes, ByteSpan& state);
+
+// Приём сообщения в buffer (не меньше IPC::MAX_MESSAGE_SIZE) без выделения памяти; false - таймаут
+bool receive_message(uint32_t session_id, MutableByteSpan buffer, MessageView& message, int timeout_ms);
+
+}
+
+#endif
@@ -1,241 +1,278 @@
 #include "protocol.hpp"
+#include "codec.hpp"
 #include "../ipc/file_socket.hpp"
 #include <cstring>
 #include <chrono>
-#include <thread>
 #include <iostream>
 #include <algorithm>
 #include <cctype>
 
 namespace Protocol {
 
-// ==================== Вспомогательные функции ====================
+// ==================== Разбор payload ====================
 
-uint32_t calculate_checksum(const MessageHeader& header, const std::vector<uint8_t>& payload) {
-    uint32_t checksum = 0;
-    const uint8_t* header_bytes = reinterpret_cast<const uint8_t*>(&header);
-    
-    for (size_t i = 0; i < sizeof(MessageHeader) - sizeof(header.checksum); ++i) {
-        checksum ^= header_bytes[i];
-    }
+std::string parse_ping_payload(const std::vector<uint8_t>& payload) {
+    if (payload.empty()) return "";
     
-    for (uint8_t byte : payload) {
-        checksum ^= byte;
+    if (payload[0] == PayloadType::GAME_START) {
+        return "start";
+    } else if (payload[0] == PayloadType::LETTER_GUESS && payload.size() >= 2) {
+        return std::string(1, static_cast<char>(payload[1]));
     }
     
-    return checksum;
+    return "";
 }
 
-bool validate_message(const BinaryMessage& message) {
-    if (message.header.session_id == 0) return false;
-    if (message.header.message_type != MessageType::PING && 
-        message.header.message_type != MessageType::PONG) return false;
-    if (message.header.payload_size != message.payload.size()) return false;
-    
-    uint32_t calculated_checksum = calculate_checksum(message.header, message.payload);
-    return calculated_checksum == message.header.checksum;
+bool is_batch_payload(const std::vector<uint8_t>& payload) {
+    return !payload.empty() && payload[0] == PayloadType::LETTER_BATCH;
 }
 
-// ==================== Сериализация/десериализация ====================
-
-std::vector<uint8_t> serialize_game_state(const GameState& state) {
-    std::vector<uint8_t> data;
-    
-    data.push_back(PayloadType::GAME_STATE);
-    
-    uint16_t word_length = static_cast<uint16_t>(state.display_word.length());
-    data.push_back(static_cast<uint8_t>(word_length >> 8));
-    data.push_back(static_cast<uint8_t>(word_length & 0xFF));
-    data.insert(data.end(), state.display_word.begin(), state.display_word.end());
-    
-    data.push_back(state.errors_left);
-    data.push_back(state.status);
-    
-    uint16_t info_length = static_cast<uint16_t>(state.additional_info.length());
-    data.push_back(static_cast<uint8_t>(info_length >> 8));
-    data.push_back(static_cast<uint8_t>(info_length & 0xFF));
-    data.insert(data.end(), state.additional_info.begin(), state.additional_info.end());
-    
-    return data;
+bool is_batch_pong_payload(const std::vector<uint8_t>& payload) {
+    return !payload.empty() && payload[0] == PayloadType::BATCH_STATE;
 }
 
-GameState deserialize_game_state(const std::vector<uint8_t>& data) {
-    GameState state;
-    size_t offset = 0;
+std::string parse_batch_payload(const std::vector<uint8_t>& payload) {
+    if (!is_batch_payload(payload) || payload.size() < 2) {
+        return "";
+    }
     
-    if (data.empty() || data[offset++] != PayloadType::GAME_STATE) {
-        return state;
+    // За буквами может идти 4-байтовый ack_sequence
+    size_t count = payload[1];
+    if (count == 0 || count > MAX_BATCH_LETTERS ||
+        (payload.size() != 2 + count && payload.size() != 2 + count + sizeof(uint32_t))) {
+        return "";
     }
     
-    if (offset + 2 <= data.size()) {
-        uint16_t word_length = (static_cast<uint16_t>(data[offset]) << 8) | data[offset + 1];
-        offset += 2;
-        
-        if (offset + word_length <= data.size()) {
-            state.display_word.assign(data.begin() + offset, data.begin() + offset + word_length);
-            offset += word_length;
+    std::string letters(payload.begin() + 2, payload.begin() + 2 + count);
+    for (char letter : letters) {
+        if (!std::isalpha(static_cast<unsigned char>(letter))) {
+            return "";
         }
     }
-    
-    if (offset < data.size()) {
-        state.errors_left = data[offset++];
+    return letters;
+}
+
+uint8_t parse_capabilities(const std::vector<uint8_t>& payload) {
+    if (payload.size() >= 2 && payload[0] == PayloadType::GAME_START) {
+        return payload[1];
     }
-    
-    if (offset < data.size()) {
-        state.status = data[offset++];
+    return 0;
+}
+
+uint8_t parse_difficulty(const std::vector<uint8_t>& payload) {
+    if (payload.size() >= 3 && payload[0] == PayloadType::GAME_START && payload[2] <= Difficulty::HARD) {
+        return payload[2];
     }
-    
-    if (offset + 2 <= data.size()) {
-        uint16_t info_length = (static_cast<uint16_t>(data[offset]) << 8) | data[offset + 1];
-        offset += 2;
-        
-        if (offset + info_length <= data.size()) {
-            state.additional_info.assign(data.begin() + offset, data.begin() + offset + info_length);
-        }
+    return Difficulty::ANY;
+}
+
+uint32_t parse_ack_sequence(const std::vector<uint8_t>& payload) {
+    size_t offset;
+    if (payload.size() == 2 + sizeof(uint32_t) && payload[0] == PayloadType::LETTER_GUESS) {
+        offset = 2;
+    } else if (payload.size() >= 2 && payload[0] == PayloadType::LETTER_BATCH &&
+               payload.size() == 2 + payload[1] + sizeof(uint32_t)) {
+        offset = 2 + payload[1];
+    } else {
+        return 0;
     }
     
-    return state;
+    return (static_cast<uint32_t>(payload[offset]) << 24) | (static_cast<uint32_t>(payload[offset + 1]) << 16) |
+           (static_cast<uint32_t>(payload[offset + 2]) << 8) | payload[offset + 3];
 }
 
-std::string parse_ping_payload(const std::vector<uint8_t>& payload) {
-    if (payload.empty()) return "";
-    
-    if (payload[0] == PayloadType::GAME_START) {
-        return "start";
-    } else if (payload[0] == PayloadType::LETTER_GUESS && payload.size() >= 2) {
-        return std::string(1, static_cast<char>(payload[1]));
+bool is_compact_pong_payload(const std::vector<uint8_t>& payload) {
+    return !payload.empty() && payload[0] == PayloadType::COMPACT_STATE;
+}
+
+static void to_compact_state(const CompactStateView& view, CompactState& state) {
+    state.word_length = view.word_length;
+    state.errors_left = view.errors_left;
+    state.status = view.status;
+    state.code = view.code;
+    state.guessed_mask = view.guessed_mask;
+    state.wrong_mask = view.wrong_mask;
+    state.base_sequence = view.base_sequence;
+    state.changed_positions = view.changed_positions;
+    state.letters.assign(view.letters.data(), view.letters.size());
+    state.secret_word.assign(view.secret_word.data(), view.secret_word.size());
+}
+
+bool parse_compact_pong_payload(const std::vector<uint8_t>& payload, CompactState& state) {
+    CompactStateView view{};
+    if (!decode_compact_state(ByteSpan{payload.data(), payload.size()}, view)) {
+        return false;
     }
-    
-    return "";
+    to_compact_state(view, state);
+    return true;
+}
+
+static GameState to_game_state(const GameStateView& view) {
+    GameState state;
+    state.display_word.assign(view.display_word.data(), view.display_word.size());
+    state.errors_left = view.errors_left;
+    state.status = view.status;
+    state.additional_info.assign(view.additional_info.data(), view.additional_info.size());
+    return state;
 }
 
-// ==================== Создание сообщений ====================
+GameState parse_pong_payload(const std::vector<uint8_t>& payload) {
+    GameStateView view{};
+    if (!decode_game_state(ByteSpan{payload.data(), payload.size()}, view)) {
+        return GameState{};
+    }
+    return to_game_state(view);
+}
 
-BinaryMessage create_ping_message(uint32_t session_id, uint32_t sequence, const std::string& payload) {
-    BinaryMessage message;
-    message.header.session_id = session_id;
-    message.header.sequence = sequence;
-    message.header.message_type = MessageType::PING;
-    
-    if (payload == "start") {
-        message.payload = {PayloadType::GAME_START};
-    } else if (payload.length() == 1 && std::isalpha(payload[0])) {
-        message.payload = {PayloadType::LETTER_GUESS, static_cast<uint8_t>(payload[0])};
+BatchResult parse_batch_pong_payload(const std::vector<uint8_t>& payload) {
+    BatchResult result;
+    ByteSpan outcomes{nullptr, 0};
+    ByteSpan state{nullptr, 0};
+    if (!decode_batch_state(ByteSpan{payload.data(), payload.size()}, outcomes, state)) {
+        return result;
     }
     
-    message.header.payload_size = static_cast<uint32_t>(message.payload.size());
-    message.header.checksum = calculate_checksum(message.header, message.payload);
+    if (state.data[0] == PayloadType::COMPACT_STATE) {
+        CompactStateView view{};
+        if (!decode_compact_state(state, view)) {
+            return result;
+        }
+        result.compact = true;
+        to_compact_state(view, result.compact_state);
+    } else {
+        GameStateView view{};
+        if (!decode_game_state(state, view)) {
+            return result;
+        }
+        result.state = to_game_state(view);
+    }
     
-    return message;
+    result.outcomes.assign(outcomes.data, outcomes.data + outcomes.size);
+    return result;
 }
 
-BinaryMessage create_pong_message(uint32_t session_id, uint32_t sequence, const GameState& game_state) {
-    BinaryMessage message;
-    message.header.session_id = session_id;
-    message.header.sequence = sequence;
-    message.header.message_type = MessageType::PONG;
-    message.payload = serialize_game_state(game_state);
-    message.header.payload_size = static_cast<uint32_t>(message.payload.size());
-    message.header.checksum = calculate_checksum(message.header, message.payload);
-    
-    return message;
+// ==================== Основные функции протокола ====================
+
+// Сообщение собирается в буфере на стеке и копируется прямо в регион
+bool send_binary_ping(uint32_t session_id, uint32_t sequence, const std::string& payload, ChecksumType checksum,
+                      uint32_t ack_sequence) {
+    uint8_t buffer[IPC::MAX_MESSAGE_SIZE];
+    size_t size = encode_ping(MutableByteSpan{buffer, sizeof(buffer)}, session_id, sequence, payload, checksum,
+                              ack_sequence);
+    return size != 0 && FileSocket::write_to_client_region(session_id, reinterpret_cast<const char*>(buffer), size);
 }
 
-// ==================== Основные функции протокола ====================
+bool send_binary_start(uint32_t session_id, uint32_t sequence, uint8_t difficulty, ChecksumType checksum) {
+    uint8_t buffer[IPC::MAX_MESSAGE_SIZE];
+    size_t size = encode_start(MutableByteSpan{buffer, sizeof(buffer)}, session_id, sequence, difficulty, checksum);
+    return size != 0 && FileSocket::write_to_client_region(session_id, reinterpret_cast<const char*>(buffer), size);
+}
 
-bool send_binary_ping(uint32_t session_id, uint32_t sequence, const std::string& payload) {
-    BinaryMessage message = create_ping_message(session_id, sequence, payload);
-    
-    std::vector<uint8_t> serialized_data;
-    const uint8_t* header_bytes = reinterpret_cast<const uint8_t*>(&message.header);
-    serialized_data.insert(serialized_data.end(), header_bytes, header_bytes + sizeof(MessageHeader));
-    serialized_data.insert(serialized_data.end(), message.payload.begin(), message.payload.end());
-    
-    std::vector<char> char_data(serialized_data.begin(), serialized_data.end());
-    return FileSocket::write_to_client_region(session_id, char_data);
+bool send_binary_guess_batch(uint32_t session_id, uint32_t sequence, const std::string& letters,
+                             ChecksumType checksum, uint32_t ack_sequence) {
+    uint8_t buffer[IPC::MAX_MESSAGE_SIZE];
+    size_t size = encode_guess_batch(MutableByteSpan{buffer, sizeof(buffer)}, session_id, sequence, letters,
+                                     checksum, ack_sequence);
+    return size != 0 && FileSocket::write_to_client_region(session_id, reinterpret_cast<const char*>(buffer), size);
 }
 
-bool send_binary_pong(uint32_t session_id, uint32_t sequence, const GameState& game_state) {
-    BinaryMessage message = create_pong_message(session_id, sequence, game_state);
-    
-    std::vector<uint8_t> serialized_data;
-    const uint8_t* header_bytes = reinterpret_cast<const uint8_t*>(&message.header);
-    serialized_data.insert(serialized_data.end(), header_bytes, header_bytes + sizeof(MessageHeader));
-    serialized_data.insert(serialized_data.end(), message.payload.begin(), message.payload.end());
-    
-    std::vector<char> char_data(serialized_data.begin(), serialized_data.end());
-    return FileSocket::write_to_server_region(session_id, char_data);
+bool send_binary_pong(uint32_t session_id, uint32_t sequence, const GameState& game_state,
+                      ChecksumType checksum) {
+    uint8_t buffer[IPC::MAX_MESSAGE_SIZE];
+    size_t size = encode_pong(MutableByteSpan{buffer, sizeof(buffer)}, session_id, sequence,
+                              make_game_state_view(game_state), checksum);
+    return size != 0 && FileSocket::write_to_server_region(session_id, reinterpret_cast<const char*>(buffer), size);
 }
 
-BinaryMessage receive_binary_message(uint32_t session_id, int timeout_ms) {
+bool send_compact_pong(uint32_t session_id, uint32_t sequence, const CompactState& state, ChecksumType checksum) {
+    uint8_t buffer[IPC::MAX_MESSAGE_SIZE];
+    size_t size = encode_compact_pong(MutableByteSpan{buffer, sizeof(buffer)}, session_id, sequence,
+                                      make_compact_state_view(state), checksum);
+    return size != 0 && FileSocket::write_to_server_region(session_id, reinterpret_cast<const char*>(buffer), size);
+}
+
+bool send_binary_batch_pong(uint32_t session_id, uint32_t sequence, const BatchResult& result,
+                            ChecksumType checksum) {
+    uint8_t buffer[IPC::MAX_MESSAGE_SIZE];
+    MutableByteSpan out{buffer, sizeof(buffer)};
+    ByteSpan outcomes{result.outcomes.data(), result.outcomes.size()};
+    size_t size = result.compact
+        ? encode_compact_batch_pong(out, session_id, sequence, outcomes, make_compact_state_view(result.compact_state),
+                                    checksum)
+        : encode_batch_pong(out, session_id, sequence, outcomes, make_game_state_view(result.state), checksum);
+    return size != 0 && FileSocket::write_to_server_region(session_id, reinterpret_cast<const char*>(buffer), size);
+}
+
+bool receive_message(uint32_t session_id, MutableByteSpan buffer, MessageView& message, int timeout_ms) {
+    if (buffer.size < IPC::MAX_MESSAGE_SIZE) {
+        return false;
+    }
+    
     auto start = std::chrono::steady_clock::now();
+    FileSocket::Doorbell doorbell = session_id == 0 ? FileSocket::server_doorbell(FileSocket::get_server_worker_id())
+                                                    : FileSocket::client_doorbell(session_id);
+    char* data = reinterpret_cast<char*>(buffer.data);
     
     while (true) {
-        std::vector<char> char_data;
-        BinaryMessage found_message;
-        bool found_valid_message = false;
-        uint32_t actual_session_id = session_id;
+        // Значение звонка снимаем до проверки регионов, чтобы не пропустить запись между ними
+        uint32_t seen_doorbell = doorbell.value();
         
         if (session_id == 0) {
-            for (uint32_t region_index = 1; region_index <= IPC::MAX_SESSIONS; region_index++) {
-                char_data = FileSocket::read_from_client_region(region_index);
-                
-                if (!char_data.empty() && char_data.size() >= sizeof(MessageHeader)) {
-                    std::vector<uint8_t> data(char_data.begin(), char_data.end());
-                    std::memcpy(&found_message.header, data.data(), sizeof(MessageHeader));
-                    
-                    actual_session_id = found_message.header.session_id;
-                    
-                    if (data.size() >= sizeof(MessageHeader) + found_message.header.payload_size) {
-                        found_message.payload.assign(data.begin() + sizeof(MessageHeader), 
-                                                   data.begin() + sizeof(MessageHeader) + found_message.header.payload_size);
-                        
-                        if (validate_message(found_message)) {
-                            found_valid_message = true;
-                            break;
-                        }
-                    }
+            // Сообщение с неверной контрольной суммой пропускаем и читаем следующее
+            static thread_local FileSocket::ClientRegionScanner scanner(FileSocket::get_server_worker_id(),
+                                                                        FileSocket::get_server_worker_count());
+            size_t size;
+            while ((size = scanner.read_next(data, buffer.size)) != 0) {
+                if (decode_message(ByteSpan{buffer.data, size}, message)) {
+                    return true;
                 }
             }
+            // Отложенные ответы (режим uring) уходят до того, как поток заснёт
+            FileSocket::flush_server_writes();
         } else {
-            char_data = FileSocket::read_from_server_region(session_id);
-            if (!char_data.empty() && char_data.size() >= sizeof(MessageHeader)) {
-                std::vector<uint8_t> data(char_data.begin(), char_data.end());
-                std::memcpy(&found_message.header, data.data(), sizeof(MessageHeader));
-                
-                if (data.size() >= sizeof(MessageHeader) + found_message.header.payload_size) {
-                    found_message.payload.assign(data.begin() + sizeof(MessageHeader), 
-                                               data.begin() + sizeof(MessageHeader) + found_message.header.payload_size);
-                    
-                    if (validate_message(found_message)) {
-                        found_valid_message = true;
-                    }
+            // Ответы другой сессии (прежнего владельца слота) не наши - отбрасываем
+            size_t size;
+            while ((size = FileSocket::read_from_server_region(session_id, data, buffer.size)) != 0) {
+                if (decode_message(ByteSpan{buffer.data, size}, message) && message.header.session_id == session_id) {
+                    return true;
                 }
             }
         }
         
-        if (found_valid_message) {
-            found_message.header.session_id = actual_session_id;
-            return found_message;
-        }
-        
         auto now = std::chrono::steady_clock::now();
-        if (std::chrono::duration_cast<std::chrono::milliseconds>(now - start).count() > timeout_ms) {
-            break;
+        auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - start).count();
+        if (elapsed_ms > timeout_ms) {
+            return false;
         }
         
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        doorbell.wait(seen_doorbell, static_cast<int>(timeout_ms - elapsed_ms));
     }
-    
-    return BinaryMessage();
 }
 
-// ==================== Валидация ====================
+bool receive_binary_message(uint32_t session_id, BinaryMessage& message, int timeout_ms) {
+    uint8_t buffer[IPC::MAX_MESSAGE_SIZE];
+    MessageView view;
+    if (!receive_message(session_id, MutableByteSpan{buffer, sizeof(buffer)}, view, timeout_ms)) {
+        message.header = MessageHeader{};
+        message.payload.clear();
+        message.checksum = ChecksumType::XOR;
+        return false;
+    }
+    
+    message.header = view.header;
+    message.checksum = view.checksum;
+    message.payload.assign(view.payload.data, view.payload.data + view.payload.size);
+    return true;
+}
 
-GameState parse_pong_payload(const std::vector<uint8_t>& payload) {
-    return deserialize_game_state(payload);
+BinaryMessage receive_binary_message(uint32_t session_id, int timeout_ms) {
+    BinaryMessage message;
+    receive_binary_message(session_id, message, timeout_ms);
+    return message;
 }
 
+// ==================== Валидация ====================
+
 bool validate_ping_payload(const std::string& payload) {
     if (payload.empty()) return false;
     if (payload == "start") return true;
@@ -247,4 +284,13 @@ bool validate_session_id(uint32_t session_id) {
     return session_id != 0;
 }
 
+ChecksumType reply_checksum(const BinaryMessage& request) {
+    if (request.checksum == ChecksumType::CRC32C) {
+        return ChecksumType::CRC32C;
+    }
+    
+    return (parse_capabilities(request.payload) & Capability::CRC32C) != 0 ? ChecksumType::CRC32C
+                                                                            : ChecksumType::XOR;
+}
+
 } 
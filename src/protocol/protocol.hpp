@@ -22,12 +22,61 @@ namespace MessageType {
     const uint32_t PONG = 2;
 }
 
+// Флаги в старших битах message_type. Сообщение с CRC32C посчитано по CRC32C,
+// без него - побайтовым XOR. Клиент сообщает о поддержке CRC32C байтом
+// возможностей в GAME_START; сервер отвечает с флагом, и дальше обе стороны
+// считают CRC32C. Это выбор возможностей, а не совместимость версий: клиент
+// и сервер разных сборок вместе не работают (см. IPC::SOCKET_FILE_VERSION).
+namespace MessageFlags {
+    const uint32_t TYPE_MASK = 0xFFFF;
+    const uint32_t CRC32C = 0x10000;
+}
+
+// Байт возможностей клиента после GAME_START
+namespace Capability {
+    const uint8_t CRC32C = 0x01;
+    const uint8_t COMPACT_STATE = 0x02;
+}
+
+// Уровень сложности слова - необязательный байт после возможностей в GAME_START
+namespace Difficulty {
+    const uint8_t ANY = 0;
+    const uint8_t EASY = 1;
+    const uint8_t MEDIUM = 2;
+    const uint8_t HARD = 3;
+}
+
+enum class ChecksumType {
+    XOR,
+    CRC32C
+};
+
 namespace PayloadType {
     const uint8_t GAME_START = 1;
     const uint8_t LETTER_GUESS = 2;
     const uint8_t GAME_STATE = 3;
+    // Несколько букв в одном PING: [тип][число букв][буквы...]
+    const uint8_t LETTER_BATCH = 4;
+    // Ответ на пакет: [тип][число исходов][исходы...][GAME_STATE или COMPACT_STATE]
+    const uint8_t BATCH_STATE = 5;
+    // Состояние масками и кодом исхода вместо текста (см. CompactState)
+    const uint8_t COMPACT_STATE = 6;
 }
 
+// Клиент, получивший COMPACT_STATE, добавляет к LETTER_GUESS и LETTER_BATCH
+// 4 байта - sequence последнего применённого ответа. Сервер, помнящий
+// состояние на этот ответ, присылает только изменившиеся позиции.
+
+// Исход одной буквы пакета
+namespace GuessOutcome {
+    const uint8_t CORRECT = 1;
+    const uint8_t WRONG = 2;
+    const uint8_t REPEATED = 3;
+}
+
+// Больше букв, чем в алфавите, пакет нести не может
+const size_t MAX_BATCH_LETTERS = 26;
+
 namespace GameStatus {
     const uint8_t IN_PROGRESS = 1;
     const uint8_t WIN = 2;
@@ -42,21 +91,94 @@ struct GameState {
     std::string additional_info;
 };
 
+// Исход хода в COMPACT_STATE; текст по нему составляет клиент
+namespace StateCode {
+    const uint8_t GAME_STARTED = 1;
+    const uint8_t CORRECT = 2;
+    const uint8_t WRONG = 3;
+    const uint8_t REPEATED = 4;
+    const uint8_t WON = 5;
+    const uint8_t LOST = 6;
+}
+
+// Позиции слова передаются битовой маской
+const size_t MAX_COMPACT_WORD_LENGTH = 64;
+
+// Компактное состояние игры. Маски букв - 26 бит, бит 0 - 'a'.
+// Передаются буквы только позиций changed_positions (по возрастанию позиции):
+// при base_sequence == 0 это все открытые позиции, иначе - открытые после
+// ответа с sequence base_sequence.
+struct CompactState {
+    uint8_t word_length = 0;
+    uint8_t errors_left = 0;
+    uint8_t status = 0;
+    uint8_t code = 0;
+    uint32_t guessed_mask = 0;
+    uint32_t wrong_mask = 0;
+    uint32_t base_sequence = 0;
+    uint64_t changed_positions = 0;
+    std::string letters;
+    // Загаданное слово - только после окончания игры
+    std::string secret_word;
+};
+
+// Исходы применённых букв пакета (сервер останавливается, как только игра кончилась)
+// и состояние игры после последней из них
+struct BatchResult {
+    std::vector<uint8_t> outcomes;
+    GameState state;
+    // Если true, вместо state передаётся compact_state
+    bool compact = false;
+    CompactState compact_state;
+};
+
+// В header.message_type флаги сняты; способ подсчёта суммы - в checksum
 struct BinaryMessage {
     MessageHeader header;
     std::vector<uint8_t> payload;
+    ChecksumType checksum = ChecksumType::XOR;
 };
 
 // Основные функции протокола
-bool send_binary_ping(uint32_t session_id, uint32_t sequence, const std::string& payload);
-bool send_binary_pong(uint32_t session_id, uint32_t sequence, const GameState& game_state);
+// ack_sequence != 0 добавляется к букве или пакету букв (см. COMPACT_STATE)
+bool send_binary_ping(uint32_t session_id, uint32_t sequence, const std::string& payload,
+                      ChecksumType checksum = ChecksumType::XOR, uint32_t ack_sequence = 0);
+// GAME_START с уровнем сложности (Difficulty::ANY - как "start" в send_binary_ping)
+bool send_binary_start(uint32_t session_id, uint32_t sequence, uint8_t difficulty,
+                       ChecksumType checksum = ChecksumType::XOR);
+bool send_binary_pong(uint32_t session_id, uint32_t sequence, const GameState& game_state,
+                      ChecksumType checksum = ChecksumType::XOR);
+bool send_compact_pong(uint32_t session_id, uint32_t sequence, const CompactState& state,
+                       ChecksumType checksum = ChecksumType::XOR);
+bool send_binary_guess_batch(uint32_t session_id, uint32_t sequence, const std::string& letters,
+                             ChecksumType checksum = ChecksumType::XOR, uint32_t ack_sequence = 0);
+bool send_binary_batch_pong(uint32_t session_id, uint32_t sequence, const BatchResult& result,
+                            ChecksumType checksum = ChecksumType::XOR);
 BinaryMessage receive_binary_message(uint32_t session_id, int timeout_ms = 5000);
+// Принимает в существующий message: payload переиспользует свою память, и в
+// установившемся режиме приём не выделяет памяти; false - таймаут
+bool receive_binary_message(uint32_t session_id, BinaryMessage& message, int timeout_ms);
 
 // Вспомогательные функции
 GameState parse_pong_payload(const std::vector<uint8_t>& payload);
+bool is_compact_pong_payload(const std::vector<uint8_t>& payload);
+bool parse_compact_pong_payload(const std::vector<uint8_t>& payload, CompactState& state);
+// Возможности из GAME_START (0, если клиент их не передал)
+uint8_t parse_capabilities(const std::vector<uint8_t>& payload);
+// Уровень сложности из GAME_START (Difficulty::ANY, если не передан или неизвестен)
+uint8_t parse_difficulty(const std::vector<uint8_t>& payload);
+// sequence ответа, который клиент уже применил; 0 - не передан
+uint32_t parse_ack_sequence(const std::vector<uint8_t>& payload);
 std::string parse_ping_payload(const std::vector<uint8_t>& payload);
+// Буквы пакета; пустая строка, если payload - не корректный LETTER_BATCH
+std::string parse_batch_payload(const std::vector<uint8_t>& payload);
+BatchResult parse_batch_pong_payload(const std::vector<uint8_t>& payload);
+bool is_batch_payload(const std::vector<uint8_t>& payload);
+bool is_batch_pong_payload(const std::vector<uint8_t>& payload);
 bool validate_ping_payload(const std::string& payload);
 bool validate_session_id(uint32_t session_id);
+// Сумма для ответа на запрос: CRC32C, если клиент её уже использует или заявил в GAME_START
+ChecksumType reply_checksum(const BinaryMessage& request);
 
 } 
 
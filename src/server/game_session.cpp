@@ -1,53 +1,149 @@
 #include "game_session.hpp"
-
-GameSession::GameSession(uint32_t session_id) : session_id_(session_id), last_processed_sequence_(0) {}
+#include "../game/game_logic.hpp"
 
 bool GameSession::should_process_message(uint32_t sequence) {
-    return sequence > last_processed_sequence_;
+    return sequence > record_->sequence;
 }
 
 void GameSession::update_sequence(uint32_t sequence) {
-    last_processed_sequence_ = sequence;
+    record_->sequence = sequence;
 }
 
-void GameSession::start_new_game(const std::string& word) {
-    game_.start_new_game(word);
+uint8_t GameSession::apply_guess(char letter) {
+    int errors = record_->errors;
+    GameLogic::GuessResult result = GameLogic::apply_guess(word_mask_, record_->guessed_mask, errors,
+                                                           record_->max_errors, letter);
+    record_->errors = static_cast<uint8_t>(errors);
+    switch (result) {
+        case GameLogic::GuessResult::CORRECT: return Protocol::GuessOutcome::CORRECT;
+        case GameLogic::GuessResult::REPEATED: return Protocol::GuessOutcome::REPEATED;
+        default: return Protocol::GuessOutcome::WRONG;
+    }
 }
 
-Protocol::GameState GameSession::process_guess(char letter) {
-    bool correct = game_.guess_letter(letter);
-    
+Protocol::GameState GameSession::build_state(uint8_t outcome) const {
     Protocol::GameState game_state;
-    game_state.display_word = game_.get_display_word();
-    game_state.errors_left = static_cast<uint8_t>(game_.get_errors_left());
+    game_state.display_word = GameLogic::display_word(word_, record_->guessed_mask);
+    game_state.errors_left = static_cast<uint8_t>(get_errors_left());
     
-    if (game_.is_game_won()) {
+    if (is_game_won()) {
         game_state.status = Protocol::GameStatus::WIN;
-        game_state.additional_info = "You won! The word was: " + game_.get_secret_word();
-    } else if (game_.is_game_over()) {
+        game_state.additional_info = "You won! The word was: ";
+        game_state.additional_info += word_;
+    } else if (!is_game_active()) {
         game_state.status = Protocol::GameStatus::LOSE;
-        game_state.additional_info = "You lost! The word was: " + game_.get_secret_word();
+        game_state.additional_info = "You lost! The word was: ";
+        game_state.additional_info += word_;
     } else {
         game_state.status = Protocol::GameStatus::IN_PROGRESS;
-        if (!correct) {
-            game_state.additional_info = "Wrong! Wrong letters: " + game_.get_wrong_letters();
+        if (outcome != Protocol::GuessOutcome::CORRECT) {
+            game_state.additional_info = "Wrong! Wrong letters: " + GameLogic::mask_letters(record_->guessed_mask & ~word_mask_);
         } else {
-            game_state.additional_info = "Correct! Wrong letters: " + game_.get_wrong_letters();
+            game_state.additional_info = "Correct! Wrong letters: " + GameLogic::mask_letters(record_->guessed_mask & ~word_mask_);
         }
     }
     
     return game_state;
 }
 
+Protocol::GameState GameSession::process_guess(char letter, uint8_t* outcome) {
+    uint8_t result = apply_guess(letter);
+    if (outcome != nullptr) {
+        *outcome = result;
+    }
+    return build_state(result);
+}
+
+Protocol::BatchResult GameSession::process_guess_batch(const std::string& letters, uint32_t ack_sequence,
+                                                       uint32_t reply_sequence) {
+    Protocol::BatchResult result;
+    
+    // Первая буква обрабатывается всегда, как одиночный ход: так и для уже
+    // законченной игры клиент получает её итоговое состояние
+    for (size_t i = 0; i < letters.size(); ++i) {
+        if (i > 0 && !is_game_active()) {
+            break;
+        }
+        result.outcomes.push_back(apply_guess(letters[i]));
+    }
+    
+    uint8_t last_outcome = result.outcomes.empty() ? Protocol::GuessOutcome::WRONG : result.outcomes.back();
+    if (uses_compact_state()) {
+        result.compact = true;
+        result.compact_state = get_compact_state(get_state_code(last_outcome), ack_sequence, reply_sequence);
+    } else {
+        result.state = build_state(last_outcome);
+    }
+    
+    return result;
+}
+
 Protocol::GameState GameSession::get_current_state() {
     Protocol::GameState game_state;
-    game_state.display_word = game_.get_display_word();
-    game_state.errors_left = static_cast<uint8_t>(game_.get_errors_left());
+    game_state.display_word = GameLogic::display_word(word_, record_->guessed_mask);
+    game_state.errors_left = static_cast<uint8_t>(get_errors_left());
     game_state.status = Protocol::GameStatus::IN_PROGRESS;
     game_state.additional_info = "Game in progress";
     return game_state;
 }
 
-bool GameSession::is_game_active() const {
-    return !game_.is_game_over() && !game_.is_game_won();
+void GameSession::set_compact_state(bool enabled) {
+    if (enabled && word_.size() <= Protocol::MAX_COMPACT_WORD_LENGTH) {
+        record_->flags |= SessionRecord::COMPACT_STATE;
+    } else {
+        record_->flags &= ~SessionRecord::COMPACT_STATE;
+    }
+}
+
+uint8_t GameSession::get_state_code(uint8_t outcome) const {
+    if (is_game_won()) {
+        return Protocol::StateCode::WON;
+    }
+    if (!is_game_active()) {
+        return Protocol::StateCode::LOST;
+    }
+    switch (outcome) {
+        case Protocol::GuessOutcome::CORRECT: return Protocol::StateCode::CORRECT;
+        case Protocol::GuessOutcome::REPEATED: return Protocol::StateCode::REPEATED;
+        default: return Protocol::StateCode::WRONG;
+    }
+}
+
+Protocol::CompactState GameSession::get_compact_state(uint8_t code, uint32_t ack_sequence, uint32_t reply_sequence) {
+    Protocol::CompactState state;
+    uint64_t positions = GameLogic::revealed_positions(word_, record_->guessed_mask);
+    
+    state.word_length = static_cast<uint8_t>(word_.size());
+    state.errors_left = static_cast<uint8_t>(get_errors_left());
+    state.status = is_game_won() ? Protocol::GameStatus::WIN
+                 : !is_game_active() ? Protocol::GameStatus::LOSE : Protocol::GameStatus::IN_PROGRESS;
+    state.code = code;
+    state.guessed_mask = record_->guessed_mask;
+    state.wrong_mask = record_->guessed_mask & ~word_mask_;
+    
+    // Открытые позиции только прибавляются, поэтому дельта - разность масок
+    uint64_t base_positions = 0;
+    for (int i = 0; i < SessionRecord::REPLY_HISTORY && ack_sequence != 0; ++i) {
+        if (record_->reply_sequences[i] == ack_sequence) {
+            base_positions = GameLogic::revealed_positions(word_, record_->reply_guessed[i]);
+            state.base_sequence = ack_sequence;
+            break;
+        }
+    }
+    
+    state.changed_positions = positions & ~base_positions;
+    for (size_t i = 0; i < word_.size(); ++i) {
+        if ((state.changed_positions >> i) & 1) {
+            state.letters += word_[i];
+        }
+    }
+    if (!is_game_active()) {
+        state.secret_word = word_;
+    }
+    
+    record_->reply_sequences[record_->next_reply] = reply_sequence;
+    record_->reply_guessed[record_->next_reply] = record_->guessed_mask;
+    record_->next_reply = static_cast<uint8_t>((record_->next_reply + 1) % SessionRecord::REPLY_HISTORY);
+    
+    return state;
 }
@@ -3,25 +3,84 @@
 
 #include <cstdint>
 #include <string>
+#include <string_view>
 #include "../protocol/protocol.hpp"
 #include "../game/game_logic.hpp"
+#include "../game/word_dictionary.hpp"
 
+// Состояние сессии - запись фиксированного размера в одну строку кэша, без
+// указателей и выделений памяти: слово хранится номером в снимке словаря,
+// угаданные буквы - маской, открытые позиции и ошибки из них выводятся.
+// Записи живут в пуле SessionManager.
+struct SessionRecord {
+    // Открытые позиции на момент последних ответов - база для дельты COMPACT_STATE
+    static const int REPLY_HISTORY = 4;
+    
+    // Флаги
+    static const uint8_t COMPACT_STATE = 1;
+    static const uint8_t COMPLETED = 2;
+    
+    uint32_t session_id;        // 0 - запись свободна
+    uint32_t word_id;           // номер слова в словаре снимка
+    uint32_t words_slot;        // закреплённый снимок словаря в SessionManager
+    uint32_t sequence;          // последнее обработанное сообщение
+    uint32_t guessed_mask;      // бит 0 - 'a'
+    uint32_t last_active;       // тик последнего сообщения
+    uint32_t completed_at;      // тик конца игры
+    uint8_t errors;
+    uint8_t max_errors;
+    uint8_t flags;
+    uint8_t next_reply;
+    // Маска угаданных букв на момент ответа: открытые позиции по ней восстанавливаются
+    uint32_t reply_sequences[REPLY_HISTORY];
+    uint32_t reply_guessed[REPLY_HISTORY];
+};
+
+static_assert(sizeof(SessionRecord) == 64, "session record should stay in one cache line");
+
+// Игра сессии поверх её записи и слова из словаря. Лёгкий объект-ссылка:
+// его выдаёт SessionManager, и он действителен, пока сессия не удалена.
 class GameSession {
 private:
-    uint32_t session_id_;
-    GameLogic::HangmanGame game_;
-    uint32_t last_processed_sequence_;
+    SessionRecord* record_;
+    std::string_view word_;
+    uint32_t word_mask_;
+    
+    int get_errors_left() const { return record_->max_errors - record_->errors; }
+    Protocol::GameState build_state(uint8_t outcome) const;
     
 public:
-    GameSession(uint32_t session_id);
+    GameSession() : record_(nullptr), word_mask_(0) {}
+    GameSession(SessionRecord& record, std::string_view word, const GameLogic::WordInfo& info)
+        : record_(&record), word_(word), word_mask_(info.letter_mask) {}
+    
+    explicit operator bool() const { return record_ != nullptr; }
     
     bool should_process_message(uint32_t sequence);
     void update_sequence(uint32_t sequence);
-    void start_new_game(const std::string& word);
-    Protocol::GameState process_guess(char letter);
+    // Ход без построения текстового состояния; возвращает GuessOutcome
+    uint8_t apply_guess(char letter);
+    Protocol::GameState process_guess(char letter, uint8_t* outcome = nullptr);
+    // Буквы применяются по порядку; после конца игры остальные отбрасываются.
+    // В режиме COMPACT_STATE итог - get_compact_state(..., ack_sequence, reply_sequence).
+    Protocol::BatchResult process_guess_batch(const std::string& letters, uint32_t ack_sequence = 0,
+                                              uint32_t reply_sequence = 0);
     Protocol::GameState get_current_state();
-    bool is_game_active() const;
-    uint32_t get_session_id() const { return session_id_; }
+    bool is_game_active() const {
+        return !GameLogic::is_game_over(word_mask_, record_->guessed_mask, record_->errors, record_->max_errors);
+    }
+    bool is_game_won() const { return GameLogic::is_word_guessed(word_mask_, record_->guessed_mask); }
+    uint32_t get_session_id() const { return record_->session_id; }
+    std::string_view get_secret_word() const { return word_; }
+    
+    // Клиент заявил COMPACT_STATE; включается, только если слово помещается в маску позиций
+    void set_compact_state(bool enabled);
+    bool uses_compact_state() const { return (record_->flags & SessionRecord::COMPACT_STATE) != 0; }
+    // Состояние для ответа reply_sequence; если ack_sequence - один из последних
+    // ответов, передаются только позиции, открытые после него
+    Protocol::CompactState get_compact_state(uint8_t code, uint32_t ack_sequence, uint32_t reply_sequence);
+    // StateCode хода по его GuessOutcome (с учётом конца игры)
+    uint8_t get_state_code(uint8_t outcome) const;
 };
 
 #endif
@@ -2,49 +2,166 @@
 #include <string>
 #include <vector>
 #include <chrono>
+#include <thread>
+#include <memory>
+#include <cstdlib>
+#include <algorithm>
 #include "session_manager.hpp"
+#include "server_stats.hpp"
+#include "session_snapshot.hpp"
 #include "../protocol/protocol.hpp"
 #include "../game/game_logic.hpp"
+#include "../game/word_library.hpp"
+#include "../ipc/file_socket.hpp"
+#include "../log/logger.hpp"
 
-int main() {
-    std::cout << "Starting Hangman Server..." << std::endl;
+static void send_error(uint32_t session_id, uint32_t sequence, const std::string& info,
+                       Protocol::ChecksumType checksum) {
+    Protocol::GameState error_state;
+    error_state.display_word = "";
+    error_state.errors_left = 0;
+    error_state.status = Protocol::GameStatus::ERROR_STATE;
+    error_state.additional_info = info;
     
-    auto words = GameLogic::Dictionary::load_words("resources/words.txt");
-    if (words.empty()) {
-        std::cout << "Error: No words loaded!" << std::endl;
-        return 1;
+    Protocol::send_binary_pong(session_id, sequence, error_state, checksum);
+}
+
+// Пакет букв: один ответ с исходами всех применённых букв и итоговым состоянием
+static void handle_guess_batch(SessionManager& session_manager, GameSession& session,
+                               const Protocol::BinaryMessage& binary_message, WorkerStatsRecorder& stats) {
+    uint32_t session_id = binary_message.header.session_id;
+    uint32_t sequence = binary_message.header.sequence;
+    Protocol::ChecksumType checksum = Protocol::reply_checksum(binary_message);
+    
+    std::string letters = Protocol::parse_batch_payload(binary_message.payload);
+    if (letters.empty()) {
+        stats.message(IPC::StatsMessage::INVALID);
+        Log::warn("Invalid batch payload from session {}", session_id);
+        send_error(session_id, sequence, "Invalid message format", checksum);
+        return;
+    }
+    
+    stats.message(IPC::StatsMessage::BATCH);
+    if (!session) {
+        send_error(session_id, sequence, "No active game session. Send 'start' to begin.", checksum);
+        return;
     }
     
-    std::cout << "Loaded " << words.size() << " words" << std::endl;
+    if (!session.should_process_message(sequence)) {
+        stats.duplicate();
+        Log::debug("Duplicate message from session {}", session_id);
+        return;
+    }
+    session.update_sequence(sequence);
     
-    SessionManager session_manager;
-    auto last_cleanup_time = std::chrono::steady_clock::now();
-    uint32_t sequence_counter = 1;
+    Protocol::BatchResult result = session.process_guess_batch(
+        letters, Protocol::parse_ack_sequence(binary_message.payload), sequence);
+    Protocol::send_binary_batch_pong(session_id, sequence, result, checksum);
+    stats.guesses(result.outcomes.size());
+    
+    Log::debug("Processed batch of {}/{} letters for session {}", result.outcomes.size(), letters.size(), session_id);
+    
+    if (!session.is_game_active()) {
+        stats.game_finished(session.is_game_won());
+        session_manager.mark_session_completed(session_id);
+        Log::info("Game completed for session {}", session_id);
+    }
+}
+
+// Поток-обработчик: свои блоки файла, свой звонок и своя таблица сессий.
+// restored - сессии прошлого запуска; snapshots - запись снимков (nullptr - выключена)
+static void run_worker(uint32_t worker_id, uint32_t worker_count, GameLogic::WordLibrary& library,
+                       int idle_timeout_s, RestoredSessions restored, SnapshotWriter* snapshots,
+                       int snapshot_interval_s) {
+    typedef WorkerStatsRecorder::Clock Clock;
+    FileSocket::set_server_worker(worker_id, worker_count);
+    
+    SessionManager session_manager(idle_timeout_s);
+    WorkerStatsRecorder stats(worker_id);
+    for (const RestoredSession& session : restored.sessions) {
+        FileSocket::adopt_session(session.record.session_id, session.slot);
+        session_manager.restore_session(session.record, restored.words);
+    }
+    restored = RestoredSessions();
+    stats.active_sessions(session_manager.get_session_count());
+    
+    // Свой снимок словаря; новый подхватывается при следующем старте игры
+    std::shared_ptr<const GameLogic::WordSnapshot> words;
+    uint64_t words_version = 0;
+    Protocol::BinaryMessage binary_message;
+    
+    SnapshotPart snapshot_part;
+    uint32_t snapshot_cursor = 0;
+    bool snapshot_running = false;
+    auto snapshot_interval = std::chrono::seconds(snapshot_interval_s);
+    auto next_snapshot = Clock::now() + snapshot_interval;
     
     while (true) {
-        std::cout << "Active sessions: " << session_manager.get_session_count() << std::endl;
-        std::cout << "Waiting for messages..." << std::endl;
+        // Обслуживание - в начале прохода, чтобы его не пропускали continue ниже.
+        // Раз в тик колеса - только наступившие сроки, без обхода всех сессий
+        auto now = Clock::now();
+        if (session_manager.expire_sessions(now) > 0) {
+            stats.cleanup(Clock::now() - now);
+            stats.active_sessions(session_manager.get_session_count());
+        }
+        // Снимок копируется по блоку пула за проход; запись в файл - в потоке SnapshotWriter
+        if (snapshots != nullptr) {
+            if (!snapshot_running && now >= next_snapshot) {
+                snapshot_part.clear();
+                snapshot_part.records.reserve(session_manager.get_session_count());
+                snapshot_cursor = 0;
+                snapshot_running = true;
+            }
+            if (snapshot_running &&
+                session_manager.copy_records(snapshot_cursor, SessionManager::SLAB_RECORDS, snapshot_part)) {
+                snapshots->submit(worker_id, snapshot_part);
+                snapshot_running = false;
+                next_snapshot = now + snapshot_interval;
+            }
+        }
         
-        auto binary_message = Protocol::receive_binary_message(0, 5000);
+        // Ответ несёт sequence запроса: по нему клиент отбрасывает устаревшие ответы из очереди
+        auto wait_start = Clock::now();
+        int wait_ms = session_manager.wait_timeout_ms(wait_start, 5000);
+        if (snapshot_running) {
+            wait_ms = 0;
+        } else if (snapshots != nullptr) {
+            int64_t until_snapshot =
+                std::chrono::duration_cast<std::chrono::milliseconds>(next_snapshot - wait_start).count();
+            wait_ms = static_cast<int>(std::max<int64_t>(0, std::min<int64_t>(wait_ms, until_snapshot)));
+        }
+        Protocol::receive_binary_message(0, binary_message, wait_ms);
+        auto received = Clock::now();
+        stats.idle(received - wait_start);
         
         if (binary_message.header.session_id != 0) {
-            std::cout << "Processing message from session " << binary_message.header.session_id 
-                      << ", sequence " << binary_message.header.sequence 
-                      << ", type " << binary_message.header.message_type << std::endl;
+            WorkerStatsRecorder::BusyScope busy(stats, received);
+            Log::debug("Processing message from session {}, sequence {}, type {}", binary_message.header.session_id,
+                       binary_message.header.sequence, binary_message.header.message_type);
             
-            auto session = session_manager.get_session(binary_message.header.session_id);
+            auto session = session_manager.touch_session(binary_message.header.session_id, received);
+            // Ответ считается той же суммой, что и запрос (или CRC32C, если клиент заявил её в GAME_START)
+            auto checksum = Protocol::reply_checksum(binary_message);
             
-            if (binary_message.header.message_type == Protocol::MessageType::PING) {
+            if (binary_message.header.message_type != Protocol::MessageType::PING) {
+                stats.message(IPC::StatsMessage::INVALID);
+            } else {
                 if (!Protocol::validate_session_id(binary_message.header.session_id)) {
-                    std::cout << "Invalid session ID: " << binary_message.header.session_id << std::endl;
+                    stats.message(IPC::StatsMessage::INVALID);
+                    Log::warn("Invalid session ID: {}", binary_message.header.session_id);
+                    continue;
+                }
+                
+                if (Protocol::is_batch_payload(binary_message.payload)) {
+                    handle_guess_batch(session_manager, session, binary_message, stats);
                     continue;
                 }
                 
                 std::string payload = Protocol::parse_ping_payload(binary_message.payload);
                 
                 if (!Protocol::validate_ping_payload(payload)) {
-                    std::cout << "Invalid PING payload from session " << binary_message.header.session_id 
-                              << ": " << payload << std::endl;
+                    stats.message(IPC::StatsMessage::INVALID);
+                    Log::warn("Invalid PING payload from session {}: {}", binary_message.header.session_id, payload);
                     
                     Protocol::GameState error_state;
                     error_state.display_word = "";
@@ -53,13 +170,14 @@ int main() {
                     error_state.additional_info = "Invalid message format";
                     
                     Protocol::send_binary_pong(binary_message.header.session_id, 
-                                             sequence_counter++, error_state);
+                                             binary_message.header.sequence, error_state, checksum);
                     continue;
                 }
                 
                 if (payload == "start") {
-                    if (session && session->is_game_active()) {
-                        std::cout << "Game already in progress for session " << binary_message.header.session_id << std::endl;
+                    stats.message(IPC::StatsMessage::START);
+                    if (session && session.is_game_active()) {
+                        Log::info("Game already in progress for session {}", binary_message.header.session_id);
                         
                         Protocol::GameState error_state;
                         error_state.display_word = "";
@@ -68,44 +186,71 @@ int main() {
                         error_state.additional_info = "Game already in progress";
                         
                         Protocol::send_binary_pong(binary_message.header.session_id, 
-                                                 sequence_counter++, error_state);
+                                                 binary_message.header.sequence, error_state, checksum);
                         continue;
                     }
                     
-                    std::string word = GameLogic::Dictionary::get_random_word(words);
-                    session = session_manager.create_session(binary_message.header.session_id, word);
+                    uint8_t difficulty = Protocol::parse_difficulty(binary_message.payload);
+                    library.refresh(words, words_version);
+                    session = session_manager.create_session(binary_message.header.session_id, words,
+                                                             words->selector->pick_index(difficulty));
+                    stats.active_sessions(session_manager.get_session_count());
                     
-                    std::cout << "Started new game with word: " << word << std::endl;
+                    Log::info("Started new game with word: {} (difficulty {})", session.get_secret_word(), difficulty);
                     
-                    auto initial_state = session->get_current_state();
-                    initial_state.additional_info = "Game started! Guess a letter.";
+                    uint8_t capabilities = Protocol::parse_capabilities(binary_message.payload);
+                    session.set_compact_state((capabilities & Protocol::Capability::COMPACT_STATE) != 0);
                     
-                    Protocol::send_binary_pong(binary_message.header.session_id, 
-                                             sequence_counter++, initial_state);
+                    if (session.uses_compact_state()) {
+                        Protocol::send_compact_pong(binary_message.header.session_id, binary_message.header.sequence,
+                                                    session.get_compact_state(Protocol::StateCode::GAME_STARTED, 0,
+                                                                               binary_message.header.sequence),
+                                                    checksum);
+                    } else {
+                        auto initial_state = session.get_current_state();
+                        initial_state.additional_info = "Game started! Guess a letter.";
+                        
+                        Protocol::send_binary_pong(binary_message.header.session_id, 
+                                                 binary_message.header.sequence, initial_state, checksum);
+                    }
                     
                 } else if (payload.length() == 1 && session) {
-                    if (!session->should_process_message(binary_message.header.sequence)) {
-                        std::cout << "Duplicate message from session " 
-                                  << binary_message.header.session_id << std::endl;
+                    stats.message(IPC::StatsMessage::GUESS);
+                    if (!session.should_process_message(binary_message.header.sequence)) {
+                        stats.duplicate();
+                        Log::debug("Duplicate message from session {}", binary_message.header.session_id);
                         continue;
                     }
                     
-                    session->update_sequence(binary_message.header.sequence);
+                    session.update_sequence(binary_message.header.sequence);
                     
                     char letter = payload[0];
-                    auto game_state = session->process_guess(letter);
+                    stats.guesses(1);
                     
-                    Protocol::send_binary_pong(binary_message.header.session_id, 
-                                             sequence_counter++, game_state);
+                    if (session.uses_compact_state()) {
+                        uint8_t outcome = session.apply_guess(letter);
+                        uint32_t ack_sequence = Protocol::parse_ack_sequence(binary_message.payload);
+                        Protocol::send_compact_pong(binary_message.header.session_id, binary_message.header.sequence,
+                                                    session.get_compact_state(session.get_state_code(outcome),
+                                                                               ack_sequence,
+                                                                               binary_message.header.sequence),
+                                                    checksum);
+                    } else {
+                        auto game_state = session.process_guess(letter);
+                        
+                        Protocol::send_binary_pong(binary_message.header.session_id, 
+                                                 binary_message.header.sequence, game_state, checksum);
+                    }
                     
-                    std::cout << "Processed guess '" << letter << "' for session " 
-                              << binary_message.header.session_id << std::endl;
+                    Log::debug("Processed guess '{}' for session {}", letter, binary_message.header.session_id);
                     
-                    if (!session->is_game_active()) {
+                    if (!session.is_game_active()) {
+                        stats.game_finished(session.is_game_won());
                         session_manager.mark_session_completed(binary_message.header.session_id);
-                        std::cout << "Game completed for session " << binary_message.header.session_id << std::endl;
+                        Log::info("Game completed for session {}", binary_message.header.session_id);
                     }
                 } else if (!session) {
+                    stats.message(IPC::StatsMessage::GUESS);
                     Protocol::GameState error_state;
                     error_state.display_word = "";
                     error_state.errors_left = 0;
@@ -113,17 +258,105 @@ int main() {
                     error_state.additional_info = "No active game session. Send 'start' to begin.";
                     
                     Protocol::send_binary_pong(binary_message.header.session_id, 
-                                             sequence_counter++, error_state);
+                                             binary_message.header.sequence, error_state, checksum);
                 }
             }
         }
-        
-        auto now = std::chrono::steady_clock::now();
-        if (std::chrono::duration_cast<std::chrono::seconds>(now - last_cleanup_time).count() >= 10) {
-            session_manager.cleanup_inactive_sessions();
-            last_cleanup_time = now;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "Starting Hangman Server..." << std::endl;
+    
+    uint32_t worker_count = 1;
+    std::string dictionary_file = "resources/words.dict";
+    std::string text_file = "resources/words.txt";
+    int watch_interval_ms = 1000;
+    int idle_timeout_s = SessionManager::DEFAULT_IDLE_TIMEOUT_S;
+    std::string snapshot_file = "hangman_sessions.snap";
+    int snapshot_interval_s = 5;
+    Log::Level log_level = Log::Level::INFO;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--workers" && i + 1 < argc) {
+            worker_count = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--dict" && i + 1 < argc) {
+            dictionary_file = argv[++i];
+        } else if (arg == "--words" && i + 1 < argc) {
+            text_file = argv[++i];
+        } else if (arg == "--watch-interval" && i + 1 < argc) {
+            watch_interval_ms = std::atoi(argv[++i]);
+        } else if (arg == "--idle-timeout" && i + 1 < argc) {
+            idle_timeout_s = std::atoi(argv[++i]);
+        } else if (arg == "--snapshot" && i + 1 < argc) {
+            snapshot_file = argv[++i];
+        } else if (arg == "--snapshot-interval" && i + 1 < argc) {
+            snapshot_interval_s = std::atoi(argv[++i]);
+        } else if (arg == "--log-level" && i + 1 < argc && Log::parse_level(argv[i + 1], log_level)) {
+            ++i;
+        } else {
+            std::cout << "Usage: " << argv[0] << " [--workers N] [--dict words.dict] [--words words.txt]"
+                      << " [--watch-interval MS (0 - off)] [--idle-timeout S] [--log-level debug|info|warn|error|off]"
+                      << " [--snapshot FILE] [--snapshot-interval S (0 - off)]" << std::endl;
+            return 1;
         }
     }
+    if (worker_count == 0 || worker_count > IPC::MAX_SERVER_WORKERS) {
+        std::cout << "Error: worker count must be 1.." << IPC::MAX_SERVER_WORKERS << std::endl;
+        return 1;
+    }
+    if (idle_timeout_s <= 0) {
+        std::cout << "Error: idle timeout must be positive" << std::endl;
+        return 1;
+    }
+    // Журнал пишется фоновым потоком; сообщения о каждом ходе - на уровне debug
+    Log::set_level(log_level);
+    
+    // Скомпилированный словарь отображается в память; без него - разбор текстового списка.
+    // Изменённые файлы словаря подхватываются на лету, без остановки игр.
+    auto load_start = std::chrono::steady_clock::now();
+    GameLogic::WordLibrary library(dictionary_file, text_file);
+    if (!library.reload()) {
+        Log::error("No words loaded!");
+        return 1;
+    }
+    auto load_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - load_start);
+    
+    std::shared_ptr<const GameLogic::WordSnapshot> words = library.snapshot();
+    const GameLogic::WordSelector& selector = *words->selector;
+    Log::info("Loaded {} words from {} in {} ms", words->dictionary.size(), words->source, load_time.count());
+    Log::info("Difficulty tiers: {} easy, {} medium, {} hard", selector.tier_size(Protocol::Difficulty::EASY),
+              selector.tier_size(Protocol::Difficulty::MEDIUM), selector.tier_size(Protocol::Difficulty::HARD));
+    words.reset();
+    
+    library.start_watching(watch_interval_ms);
+    
+    if (!FileSocket::start_server(worker_count)) {
+        Log::error("Cannot prepare socket file!");
+        return 1;
+    }
+    
+    Log::info("Worker threads: {}", worker_count);
+    
+    // Игры прошлого запуска продолжаются, если их клиенты ещё держат слоты
+    std::vector<RestoredSessions> restored(worker_count);
+    std::unique_ptr<SnapshotWriter> snapshots;
+    if (snapshot_interval_s > 0) {
+        load_snapshot(snapshot_file, library.snapshot(), worker_count, restored);
+        snapshots.reset(new SnapshotWriter(snapshot_file, worker_count));
+    }
+    
+    std::vector<std::thread> workers;
+    for (uint32_t worker_id = 1; worker_id < worker_count; ++worker_id) {
+        workers.emplace_back(run_worker, worker_id, worker_count, std::ref(library), idle_timeout_s,
+                             std::move(restored[worker_id]), snapshots.get(), snapshot_interval_s);
+    }
+    run_worker(0, worker_count, library, idle_timeout_s, std::move(restored[0]), snapshots.get(),
+               snapshot_interval_s);
+    
+    for (auto& worker : workers) {
+        worker.join();
+    }
     
     return 0;
 }
@@ -0,0 +1,80 @@
+#include "server_stats.hpp"
+#include "../ipc/mapped_file.hpp"
+
+static uint64_t to_ns(WorkerStatsRecorder::Clock::duration elapsed) {
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    return ns > 0 ? static_cast<uint64_t>(ns) : 0;
+}
+
+WorkerStatsRecorder::WorkerStatsRecorder(uint32_t worker_id) : stats_(nullptr) {
+    IPC::StatsRegion* region = FileSocket::get_stats_region();
+    if (region != nullptr && worker_id < static_cast<uint32_t>(IPC::MAX_SERVER_WORKERS)) {
+        stats_ = &region->workers[worker_id];
+    }
+}
+
+void WorkerStatsRecorder::add(std::atomic<uint64_t>& counter, uint64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+void WorkerStatsRecorder::message(int kind) {
+    if (stats_ != nullptr && kind >= 0 && kind < IPC::StatsMessage::KINDS) {
+        add(stats_->messages[kind], 1);
+    }
+}
+
+void WorkerStatsRecorder::duplicate() {
+    if (stats_ != nullptr) {
+        add(stats_->duplicates, 1);
+    }
+}
+
+void WorkerStatsRecorder::guesses(uint64_t count) {
+    if (stats_ != nullptr) {
+        add(stats_->guesses, count);
+    }
+}
+
+void WorkerStatsRecorder::game_finished(bool won) {
+    if (stats_ != nullptr) {
+        add(won ? stats_->games_won : stats_->games_lost, 1);
+    }
+}
+
+void WorkerStatsRecorder::active_sessions(size_t count) {
+    if (stats_ != nullptr) {
+        stats_->active_sessions.store(count, std::memory_order_relaxed);
+    }
+}
+
+void WorkerStatsRecorder::idle(Clock::duration elapsed) {
+    if (stats_ != nullptr) {
+        add(stats_->idle_ns, to_ns(elapsed));
+    }
+}
+
+void WorkerStatsRecorder::busy(Clock::duration elapsed) {
+    if (stats_ == nullptr) {
+        return;
+    }
+    uint64_t ns = to_ns(elapsed);
+    add(stats_->busy_ns, ns);
+    
+    int bucket = 0;
+    while (bucket < IPC::STATS_LATENCY_BUCKETS - 1 && (ns >> (bucket + 10)) != 0) {
+        ++bucket;
+    }
+    add(stats_->latency[bucket], 1);
+}
+
+void WorkerStatsRecorder::cleanup(Clock::duration elapsed) {
+    if (stats_ == nullptr) {
+        return;
+    }
+    uint64_t ns = to_ns(elapsed);
+    add(stats_->cleanups, 1);
+    add(stats_->cleanup_ns, ns);
+    if (ns > stats_->cleanup_max_ns.load(std::memory_order_relaxed)) {
+        stats_->cleanup_max_ns.store(ns, std::memory_order_relaxed);
+    }
+}
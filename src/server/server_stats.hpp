@@ -0,0 +1,49 @@
+#ifndef SERVER_STATS_HPP
+#define SERVER_STATS_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include "../ipc/ipc_common.hpp"
+
+// Счётчики потока-обработчика в области статистики файла-сокета (IPC::StatsRegion).
+// Поток - единственный писатель своих WorkerStats, поэтому увеличение - обычные
+// load + store без атомарных RMW, а hangman-top читает их, не мешая серверу.
+class WorkerStatsRecorder {
+public:
+    typedef std::chrono::steady_clock Clock;
+    
+private:
+    IPC::WorkerStats* stats_;  // nullptr - файл не отображён, счёт не ведётся
+    
+    static void add(std::atomic<uint64_t>& counter, uint64_t value);
+    
+public:
+    explicit WorkerStatsRecorder(uint32_t worker_id);
+    
+    void message(int kind);
+    void duplicate();
+    void guesses(uint64_t count);
+    void game_finished(bool won);
+    void active_sessions(size_t count);
+    void idle(Clock::duration elapsed);
+    // Обработка одного сообщения: busy_ns и гистограмма задержки
+    void busy(Clock::duration elapsed);
+    void cleanup(Clock::duration elapsed);
+    
+    // Время от получения сообщения до выхода из области видимости, включая continue
+    class BusyScope {
+    private:
+        WorkerStatsRecorder& recorder_;
+        Clock::time_point start_;
+        
+    public:
+        BusyScope(WorkerStatsRecorder& recorder, Clock::time_point start) : recorder_(recorder), start_(start) {}
+        ~BusyScope() { recorder_.busy(Clock::now() - start_); }
+        
+        BusyScope(const BusyScope&) = delete;
+        BusyScope& operator=(const BusyScope&) = delete;
+    };
+};
+
+#endif
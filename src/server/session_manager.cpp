@@ -1,58 +1,315 @@
 #include "session_manager.hpp"
-#include <iostream>
+#include "../ipc/file_socket.hpp"
+#include "../log/logger.hpp"
+#include <cstring>
 
-GameSession* SessionManager::get_session(uint32_t session_id) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = sessions_.find(session_id);
-    if (it != sessions_.end()) {
-        return it->second.get();
+static const size_t INITIAL_INDEX_SIZE = 1024;
+
+SessionManager::SessionManager(int idle_timeout_s)
+    : record_count_(0),
+      index_(INITIAL_INDEX_SIZE, NO_RECORD),
+      session_count_(0),
+      last_pinned_(0),
+      epoch_(Clock::now()),
+      idle_timeout_ticks_(static_cast<uint64_t>(idle_timeout_s > 0 ? idle_timeout_s : DEFAULT_IDLE_TIMEOUT_S) *
+                          1000 / TICK_MS),
+      timers_(0) {}
+
+// ==================== Индекс ====================
+
+// Номера сессий выбирают клиенты, поэтому ключ перемешивается
+size_t SessionManager::index_slot(uint32_t session_id) const {
+    uint32_t hash = session_id * 0x9E3779B1u;
+    hash ^= hash >> 16;
+    return hash & (index_.size() - 1);
+}
+
+size_t SessionManager::find_slot(uint32_t session_id) const {
+    size_t mask = index_.size() - 1;
+    size_t slot = index_slot(session_id);
+    while (index_[slot] != NO_RECORD && record(index_[slot]).session_id != session_id) {
+        slot = (slot + 1) & mask;
     }
-    return nullptr;
+    return slot;
 }
 
-GameSession* SessionManager::create_session(uint32_t session_id, const std::string& word) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    std::cout << "Creating session: " << session_id << " with word: " << word << std::endl;
+uint32_t SessionManager::find_record(uint32_t session_id) const {
+    return index_[find_slot(session_id)];
+}
+
+void SessionManager::grow_index() {
+    std::vector<uint32_t> old_index(index_.size() * 2, NO_RECORD);
+    old_index.swap(index_);
+    for (uint32_t number : old_index) {
+        if (number != NO_RECORD) {
+            index_[find_slot(record(number).session_id)] = number;
+        }
+    }
+}
+
+// Удаление без надгробий: следующие записи цепочки сдвигаются в дыру, если
+// их исходная ячейка не лежит между дырой и ними
+void SessionManager::index_erase(size_t slot) {
+    size_t mask = index_.size() - 1;
+    size_t hole = slot;
+    for (size_t next = (hole + 1) & mask; index_[next] != NO_RECORD; next = (next + 1) & mask) {
+        size_t home = index_slot(record(index_[next]).session_id);
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            index_[hole] = index_[next];
+            hole = next;
+        }
+    }
+    index_[hole] = NO_RECORD;
+}
+
+// ==================== Пул записей и снимки словаря ====================
+
+uint32_t SessionManager::allocate_record() {
+    if (!free_records_.empty()) {
+        uint32_t number = free_records_.back();
+        free_records_.pop_back();
+        return number;
+    }
+    if (record_count_ == slabs_.size() * SLAB_RECORDS) {
+        slabs_.push_back(std::make_unique<SessionRecord[]>(SLAB_RECORDS));
+    }
+    return record_count_++;
+}
+
+uint32_t SessionManager::pin_words(const std::shared_ptr<const GameLogic::WordSnapshot>& words) {
+    // Обычно это тот же снимок, что и у предыдущей игры. Освобождённый слот
+    // (sessions == 0) снимок уже отпустил, поэтому с words не совпадает
+    if (last_pinned_ >= pinned_.size() || pinned_[last_pinned_].words != words) {
+        uint32_t slot = 0;
+        while (slot < pinned_.size() && pinned_[slot].words != words) {
+            ++slot;
+        }
+        if (slot == pinned_.size()) {
+            slot = 0;
+            while (slot < pinned_.size() && pinned_[slot].sessions != 0) {
+                ++slot;
+            }
+            if (slot == pinned_.size()) {
+                pinned_.push_back(PinnedWords{words, 0});
+            } else {
+                pinned_[slot].words = words;
+            }
+        }
+        last_pinned_ = slot;
+    }
+    ++pinned_[last_pinned_].sessions;
+    return last_pinned_;
+}
+
+void SessionManager::unpin_words(uint32_t slot) {
+    if (--pinned_[slot].sessions == 0) {
+        pinned_[slot].words.reset();
+    }
+}
+
+GameSession SessionManager::view(uint32_t number) {
+    SessionRecord& session = record(number);
+    const GameLogic::WordDictionary& dictionary = pinned_[session.words_slot].words->dictionary;
+    return GameSession(session, dictionary.word(session.word_id), dictionary.info(session.word_id));
+}
+
+// ==================== Сессии ====================
+
+// Тики по TICK_MS хранятся в записях как uint32_t - это 13 лет работы
+uint64_t SessionManager::to_tick(Clock::time_point time) const {
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(time - epoch_).count();
+    return elapsed > 0 ? static_cast<uint64_t>(elapsed) / TICK_MS : 0;
+}
+
+uint64_t SessionManager::deadline(const SessionRecord& session) const {
+    uint64_t idle = session.last_active + idle_timeout_ticks_;
+    if ((session.flags & SessionRecord::COMPLETED) != 0) {
+        uint64_t completed = session.completed_at + static_cast<uint64_t>(COMPLETED_TIMEOUT_S) * 1000 / TICK_MS;
+        return completed < idle ? completed : idle;
+    }
+    return idle;
+}
+
+GameSession SessionManager::get_session(uint32_t session_id) {
+    uint32_t number = find_record(session_id);
+    return number != NO_RECORD ? view(number) : GameSession();
+}
+
+GameSession SessionManager::touch_session(uint32_t session_id, Clock::time_point now) {
+    uint32_t number = find_record(session_id);
+    if (number == NO_RECORD) {
+        return GameSession();
+    }
+    record(number).last_active = static_cast<uint32_t>(to_tick(now));
+    return view(number);
+}
+
+uint32_t SessionManager::place_session(uint32_t session_id) {
+    size_t slot = find_slot(session_id);
+    uint32_t number = index_[slot];
+    if (number != NO_RECORD) {
+        unpin_words(record(number).words_slot);
+        return number;
+    }
     
-    auto session = std::make_unique<GameSession>(session_id);
-    session->start_new_game(word);
+    if ((session_count_ + 1) * 2 > index_.size()) {
+        grow_index();
+        slot = find_slot(session_id);
+    }
+    number = allocate_record();
+    index_[slot] = number;
+    ++session_count_;
+    return number;
+}
+
+GameSession SessionManager::create_session(uint32_t session_id,
+                                           const std::shared_ptr<const GameLogic::WordSnapshot>& words,
+                                           uint32_t word_id) {
+    Log::debug("Creating session: {} with word: {}", session_id, words->dictionary.word(word_id));
     
-    GameSession* result = session.get();
-    sessions_[session_id] = std::move(session);
-    session_end_times_.erase(session_id);
+    uint32_t number = place_session(session_id);
+    SessionRecord& session = record(number);
+    std::memset(&session, 0, sizeof(session));
+    session.session_id = session_id;
+    session.word_id = word_id;
+    session.words_slot = pin_words(words);
+    session.max_errors = 6;
+    session.last_active = static_cast<uint32_t>(to_tick(Clock::now()));
+    // Стоящий таймер (например, на срок завершённой игры) просто сработает
+    // раньше и будет переставлен
+    if (!timers_.is_scheduled(number)) {
+        timers_.schedule(number, deadline(session));
+    }
     
-    return result;
+    return view(number);
+}
+
+void SessionManager::reserve(size_t sessions) {
+    while ((sessions + 1) * 2 > index_.size()) {
+        grow_index();
+    }
+    while (slabs_.size() * SLAB_RECORDS < sessions) {
+        slabs_.push_back(std::make_unique<SessionRecord[]>(SLAB_RECORDS));
+    }
+}
+
+void SessionManager::restore_session(const SessionRecord& saved,
+                                     const std::shared_ptr<const GameLogic::WordSnapshot>& words) {
+    uint32_t number = place_session(saved.session_id);
+    SessionRecord& session = record(number);
+    session = saved;
+    session.words_slot = pin_words(words);
+    session.last_active = static_cast<uint32_t>(to_tick(Clock::now()));
+    session.completed_at = session.last_active;
+    timers_.schedule(number, deadline(session));
 }
 
 void SessionManager::mark_session_completed(uint32_t session_id) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    session_end_times_[session_id] = std::chrono::steady_clock::now();
+    uint32_t number = find_record(session_id);
+    if (number == NO_RECORD) {
+        return;
+    }
+    
+    SessionRecord& session = record(number);
+    session.flags |= SessionRecord::COMPLETED;
+    session.completed_at = static_cast<uint32_t>(to_tick(Clock::now()));
+    // Срок только приближается - таймер переставляется сразу
+    if (!timers_.is_scheduled(number) || deadline(session) < timers_.expires(number)) {
+        timers_.schedule(number, deadline(session));
+    }
+}
+
+void SessionManager::erase(uint32_t session_id) {
+    size_t slot = find_slot(session_id);
+    uint32_t number = index_[slot];
+    if (number != NO_RECORD) {
+        timers_.cancel(number);
+        unpin_words(record(number).words_slot);
+        index_erase(slot);
+        record(number).session_id = 0;
+        free_records_.push_back(number);
+        --session_count_;
+    }
+    FileSocket::release_session(session_id);
 }
 
 void SessionManager::remove_session(uint32_t session_id) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    sessions_.erase(session_id);
-    session_end_times_.erase(session_id);
+    erase(session_id);
 }
 
-void SessionManager::cleanup_inactive_sessions() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto now = std::chrono::steady_clock::now();
-    auto timeout = std::chrono::seconds(30);
+size_t SessionManager::expire_sessions(Clock::time_point now) {
+    uint64_t tick = to_tick(now);
+    if (tick <= timers_.now()) {
+        return 0;
+    }
+    
+    expired_.clear();
+    timers_.advance(tick, expired_);
     
-    for (auto it = session_end_times_.begin(); it != session_end_times_.end(); ) {
-        if (now - it->second > timeout) {
-            std::cout << "Cleaning up inactive session: " << it->first << std::endl;
-            sessions_.erase(it->first);
-            it = session_end_times_.erase(it);
-        } else {
-            ++it;
+    size_t removed = 0;
+    for (uint32_t number : expired_) {
+        SessionRecord& session = record(number);
+        if (session.session_id == 0) {
+            continue;
+        }
+        
+        uint64_t due = deadline(session);
+        if (due > tick) {
+            // Сессия была активна после постановки таймера - ждём до нового срока
+            timers_.schedule(number, due);
+            continue;
+        }
+        
+        Log::info("Cleaning up {} session: {}", (session.flags & SessionRecord::COMPLETED) != 0 ? "completed" : "idle",
+                  session.session_id);
+        erase(session.session_id);
+        ++removed;
+    }
+    return removed;
+}
+
+int SessionManager::wait_timeout_ms(Clock::time_point now, int max_ms) const {
+    uint64_t ticks = timers_.ticks_until_next();
+    if (ticks == 0) {
+        return max_ms;
+    }
+    int64_t due_ms = static_cast<int64_t>((timers_.now() + ticks) * TICK_MS);
+    int64_t elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - epoch_).count();
+    if (due_ms <= elapsed_ms) {
+        return 0;
+    }
+    return due_ms - elapsed_ms < max_ms ? static_cast<int>(due_ms - elapsed_ms) : max_ms;
+}
+
+bool SessionManager::copy_records(uint32_t& cursor, uint32_t max_records, SnapshotPart& part) const {
+    uint32_t end = record_count_ - cursor > max_records ? cursor + max_records : record_count_;
+    for (; cursor < end; ++cursor) {
+        const SessionRecord& session = record(cursor);
+        if (session.session_id == 0) {
+            continue;
         }
+        
+        // Снимков словаря у живых сессий единицы - поиск линейный
+        const GameLogic::WordSnapshot& words = *pinned_[session.words_slot].words;
+        uint32_t slot = 0;
+        while (slot < part.dictionaries.size() && part.dictionaries[slot].fingerprint != words.fingerprint) {
+            ++slot;
+        }
+        if (slot == part.dictionaries.size()) {
+            part.dictionaries.push_back(SnapshotDictionary{words.fingerprint, words.dictionary.size()});
+        }
+        part.records.push_back(session);
+        part.records.back().words_slot = slot;
     }
+    return cursor >= record_count_;
 }
 
 size_t SessionManager::get_session_count() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return sessions_.size();
+    return session_count_;
+}
+
+size_t SessionManager::memory_bytes() const {
+    return slabs_.size() * SLAB_RECORDS * sizeof(SessionRecord) + index_.capacity() * sizeof(uint32_t) +
+           free_records_.capacity() * sizeof(uint32_t) + pinned_.capacity() * sizeof(PinnedWords) +
+           timers_.memory_bytes();
 }
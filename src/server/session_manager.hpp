@@ -3,26 +3,106 @@
 
 #include <cstdint>
 #include <memory>
-#include <unordered_map>
-#include <mutex>
+#include <vector>
 #include <chrono>
 #include "game_session.hpp"
+#include "timer_wheel.hpp"
+#include "session_snapshot.hpp"
+#include "../game/word_library.hpp"
 
+// Таблица сессий одного потока сервера: каждый поток держит свою и видит
+// только сессии своих блоков файла, поэтому блокировки не нужны.
+// Сессия удаляется через COMPLETED_TIMEOUT после конца игры или через
+// idle_timeout без сообщений (брошенные клиенты). Сроки ведёт колесо таймеров:
+// сообщение только запоминает время, а таймер, сработавший раньше настоящего
+// срока, переставляется - так каждый запрос не двигает узлы в колесе.
+//
+// Записи сессий (64 байта) лежат в пуле из блоков по SLAB_RECORDS - блоки не
+// перемещаются, освобождённые записи используются снова. Поиск по session_id -
+// таблица с открытой адресацией и линейным пробированием, хранящая номера
+// записей. Снимки словаря, на слова которых ссылаются сессии, закреплены,
+// пока их последняя сессия не удалена.
 class SessionManager {
+public:
+    typedef std::chrono::steady_clock Clock;
+    static constexpr int TICK_MS = 100;
+    static constexpr int COMPLETED_TIMEOUT_S = 30;
+    static constexpr int DEFAULT_IDLE_TIMEOUT_S = 300;
+    static constexpr uint32_t SLAB_RECORDS = 4096;
+    
 private:
-    std::unordered_map<uint32_t, std::unique_ptr<GameSession>> sessions_;
-    mutable std::mutex mutex_;
-    std::unordered_map<uint32_t, std::chrono::steady_clock::time_point> session_end_times_;
+    static constexpr uint32_t NO_RECORD = UINT32_MAX;
+    
+    struct PinnedWords {
+        std::shared_ptr<const GameLogic::WordSnapshot> words;
+        uint32_t sessions;
+    };
+    
+    std::vector<std::unique_ptr<SessionRecord[]>> slabs_;
+    uint32_t record_count_;             // записей во всех блоках, включая свободные
+    std::vector<uint32_t> free_records_;
+    std::vector<uint32_t> index_;       // номера записей, NO_RECORD - пусто; размер - степень двойки
+    size_t session_count_;
+    std::vector<PinnedWords> pinned_;
+    uint32_t last_pinned_;
+    Clock::time_point epoch_;
+    uint64_t idle_timeout_ticks_;
+    TimerWheel timers_;                 // id таймера - номер записи
+    std::vector<uint32_t> expired_;
+    
+    SessionRecord& record(uint32_t number) {
+        return slabs_[number / SLAB_RECORDS][number % SLAB_RECORDS];
+    }
+    const SessionRecord& record(uint32_t number) const {
+        return slabs_[number / SLAB_RECORDS][number % SLAB_RECORDS];
+    }
+    GameSession view(uint32_t number);
+    // Запись сессии: найденная или новая, уже в индексе
+    uint32_t place_session(uint32_t session_id);
+    
+    size_t index_slot(uint32_t session_id) const;
+    // Позиция session_id в index_ или позиция пустой ячейки, куда его вставлять
+    size_t find_slot(uint32_t session_id) const;
+    uint32_t find_record(uint32_t session_id) const;
+    void grow_index();
+    void index_erase(size_t slot);
+    
+    uint32_t allocate_record();
+    uint32_t pin_words(const std::shared_ptr<const GameLogic::WordSnapshot>& words);
+    void unpin_words(uint32_t slot);
+    
+    uint64_t to_tick(Clock::time_point time) const;
+    uint64_t deadline(const SessionRecord& record) const;
+    void erase(uint32_t session_id);
 
 public:
-    SessionManager() = default;
+    explicit SessionManager(int idle_timeout_s = DEFAULT_IDLE_TIMEOUT_S);
     
-    GameSession* get_session(uint32_t session_id);
-    GameSession* create_session(uint32_t session_id, const std::string& word);
+    // Пустой GameSession - сессии нет
+    GameSession get_session(uint32_t session_id);
+    // Как get_session, но продлевает срок простоя сессии
+    GameSession touch_session(uint32_t session_id, Clock::time_point now);
+    // Новая игра со словом word_id из снимка words; прежняя игра сессии заменяется
+    GameSession create_session(uint32_t session_id, const std::shared_ptr<const GameLogic::WordSnapshot>& words,
+                               uint32_t word_id);
+    // Готовит пул и индекс под sessions сессий (перед восстановлением снимка)
+    void reserve(size_t sessions);
+    // Сессия из снимка: игра продолжается с того же хода, сроки отсчитываются заново
+    void restore_session(const SessionRecord& saved, const std::shared_ptr<const GameLogic::WordSnapshot>& words);
     void mark_session_completed(uint32_t session_id);
     void remove_session(uint32_t session_id);
-    void cleanup_inactive_sessions();
+    // Удаляет сессии с истёкшим сроком; обрабатываются только наступившие
+    // ячейки колеса. Возвращает число удалённых сессий
+    size_t expire_sessions(Clock::time_point now);
+    // Сколько ждать сообщений, чтобы не проспать ближайший срок (не больше max_ms)
+    int wait_timeout_ms(Clock::time_point now, int max_ms) const;
+    // Копирует в part живые записи с номерами от cursor, не больше max_records за
+    // вызов, и сдвигает cursor; true - пул пройден до конца. Снимок снимается
+    // по частям между сообщениями, чтобы не задерживать их обработку
+    bool copy_records(uint32_t& cursor, uint32_t max_records, SnapshotPart& part) const;
     size_t get_session_count() const;
+    // Память пула, индекса и колеса таймеров
+    size_t memory_bytes() const;
 };
 
 #endif
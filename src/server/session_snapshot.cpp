@@ -0,0 +1,320 @@
+#include "session_snapshot.hpp"
+#include "../ipc/file_socket.hpp"
+#include "../log/logger.hpp"
+#include "../protocol/checksum.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static_assert(sizeof(SnapshotFileHeader) == 32, "snapshot header layout");
+static_assert(sizeof(SnapshotDictionary) == 16, "snapshot dictionary layout");
+
+// Записей за один вызов write: перед записью в них переписывается words_slot
+static const size_t WRITE_BATCH_RECORDS = 4096;
+
+typedef std::chrono::steady_clock Clock;
+
+// Файл для последовательной записи с подсчётом CRC32C записанного
+class SnapshotFile {
+private:
+#ifdef _WIN32
+    HANDLE file_;
+#else
+    int file_;
+#endif
+    uint32_t checksum_;
+    bool ok_;
+
+public:
+    explicit SnapshotFile(const std::string& filename) : checksum_(0), ok_(true) {
+#ifdef _WIN32
+        file_ = CreateFileA(filename.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+        ok_ = file_ != INVALID_HANDLE_VALUE;
+#else
+        file_ = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        ok_ = file_ >= 0;
+#endif
+    }
+
+    ~SnapshotFile() {
+#ifdef _WIN32
+        if (file_ != INVALID_HANDLE_VALUE) {
+            CloseHandle(file_);
+        }
+#else
+        if (file_ >= 0) {
+            ::close(file_);
+        }
+#endif
+    }
+
+    bool ok() const { return ok_; }
+    uint32_t checksum() const { return checksum_; }
+
+    void write(const void* data, size_t size, bool checksummed = true) {
+        if (!ok_) {
+            return;
+        }
+        if (checksummed) {
+            checksum_ = Protocol::crc32c(checksum_, static_cast<const uint8_t*>(data), size);
+        }
+        const char* bytes = static_cast<const char*>(data);
+        while (size > 0 && ok_) {
+#ifdef _WIN32
+            DWORD written = 0;
+            DWORD chunk = size > (1u << 30) ? (1u << 30) : static_cast<DWORD>(size);
+            ok_ = WriteFile(file_, bytes, chunk, &written, NULL) && written > 0;
+#else
+            ssize_t written = ::write(file_, bytes, size);
+            ok_ = written > 0;
+#endif
+            if (ok_) {
+                bytes += written;
+                size -= static_cast<size_t>(written);
+            }
+        }
+    }
+
+    // Данные на диске до переименования: иначе после сбоя питания под
+    // новым именем может оказаться недописанный файл
+    bool sync() {
+#ifdef _WIN32
+        ok_ = ok_ && FlushFileBuffers(file_);
+#else
+        ok_ = ok_ && ::fsync(file_) == 0;
+#endif
+        return ok_;
+    }
+
+    SnapshotFile(const SnapshotFile&) = delete;
+    SnapshotFile& operator=(const SnapshotFile&) = delete;
+};
+
+static bool replace_file(const std::string& from, const std::string& to) {
+#ifdef _WIN32
+    return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
+// ==================== Запись ====================
+
+SnapshotWriter::SnapshotWriter(const std::string& filename, uint32_t worker_count)
+    : filename_(filename),
+      pending_(worker_count),
+      fresh_(worker_count, false),
+      received_(worker_count, false),
+      stopping_(false),
+      writing_(worker_count) {
+    thread_ = std::thread(&SnapshotWriter::run, this);
+}
+
+SnapshotWriter::~SnapshotWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wakeup_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void SnapshotWriter::submit(uint32_t worker_id, SnapshotPart& part) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::swap(pending_[worker_id], part);
+        fresh_[worker_id] = true;
+        received_[worker_id] = true;
+    }
+    wakeup_.notify_one();
+}
+
+void SnapshotWriter::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        // Пока не все потоки прислали часть, файл не пишется: в нём не хватало
+        // бы сессий, восстановленных при запуске
+        wakeup_.wait(lock, [this] {
+            bool any_fresh = false;
+            bool all_received = true;
+            for (size_t worker = 0; worker < fresh_.size(); ++worker) {
+                any_fresh = any_fresh || fresh_[worker];
+                all_received = all_received && received_[worker];
+            }
+            return stopping_ || (any_fresh && all_received);
+        });
+        if (stopping_) {
+            return;
+        }
+        for (size_t worker = 0; worker < fresh_.size(); ++worker) {
+            if (fresh_[worker]) {
+                std::swap(writing_[worker], pending_[worker]);
+                fresh_[worker] = false;
+            }
+        }
+
+        lock.unlock();
+        auto start = Clock::now();
+        size_t records = 0;
+        for (const SnapshotPart& part : writing_) {
+            records += part.records.size();
+        }
+        if (write_file()) {
+            Log::debug("Session snapshot: {} sessions in {} ms", records,
+                       std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count());
+        } else {
+            Log::warn("Cannot write session snapshot {}", filename_);
+        }
+        lock.lock();
+    }
+}
+
+bool SnapshotWriter::write_file() {
+    // Словари всех частей сводятся в одну таблицу
+    std::vector<SnapshotDictionary> dictionaries;
+    std::vector<std::vector<uint32_t>> remap(writing_.size());
+    uint64_t record_count = 0;
+    for (size_t worker = 0; worker < writing_.size(); ++worker) {
+        for (const SnapshotDictionary& dictionary : writing_[worker].dictionaries) {
+            uint32_t index = 0;
+            while (index < dictionaries.size() && (dictionaries[index].fingerprint != dictionary.fingerprint ||
+                                                   dictionaries[index].word_count != dictionary.word_count)) {
+                ++index;
+            }
+            if (index == dictionaries.size()) {
+                dictionaries.push_back(dictionary);
+            }
+            remap[worker].push_back(index);
+        }
+        record_count += writing_[worker].records.size();
+    }
+
+    std::string temp_filename = filename_ + ".tmp";
+    {
+        SnapshotFile file(temp_filename);
+        SnapshotFileHeader header;
+        std::memset(&header, 0, sizeof(header));
+        header.magic = SNAPSHOT_MAGIC;
+        header.version = SNAPSHOT_VERSION;
+        header.record_size = sizeof(SessionRecord);
+        header.dictionary_count = static_cast<uint32_t>(dictionaries.size());
+        header.record_count = record_count;
+        header.created_ms = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+        file.write(&header, sizeof(header));
+        file.write(dictionaries.data(), dictionaries.size() * sizeof(SnapshotDictionary));
+
+        std::vector<SessionRecord> batch;
+        batch.reserve(WRITE_BATCH_RECORDS);
+        for (size_t worker = 0; worker < writing_.size(); ++worker) {
+            const std::vector<SessionRecord>& records = writing_[worker].records;
+            for (size_t first = 0; first < records.size(); first += WRITE_BATCH_RECORDS) {
+                size_t count = std::min(WRITE_BATCH_RECORDS, records.size() - first);
+                batch.assign(records.begin() + first, records.begin() + first + count);
+                for (SessionRecord& record : batch) {
+                    record.words_slot = remap[worker][record.words_slot];
+                }
+                file.write(batch.data(), count * sizeof(SessionRecord));
+            }
+        }
+
+        SnapshotFileTrailer trailer;
+        trailer.checksum = file.checksum();
+        trailer.magic = SNAPSHOT_MAGIC;
+        file.write(&trailer, sizeof(trailer), false);
+        if (!file.ok() || !file.sync()) {
+            return false;
+        }
+    }
+    return replace_file(temp_filename, filename_);
+}
+
+// ==================== Чтение ====================
+
+bool load_snapshot(const std::string& filename, const std::shared_ptr<const GameLogic::WordSnapshot>& words,
+                   uint32_t worker_count, std::vector<RestoredSessions>& workers) {
+    auto start = Clock::now();
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+    std::vector<char> data(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    if (!file.read(data.data(), static_cast<std::streamsize>(data.size()))) {
+        return false;
+    }
+
+    // Размеры секций проверяются до CRC, чтобы не считать её по чужому файлу
+    SnapshotFileHeader header;
+    SnapshotFileTrailer trailer;
+    if (data.size() < sizeof(header) + sizeof(trailer)) {
+        Log::warn("Session snapshot {} is truncated", filename);
+        return false;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    std::memcpy(&trailer, data.data() + data.size() - sizeof(trailer), sizeof(trailer));
+    size_t body_size = data.size() - sizeof(trailer);
+    if (header.magic != SNAPSHOT_MAGIC || header.version != SNAPSHOT_VERSION ||
+        header.record_size != sizeof(SessionRecord) || trailer.magic != SNAPSHOT_MAGIC ||
+        header.record_count > (body_size - sizeof(header)) / sizeof(SessionRecord) ||
+        sizeof(header) + header.dictionary_count * sizeof(SnapshotDictionary) +
+            header.record_count * sizeof(SessionRecord) != body_size ||
+        Protocol::crc32c(0, reinterpret_cast<const uint8_t*>(data.data()), body_size) != trailer.checksum) {
+        Log::warn("Session snapshot {} is damaged or has another format", filename);
+        return false;
+    }
+
+    // Игры на другом словаре не продолжить: номер слова в нём значит другое
+    const char* dictionaries = data.data() + sizeof(header);
+    std::vector<bool> usable(header.dictionary_count);
+    for (uint32_t i = 0; i < header.dictionary_count; ++i) {
+        SnapshotDictionary dictionary;
+        std::memcpy(&dictionary, dictionaries + i * sizeof(dictionary), sizeof(dictionary));
+        usable[i] = dictionary.fingerprint == words->fingerprint && dictionary.word_count == words->dictionary.size();
+    }
+
+    std::unordered_map<uint32_t, uint32_t> slots;
+    FileSocket::collect_session_slots(slots);
+
+    workers.assign(worker_count, RestoredSessions());
+    for (RestoredSessions& worker : workers) {
+        worker.words = words;
+    }
+
+    const char* records = dictionaries + header.dictionary_count * sizeof(SnapshotDictionary);
+    size_t restored = 0;
+    size_t without_client = 0;
+    size_t other_words = 0;
+    for (uint64_t i = 0; i < header.record_count; ++i) {
+        RestoredSession session;
+        std::memcpy(&session.record, records + i * sizeof(SessionRecord), sizeof(SessionRecord));
+        if (session.record.words_slot >= header.dictionary_count || !usable[session.record.words_slot]) {
+            ++other_words;
+            continue;
+        }
+        auto slot = slots.find(session.record.session_id);
+        if (slot == slots.end()) {
+            ++without_client;
+            continue;
+        }
+        session.slot = slot->second;
+        workers[IPC::get_chunk_worker(IPC::get_slot_chunk(session.slot), worker_count)].sessions.push_back(session);
+        ++restored;
+    }
+
+    Log::info("Restored {} sessions from {} in {} ms ({} without a client, {} on another dictionary)", restored,
+              filename, std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count(),
+              without_client, other_words);
+    return true;
+}
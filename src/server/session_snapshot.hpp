@@ -0,0 +1,100 @@
+#ifndef SESSION_SNAPSHOT_HPP
+#define SESSION_SNAPSHOT_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "game_session.hpp"
+#include "../game/word_library.hpp"
+
+// Снимок таблицы сессий для тёплого перезапуска сервера:
+//   SnapshotFileHeader
+//   SnapshotDictionary dictionaries[dictionary_count]
+//   SessionRecord records[record_count]  - words_slot - номер в dictionaries
+//   SnapshotFileTrailer                  - CRC32C всего, что перед ним
+// Файл пишется рядом под временным именем и заменяет прежний переименованием,
+// поэтому на диске всегда целый снимок - прежний или новый.
+const uint32_t SNAPSHOT_MAGIC = 0x504E5348; // "HSNP"
+const uint32_t SNAPSHOT_VERSION = 1;
+
+struct SnapshotFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t record_size;       // sizeof(SessionRecord): другая раскладка записи не читается
+    uint32_t dictionary_count;
+    uint64_t record_count;
+    uint64_t created_ms;        // system_clock
+};
+
+struct SnapshotDictionary {
+    uint64_t fingerprint;       // WordDictionary::fingerprint
+    uint64_t word_count;
+};
+
+struct SnapshotFileTrailer {
+    uint32_t checksum;
+    uint32_t magic;
+};
+
+// Сессии одного потока сервера
+struct SnapshotPart {
+    std::vector<SnapshotDictionary> dictionaries;
+    std::vector<SessionRecord> records;
+
+    void clear() {
+        dictionaries.clear();
+        records.clear();
+    }
+};
+
+// Фоновая запись снимков. Потоки-обработчики отдают свои части по готовности
+// (submit только меняет буферы местами под мьютексом); файл собирается из
+// последних частей всех потоков, когда каждый поток прислал хотя бы одну.
+class SnapshotWriter {
+private:
+    std::string filename_;
+    std::mutex mutex_;
+    std::condition_variable wakeup_;
+    std::vector<SnapshotPart> pending_;     // под mutex_
+    std::vector<bool> fresh_;
+    std::vector<bool> received_;
+    bool stopping_;
+    std::vector<SnapshotPart> writing_;     // только поток записи
+    std::thread thread_;
+
+    void run();
+    bool write_file();
+
+public:
+    SnapshotWriter(const std::string& filename, uint32_t worker_count);
+    ~SnapshotWriter();
+
+    // Забирает part; взамен part получает прежний буфер (чтобы не выделять память заново)
+    void submit(uint32_t worker_id, SnapshotPart& part);
+
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+};
+
+// Сессия из снимка, клиент которой ещё держит слот файла-сокета
+struct RestoredSession {
+    SessionRecord record;
+    uint32_t slot;
+};
+
+struct RestoredSessions {
+    std::shared_ptr<const GameLogic::WordSnapshot> words;
+    std::vector<RestoredSession> sessions;
+};
+
+// Читает снимок и раскладывает сессии по потокам сервера (по блоку слота).
+// Остаются сессии, клиент которых ещё занимает слот, а словарь совпадает с words;
+// false - файла нет или он повреждён
+bool load_snapshot(const std::string& filename, const std::shared_ptr<const GameLogic::WordSnapshot>& words,
+                   uint32_t worker_count, std::vector<RestoredSessions>& workers);
+
+#endif
@@ -0,0 +1,120 @@
+#include "timer_wheel.hpp"
+
+TimerWheel::TimerWheel(uint64_t now) : now_(now), size_(0) {
+    add_block();
+    for (uint32_t head = 0; head < HEADS; ++head) {
+        at(head).prev = head;
+        at(head).next = head;
+        at(head).expires = 0;
+    }
+}
+
+void TimerWheel::add_block() {
+    std::unique_ptr<Link[]> block(new Link[BLOCK_LINKS]);
+    for (uint32_t i = 0; i < BLOCK_LINKS; ++i) {
+        block[i] = Link{UNLINKED, UNLINKED, 0};
+    }
+    blocks_.push_back(std::move(block));
+}
+
+// Уровень - по расстоянию до срока, ячейка - по битам самого срока, поэтому
+// при перераскладке таймер попадает в ячейку, до которой колесо ещё не дошло
+void TimerWheel::link(uint32_t index) {
+    Link& node = at(index);
+    uint64_t delay = node.expires - now_;
+    int level = 0;
+    while (level < LEVELS - 1 && delay >= (1ull << (SLOT_BITS * (level + 1)))) {
+        ++level;
+    }
+    uint32_t head = head_index(level, node.expires);
+    node.prev = at(head).prev;
+    node.next = head;
+    at(at(head).prev).next = index;
+    at(head).prev = index;
+}
+
+void TimerWheel::unlink(uint32_t index) {
+    Link& node = at(index);
+    at(node.prev).next = node.next;
+    at(node.next).prev = node.prev;
+    node.prev = UNLINKED;
+    node.next = UNLINKED;
+}
+
+void TimerWheel::schedule(uint32_t id, uint64_t expires) {
+    uint32_t index = HEADS + id;
+    while (index >= blocks_.size() * BLOCK_LINKS) {
+        add_block();
+    }
+    if (at(index).prev != UNLINKED) {
+        unlink(index);
+    } else {
+        ++size_;
+    }
+    if (expires <= now_) {
+        expires = now_ + 1;
+    }
+    if (expires - now_ > MAX_DELAY) {
+        expires = now_ + MAX_DELAY;
+    }
+    at(index).expires = expires;
+    link(index);
+}
+
+void TimerWheel::cancel(uint32_t id) {
+    if (is_scheduled(id)) {
+        unlink(HEADS + id);
+        --size_;
+    }
+}
+
+// Ячейка уровня level, в которую вошло текущее время, раскладывается по младшим уровням
+void TimerWheel::cascade(int level) {
+    uint32_t head = head_index(level, now_);
+    uint32_t index = at(head).next;
+    at(head).prev = head;
+    at(head).next = head;
+    while (index != head) {
+        uint32_t next = at(index).next;
+        link(index);
+        index = next;
+    }
+}
+
+void TimerWheel::advance(uint64_t now, std::vector<uint32_t>& expired) {
+    while (now_ < now) {
+        ++now_;
+        // Полный оборот младшего уровня - спускаем очередную ячейку старшего
+        for (int level = 1; level < LEVELS && (now_ & ((1ull << (SLOT_BITS * level)) - 1)) == 0; ++level) {
+            cascade(level);
+        }
+
+        if (size_ == 0) {
+            // Пустое колесо: остаток пути проходить по тику незачем
+            now_ = now;
+            break;
+        }
+
+        uint32_t head = head_index(0, now_);
+        while (at(head).next != head) {
+            uint32_t index = at(head).next;
+            unlink(index);
+            --size_;
+            expired.push_back(index - HEADS);
+        }
+    }
+}
+
+uint64_t TimerWheel::ticks_until_next() const {
+    if (size_ == 0) {
+        return 0;
+    }
+    uint64_t to_boundary = SLOTS - (now_ & (SLOTS - 1));
+    for (uint64_t ticks = 1; ticks < to_boundary; ++ticks) {
+        uint32_t head = head_index(0, now_ + ticks);
+        if (at(head).next != head) {
+            return ticks;
+        }
+    }
+    return to_boundary;
+}
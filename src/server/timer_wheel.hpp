@@ -0,0 +1,80 @@
+#ifndef TIMER_WHEEL_HPP
+#define TIMER_WHEEL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Иерархическое колесо таймеров. Время - целые тики; LEVELS уровней по SLOTS
+// ячеек, ячейка уровня L покрывает SLOTS^L тиков. Таймер кладётся в ячейку по
+// тому, как далеко его срок; когда младший уровень проходит полный оборот,
+// очередная ячейка старшего перераскладывается вниз. Постановка и снятие -
+// O(1), продвижение на тик - O(1) плюс число истёкших и перенесённых таймеров.
+//
+// Таймеры адресуются плотными номерами (номер записи в пуле сессий), а связи
+// списков - 32-битные номера в массиве самого колеса: владельцу не нужно
+// держать узел у себя и не перемещать его. Массив растёт блоками, без
+// перевыделения с копированием.
+class TimerWheel {
+public:
+    static constexpr int SLOT_BITS = 6;
+    static constexpr int SLOTS = 1 << SLOT_BITS;
+    static constexpr int LEVELS = 4;
+    // Дальше этого таймер ставится на предельный срок и при срабатывании переставляется
+    static constexpr uint64_t MAX_DELAY = (1ull << (SLOT_BITS * LEVELS)) - 1;
+
+private:
+    static constexpr uint32_t HEADS = LEVELS * SLOTS;
+    static constexpr uint32_t UNLINKED = UINT32_MAX;
+    static constexpr uint32_t BLOCK_LINKS = 4096;
+
+    struct Link {
+        uint32_t prev;      // UNLINKED - таймер не стоит
+        uint32_t next;
+        uint64_t expires;
+    };
+
+    // Первые HEADS элементов - головы кольцевых списков ячеек, таймер id - at(HEADS + id)
+    std::vector<std::unique_ptr<Link[]>> blocks_;
+    uint64_t now_;
+    size_t size_;
+
+    Link& at(uint32_t index) { return blocks_[index / BLOCK_LINKS][index % BLOCK_LINKS]; }
+    const Link& at(uint32_t index) const { return blocks_[index / BLOCK_LINKS][index % BLOCK_LINKS]; }
+    static uint32_t head_index(int level, uint64_t tick) {
+        return static_cast<uint32_t>(level * SLOTS + ((tick >> (SLOT_BITS * level)) & (SLOTS - 1)));
+    }
+    void add_block();
+    void link(uint32_t index);
+    void unlink(uint32_t index);
+    void cascade(int level);
+
+public:
+    explicit TimerWheel(uint64_t now = 0);
+
+    uint64_t now() const { return now_; }
+    size_t size() const { return size_; }
+    // Байт на связи таймеров
+    size_t memory_bytes() const { return blocks_.size() * BLOCK_LINKS * sizeof(Link); }
+
+    bool is_scheduled(uint32_t id) const {
+        return HEADS + id < blocks_.size() * BLOCK_LINKS && at(HEADS + id).prev != UNLINKED;
+    }
+    uint64_t expires(uint32_t id) const { return at(HEADS + id).expires; }
+
+    // Срок не раньше следующего тика; уже стоящий таймер переставляется
+    void schedule(uint32_t id, uint64_t expires);
+    void cancel(uint32_t id);
+    // Продвигает время до now; id истёкших таймеров дописываются в expired,
+    // к этому моменту они уже сняты с колеса
+    void advance(uint64_t now, std::vector<uint32_t>& expired);
+    // Тиков от now() до ближайшего возможного срабатывания: срок в младшем
+    // уровне или граница его оборота, где спускаются старшие; 0 - колесо пусто
+    uint64_t ticks_until_next() const;
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+};
+
+#endif
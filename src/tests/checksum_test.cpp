@@ -0,0 +1,47 @@
+// CRC32C: контрольное значение "123456789" у таблицы, у инструкции SSE4.2 (если
+// процессор её умеет) и у выбранной реализации; продолжение расчёта по частям и
+// любые длины и выравнивания дают то же, что расчёт целиком.
+#include "test_common.hpp"
+#include "../protocol/checksum.hpp"
+#include <cstring>
+#include <random>
+#include <vector>
+
+static const char CHECK_INPUT[] = "123456789";
+static const uint32_t CHECK_VALUE = 0xE3069283;
+
+typedef uint32_t (*Crc32cFunction)(uint32_t, const uint8_t*, size_t);
+
+static void check_implementation(Crc32cFunction crc32c, const std::vector<uint8_t>& data) {
+    const uint8_t* input = reinterpret_cast<const uint8_t*>(CHECK_INPUT);
+    size_t input_size = std::strlen(CHECK_INPUT);
+    CHECK(crc32c(0, input, input_size) == CHECK_VALUE);
+    CHECK(crc32c(0, input, 0) == 0);
+    for (size_t split = 0; split <= input_size; ++split) {
+        CHECK(crc32c(crc32c(0, input, split), input + split, input_size - split) == CHECK_VALUE);
+    }
+
+    // Все смещения внутри 8 байт и длины вокруг границ слов - против таблицы
+    for (size_t offset = 0; offset < 8; ++offset) {
+        for (size_t size = 0; size + offset <= data.size(); size += size < 80 ? 1 : 37) {
+            CHECK(crc32c(0, data.data() + offset, size) == Protocol::crc32c_software(0, data.data() + offset, size));
+        }
+    }
+}
+
+int main() {
+    std::mt19937 random(9);
+    std::vector<uint8_t> data(1000);
+    for (uint8_t& byte : data) {
+        byte = static_cast<uint8_t>(random());
+    }
+
+    check_implementation(Protocol::crc32c_software, data);
+    if (Protocol::crc32c_hardware_available()) {
+        check_implementation(Protocol::crc32c_hardware, data);
+    } else {
+        std::printf("checksum_test: SSE4.2 is not available, hardware path skipped\n");
+    }
+    check_implementation(Protocol::crc32c, data);
+    return test_result("checksum_test");
+}
@@ -0,0 +1,204 @@
+// Кодек сообщений: каждое закодированное сообщение (ping, start, пакет букв,
+// pong с GAME_STATE и COMPACT_STATE, ответ на пакет) разбирается обратно в те же
+// поля с обеими суммами; без последнего байта или с испорченным байтом - не разбирается.
+#include "test_common.hpp"
+#include "../protocol/codec.hpp"
+#include "../protocol/protocol.hpp"
+#include "../ipc/ipc_common.hpp"
+#include <string>
+#include <vector>
+
+static const uint32_t SESSION_ID = 0x12345;
+static const uint32_t SEQUENCE = 0x01020304;
+static const uint32_t ACK_SEQUENCE = 0xA0B0C0D0;
+
+struct Encoded {
+    uint8_t buffer[IPC::MAX_MESSAGE_SIZE];
+    size_t size = 0;
+
+    Protocol::MutableByteSpan out() { return Protocol::MutableByteSpan{buffer, sizeof(buffer)}; }
+    Protocol::ByteSpan bytes() const { return Protocol::ByteSpan{buffer, size}; }
+};
+
+static std::vector<uint8_t> to_vector(Protocol::ByteSpan bytes) {
+    return std::vector<uint8_t>(bytes.data, bytes.data + bytes.size);
+}
+
+// Разбирает сообщение и проверяет заголовок; payload - копия для parse_*
+static bool decode_checked(const Encoded& encoded, uint32_t message_type, Protocol::ChecksumType checksum,
+                           Protocol::MessageView& message) {
+    CHECK(encoded.size != 0);
+    if (!Protocol::decode_message(encoded.bytes(), message)) {
+        return false;
+    }
+    CHECK(message.header.session_id == SESSION_ID);
+    CHECK(message.header.sequence == SEQUENCE);
+    CHECK(message.header.message_type == message_type);
+    CHECK(message.header.payload_size == encoded.size - sizeof(Protocol::MessageHeader));
+    CHECK(message.checksum == checksum);
+    return true;
+}
+
+// Сообщение без последнего байта и с любым испорченным байтом отвергается
+static void check_damaged(const Encoded& encoded) {
+    Protocol::MessageView message;
+    CHECK(!Protocol::decode_message(Protocol::ByteSpan{encoded.buffer, encoded.size - 1}, message));
+    for (size_t i = 0; i < encoded.size; ++i) {
+        Encoded damaged = encoded;
+        damaged.buffer[i] ^= 0x01;
+        CHECK(!Protocol::decode_message(damaged.bytes(), message));
+    }
+}
+
+static Protocol::ByteSpan without_last_byte(Protocol::ByteSpan bytes) {
+    return Protocol::ByteSpan{bytes.data, bytes.size - 1};
+}
+
+static void check_requests(Protocol::ChecksumType checksum) {
+    Protocol::MessageView message;
+
+    // Буква без подтверждения и с ним
+    Encoded ping;
+    ping.size = Protocol::encode_ping(ping.out(), SESSION_ID, SEQUENCE, "e", checksum);
+    CHECK(decode_checked(ping, Protocol::MessageType::PING, checksum, message));
+    CHECK(Protocol::parse_ping_payload(to_vector(message.payload)) == "e");
+    CHECK(Protocol::parse_ack_sequence(to_vector(message.payload)) == 0);
+    check_damaged(ping);
+
+    ping.size = Protocol::encode_ping(ping.out(), SESSION_ID, SEQUENCE, "e", checksum, ACK_SEQUENCE);
+    CHECK(decode_checked(ping, Protocol::MessageType::PING, checksum, message));
+    CHECK(Protocol::parse_ping_payload(to_vector(message.payload)) == "e");
+    CHECK(Protocol::parse_ack_sequence(to_vector(message.payload)) == ACK_SEQUENCE);
+    CHECK(Protocol::parse_ack_sequence(to_vector(without_last_byte(message.payload))) == 0);
+    check_damaged(ping);
+
+    // "start" через ping и GAME_START со сложностью
+    ping.size = Protocol::encode_ping(ping.out(), SESSION_ID, SEQUENCE, "start", checksum);
+    CHECK(decode_checked(ping, Protocol::MessageType::PING, checksum, message));
+    CHECK(Protocol::parse_ping_payload(to_vector(message.payload)) == "start");
+    CHECK(Protocol::parse_capabilities(to_vector(message.payload)) ==
+          (Protocol::Capability::CRC32C | Protocol::Capability::COMPACT_STATE));
+    CHECK(Protocol::parse_difficulty(to_vector(message.payload)) == Protocol::Difficulty::ANY);
+    check_damaged(ping);
+
+    Encoded start;
+    start.size = Protocol::encode_start(start.out(), SESSION_ID, SEQUENCE, Protocol::Difficulty::HARD, checksum);
+    CHECK(decode_checked(start, Protocol::MessageType::PING, checksum, message));
+    CHECK(Protocol::parse_ping_payload(to_vector(message.payload)) == "start");
+    CHECK(Protocol::parse_capabilities(to_vector(message.payload)) ==
+          (Protocol::Capability::CRC32C | Protocol::Capability::COMPACT_STATE));
+    CHECK(Protocol::parse_difficulty(to_vector(message.payload)) == Protocol::Difficulty::HARD);
+    CHECK(Protocol::parse_difficulty(to_vector(without_last_byte(message.payload))) == Protocol::Difficulty::ANY);
+    check_damaged(start);
+
+    // Пакет букв без подтверждения и с ним
+    Encoded batch;
+    batch.size = Protocol::encode_guess_batch(batch.out(), SESSION_ID, SEQUENCE, "etaoin", checksum);
+    CHECK(decode_checked(batch, Protocol::MessageType::PING, checksum, message));
+    CHECK(Protocol::is_batch_payload(to_vector(message.payload)));
+    CHECK(Protocol::parse_batch_payload(to_vector(message.payload)) == "etaoin");
+    CHECK(Protocol::parse_ack_sequence(to_vector(message.payload)) == 0);
+    CHECK(Protocol::parse_batch_payload(to_vector(without_last_byte(message.payload))).empty());
+    check_damaged(batch);
+
+    batch.size = Protocol::encode_guess_batch(batch.out(), SESSION_ID, SEQUENCE, "etaoin", checksum, ACK_SEQUENCE);
+    CHECK(decode_checked(batch, Protocol::MessageType::PING, checksum, message));
+    CHECK(Protocol::parse_batch_payload(to_vector(message.payload)) == "etaoin");
+    CHECK(Protocol::parse_ack_sequence(to_vector(message.payload)) == ACK_SEQUENCE);
+    CHECK(Protocol::parse_batch_payload(to_vector(without_last_byte(message.payload))).empty());
+    CHECK(Protocol::parse_ack_sequence(to_vector(without_last_byte(message.payload))) == 0);
+    check_damaged(batch);
+
+    // Пустой и слишком длинный пакет не кодируются
+    CHECK(Protocol::encode_guess_batch(batch.out(), SESSION_ID, SEQUENCE, "", checksum) == 0);
+    CHECK(Protocol::encode_guess_batch(batch.out(), SESSION_ID, SEQUENCE,
+                                       std::string(Protocol::MAX_BATCH_LETTERS + 1, 'a'), checksum) == 0);
+}
+
+static bool same_state(const Protocol::GameStateView& a, const Protocol::GameStateView& b) {
+    return a.display_word == b.display_word && a.errors_left == b.errors_left && a.status == b.status &&
+           a.additional_info == b.additional_info;
+}
+
+static bool same_compact_state(const Protocol::CompactStateView& a, const Protocol::CompactStateView& b) {
+    return a.word_length == b.word_length && a.errors_left == b.errors_left && a.status == b.status &&
+           a.code == b.code && a.guessed_mask == b.guessed_mask && a.wrong_mask == b.wrong_mask &&
+           a.base_sequence == b.base_sequence && a.changed_positions == b.changed_positions &&
+           a.letters == b.letters && a.secret_word == b.secret_word;
+}
+
+static void check_replies(Protocol::ChecksumType checksum) {
+    Protocol::MessageView message;
+    const Protocol::GameStateView state{"h*ngm*n", 4, Protocol::GameStatus::IN_PROGRESS, "Correct! Wrong letters: e, o"};
+    // Слово длиннее 8 букв - маска позиций в два байта
+    const Protocol::CompactStateView compact{11, 2, Protocol::GameStatus::LOSE, Protocol::StateCode::LOST,
+                                             0x0000A5A5, 0x00000124, 0x0BADF00D, 0x0000000000000481ull,
+                                             "abc", "abracadabra"};
+    const uint8_t outcome_bytes[] = {Protocol::GuessOutcome::CORRECT, Protocol::GuessOutcome::WRONG,
+                                     Protocol::GuessOutcome::REPEATED};
+    const Protocol::ByteSpan outcomes{outcome_bytes, sizeof(outcome_bytes)};
+
+    Encoded pong;
+    pong.size = Protocol::encode_pong(pong.out(), SESSION_ID, SEQUENCE, state, checksum);
+    CHECK(decode_checked(pong, Protocol::MessageType::PONG, checksum, message));
+    Protocol::GameStateView decoded{};
+    CHECK(Protocol::decode_game_state(message.payload, decoded));
+    CHECK(same_state(decoded, state));
+    CHECK(!Protocol::decode_game_state(without_last_byte(message.payload), decoded));
+    check_damaged(pong);
+
+    Encoded compact_pong;
+    compact_pong.size = Protocol::encode_compact_pong(compact_pong.out(), SESSION_ID, SEQUENCE, compact, checksum);
+    CHECK(decode_checked(compact_pong, Protocol::MessageType::PONG, checksum, message));
+    Protocol::CompactStateView decoded_compact{};
+    CHECK(Protocol::decode_compact_state(message.payload, decoded_compact));
+    CHECK(same_compact_state(decoded_compact, compact));
+    CHECK(!Protocol::decode_compact_state(without_last_byte(message.payload), decoded_compact));
+    check_damaged(compact_pong);
+
+    // Букв меньше, чем отмеченных позиций, - не кодируется
+    Protocol::CompactStateView inconsistent = compact;
+    inconsistent.letters = "ab";
+    CHECK(Protocol::encode_compact_pong(compact_pong.out(), SESSION_ID, SEQUENCE, inconsistent, checksum) == 0);
+
+    // Ответы на пакет с обоими видами состояния
+    Protocol::ByteSpan decoded_outcomes{nullptr, 0};
+    Protocol::ByteSpan nested{nullptr, 0};
+    Encoded batch_pong;
+    batch_pong.size = Protocol::encode_batch_pong(batch_pong.out(), SESSION_ID, SEQUENCE, outcomes, state, checksum);
+    CHECK(decode_checked(batch_pong, Protocol::MessageType::PONG, checksum, message));
+    CHECK(Protocol::decode_batch_state(message.payload, decoded_outcomes, nested));
+    CHECK(to_vector(decoded_outcomes) == to_vector(outcomes));
+    CHECK(Protocol::decode_game_state(nested, decoded));
+    CHECK(same_state(decoded, state));
+    CHECK(Protocol::decode_batch_state(without_last_byte(message.payload), decoded_outcomes, nested));
+    CHECK(!Protocol::decode_game_state(nested, decoded));
+    check_damaged(batch_pong);
+
+    batch_pong.size = Protocol::encode_compact_batch_pong(batch_pong.out(), SESSION_ID, SEQUENCE, outcomes, compact,
+                                                          checksum);
+    CHECK(decode_checked(batch_pong, Protocol::MessageType::PONG, checksum, message));
+    CHECK(Protocol::decode_batch_state(message.payload, decoded_outcomes, nested));
+    CHECK(to_vector(decoded_outcomes) == to_vector(outcomes));
+    CHECK(Protocol::decode_compact_state(nested, decoded_compact));
+    CHECK(same_compact_state(decoded_compact, compact));
+    Protocol::BatchResult result = Protocol::parse_batch_pong_payload(to_vector(message.payload));
+    CHECK(result.compact);
+    CHECK(result.outcomes == to_vector(outcomes));
+    CHECK(result.compact_state.letters == "abc" && result.compact_state.secret_word == "abracadabra");
+    result = Protocol::parse_batch_pong_payload(to_vector(without_last_byte(message.payload)));
+    CHECK(result.outcomes.empty() && !result.compact);
+    check_damaged(batch_pong);
+}
+
+int main() {
+    for (Protocol::ChecksumType checksum : {Protocol::ChecksumType::XOR, Protocol::ChecksumType::CRC32C}) {
+        check_requests(checksum);
+        check_replies(checksum);
+    }
+
+    // Сообщение не помещается в буфер - не кодируется
+    uint8_t small[sizeof(Protocol::MessageHeader) + 1];
+    CHECK(Protocol::encode_ping(Protocol::MutableByteSpan{small, sizeof(small)}, SESSION_ID, SEQUENCE, "e") == 0);
+    return test_result("codec_test");
+}
@@ -0,0 +1,195 @@
+// HangmanGame на масках против прежнего движка на std::unordered_set (его копия -
+// Baseline::HangmanGame ниже): на словах из букв a-z/A-Z и догадках a-z/A-Z обе
+// версии дают тот же экран, ошибки, исход хода, конец игры и ошибочные буквы.
+// Символы вне a-z ведут себя по-новому (прежний движок прятал их навсегда и
+// засчитывал как ошибку) - это проверяется отдельно по описанным правилам.
+#include "test_common.hpp"
+#include "../game/game_logic.hpp"
+#include <algorithm>
+#include <cctype>
+#include <random>
+#include <string>
+#include <unordered_set>
+
+static const int GAMES = 20000;
+static const int GUESSES_PER_GAME = 30;
+
+namespace Baseline {
+
+class HangmanGame {
+private:
+    std::string secret_word_;
+    std::string display_word_;
+    std::unordered_set<char> guessed_letters_;
+    int max_errors_ = 6;
+    int current_errors_ = 0;
+    bool game_over_ = false;
+    bool game_won_ = false;
+
+    void update_display_word() {
+        display_word_.clear();
+        for (char c : secret_word_) {
+            display_word_ += guessed_letters_.count(static_cast<char>(std::tolower(c))) > 0 ? c : '*';
+        }
+    }
+
+public:
+    void start_new_game(const std::string& word, int max_errors) {
+        secret_word_ = word;
+        max_errors_ = max_errors;
+        current_errors_ = 0;
+        game_over_ = false;
+        game_won_ = false;
+        guessed_letters_.clear();
+        display_word_ = std::string(secret_word_.length(), '*');
+    }
+
+    bool guess_letter(char letter) {
+        if (game_over_ || game_won_) return false;
+
+        char lower_letter = static_cast<char>(std::tolower(letter));
+        if (guessed_letters_.count(lower_letter) > 0) {
+            return false;
+        }
+        guessed_letters_.insert(lower_letter);
+
+        bool letter_found = false;
+        for (char c : secret_word_) {
+            if (std::tolower(c) == lower_letter) {
+                letter_found = true;
+                break;
+            }
+        }
+
+        if (letter_found) {
+            update_display_word();
+            if (display_word_ == secret_word_) {
+                game_won_ = true;
+                game_over_ = true;
+            }
+        } else {
+            current_errors_++;
+            if (current_errors_ >= max_errors_) {
+                game_over_ = true;
+            }
+        }
+        return letter_found;
+    }
+
+    const std::string& get_display_word() const { return display_word_; }
+    int get_errors_left() const { return max_errors_ - current_errors_; }
+    bool is_game_over() const { return game_over_; }
+    bool is_game_won() const { return game_won_; }
+    bool is_letter_guessed(char letter) const { return guessed_letters_.count(letter) > 0; }
+
+    // Ошибочные буквы по алфавиту (прежний движок перечислял их в порядке хеш-таблицы)
+    std::string get_wrong_letters() const {
+        std::string letters;
+        for (char letter : guessed_letters_) {
+            bool found = false;
+            for (char c : secret_word_) {
+                if (std::tolower(c) == letter) {
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) {
+                letters += letter;
+            }
+        }
+        std::sort(letters.begin(), letters.end());
+        std::string wrong_letters;
+        for (char letter : letters) {
+            if (!wrong_letters.empty()) wrong_letters += ", ";
+            wrong_letters += letter;
+        }
+        return wrong_letters;
+    }
+};
+
+}
+
+// Буквы слова из небольшого алфавита, чтобы чаще повторялись и угадывались
+static std::string random_word(std::mt19937& random) {
+    static const char LETTERS[] = "abcdefghijklmnopqrstuvwxyz";
+    size_t alphabet = 3 + random() % 24;
+    size_t length = 1 + random() % 20;
+    std::string word;
+    for (size_t i = 0; i < length; ++i) {
+        char letter = LETTERS[random() % alphabet];
+        word += random() % 5 == 0 ? static_cast<char>(std::toupper(letter)) : letter;
+    }
+    return word;
+}
+
+static char random_guess(std::mt19937& random) {
+    char letter = static_cast<char>('a' + random() % 26);
+    return random() % 4 == 0 ? static_cast<char>(std::toupper(letter)) : letter;
+}
+
+static void check_same(const GameLogic::HangmanGame& game, const Baseline::HangmanGame& baseline) {
+    CHECK(game.get_display_word() == baseline.get_display_word());
+    CHECK(game.get_errors_left() == baseline.get_errors_left());
+    CHECK(game.is_game_over() == baseline.is_game_over());
+    CHECK(game.is_game_won() == baseline.is_game_won());
+    CHECK(game.get_wrong_letters() == baseline.get_wrong_letters());
+    for (char letter = 'a'; letter <= 'z'; ++letter) {
+        CHECK(game.is_letter_guessed(letter) == baseline.is_letter_guessed(letter));
+    }
+    // Маски согласованы с экраном
+    const std::string& display = game.get_display_word();
+    for (size_t i = 0; i < display.size() && i < 64; ++i) {
+        CHECK(((game.get_revealed_positions() >> i) & 1) == (display[i] != '*' ? 1u : 0u));
+    }
+}
+
+static void check_against_baseline() {
+    std::mt19937 random(12);
+    GameLogic::HangmanGame game;
+    Baseline::HangmanGame baseline;
+    for (int i = 0; i < GAMES && test_failures() < 20; ++i) {
+        std::string word = random_word(random);
+        int max_errors = 1 + static_cast<int>(random() % 8);
+        game.start_new_game(word, max_errors);
+        baseline.start_new_game(word, max_errors);
+        check_same(game, baseline);
+        for (int guess = 0; guess < GUESSES_PER_GAME; ++guess) {
+            char letter = random_guess(random);
+            CHECK(game.guess_letter(letter) == baseline.guess_letter(letter));
+            check_same(game, baseline);
+        }
+    }
+}
+
+// Символы вне a-z видны с начала игры, их угадывание ничего не меняет и ошибкой не считается
+static void check_non_letters() {
+    GameLogic::HangmanGame game;
+    game.start_new_game("rock'n'roll 2", 3);
+    CHECK(game.get_display_word() == "****'*'**** 2");
+    for (char guess : {'\'', ' ', '2', '-', '*', '\0', static_cast<char>(0xE9)}) {
+        CHECK(!game.guess_letter(guess));
+        CHECK(game.get_errors_left() == 3);
+        CHECK(!game.is_game_over());
+        CHECK(game.get_wrong_letters().empty());
+        CHECK(game.get_guessed_mask() == 0);
+    }
+    for (char guess : {'r', 'o', 'c', 'k', 'n', 'l'}) {
+        CHECK(game.guess_letter(guess));
+    }
+    CHECK(game.get_display_word() == "rock'n'roll 2");
+    CHECK(game.is_game_won() && game.is_game_over());
+    CHECK(game.get_errors_left() == 3);
+
+    // Слово совсем без букв a-z выиграно сразу
+    game.start_new_game("42", 6);
+    CHECK(game.get_display_word() == "42");
+    CHECK(game.is_game_won() && game.is_game_over());
+    CHECK(!game.guess_letter('a'));
+    CHECK(game.get_errors_left() == 6);
+}
+
+int main() {
+    check_against_baseline();
+    check_non_letters();
+    return test_result("game_logic_test");
+}
@@ -0,0 +1,216 @@
+// Снимок сессий: запись и чтение возвращают те же записи и раскладывают их по
+// потокам по блоку слота; обрезанный файл, испорченная CRC и чужой словарь
+// не восстанавливают ничего.
+#include "test_common.hpp"
+#include "../server/session_snapshot.hpp"
+#include "../ipc/file_socket.hpp"
+#include "../log/logger.hpp"
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <thread>
+#include <unordered_map>
+
+static const char* SNAPSHOT_FILE = "test_sessions.snap";
+// Больше одного блока файла-сокета, чтобы сессии разошлись по потокам
+static const uint32_t SESSIONS = 150;
+static const uint32_t WRITER_WORKERS = 2;
+static const uint32_t READER_WORKERS = 3;
+
+static std::shared_ptr<const GameLogic::WordSnapshot> make_words(const std::string& filename,
+                                                                 const std::vector<std::string>& words) {
+    std::ofstream file(filename);
+    for (const std::string& word : words) {
+        file << word << '\n';
+    }
+    file.close();
+    auto snapshot = std::make_shared<GameLogic::WordSnapshot>();
+    snapshot->dictionary.load_text(filename);
+    snapshot->fingerprint = snapshot->dictionary.fingerprint();
+    snapshot->version = 1;
+    return snapshot;
+}
+
+static SessionRecord make_record(uint32_t session_id, uint32_t words_slot, std::mt19937& random) {
+    SessionRecord record;
+    std::memset(&record, 0, sizeof(record));
+    record.session_id = session_id;
+    record.word_id = random() % 4;
+    record.words_slot = words_slot;
+    record.sequence = random();
+    record.guessed_mask = random() & ((1u << 26) - 1);
+    record.last_active = random();
+    record.max_errors = 6;
+    record.errors = static_cast<uint8_t>(random() % 6);
+    record.flags = SessionRecord::COMPACT_STATE;
+    record.next_reply = static_cast<uint8_t>(random() % SessionRecord::REPLY_HISTORY);
+    for (int i = 0; i < SessionRecord::REPLY_HISTORY; ++i) {
+        record.reply_sequences[i] = random();
+        record.reply_guessed[i] = random();
+    }
+    return record;
+}
+
+// Все поля, кроме words_slot: в файле это номер словаря самого снимка
+static bool same_record(const SessionRecord& a, const SessionRecord& b) {
+    SessionRecord left = a;
+    SessionRecord right = b;
+    left.words_slot = right.words_slot = 0;
+    return std::memcmp(&left, &right, sizeof(left)) == 0;
+}
+
+static bool write_snapshot(std::vector<SnapshotPart>& parts) {
+    std::filesystem::remove(SNAPSHOT_FILE);
+    SnapshotWriter writer(SNAPSHOT_FILE, static_cast<uint32_t>(parts.size()));
+    for (uint32_t worker = 0; worker < parts.size(); ++worker) {
+        writer.submit(worker, parts[worker]);
+    }
+    // Файл появляется переименованием, то есть сразу целым
+    for (int i = 0; i < 500 && !std::filesystem::exists(SNAPSHOT_FILE); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return std::filesystem::exists(SNAPSHOT_FILE);
+}
+
+static size_t restored_count(const std::vector<RestoredSessions>& workers) {
+    size_t count = 0;
+    for (const RestoredSessions& worker : workers) {
+        count += worker.sessions.size();
+    }
+    return count;
+}
+
+static std::vector<char> read_file(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static void write_file(const std::string& filename, const std::vector<char>& data) {
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+int main() {
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "hangman_snapshot_test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    std::filesystem::current_path(directory);
+    Log::set_level(Log::Level::ERR);
+
+    auto words = make_words("words.txt", {"alpha", "bravo", "charlie", "delta"});
+    auto other_words = make_words("other.txt", {"echo", "foxtrot", "golf", "hotel"});
+    CHECK(words->fingerprint != other_words->fingerprint);
+
+    // Клиенты занимают слоты; у последних сессий клиента нет
+    std::mt19937 random(7);
+    std::vector<uint32_t> session_ids;
+    for (uint32_t i = 0; i < SESSIONS; ++i) {
+        uint32_t session_id = 0x10000 + i;
+        if (i < SESSIONS - 10) {
+            CHECK(FileSocket::connect_session(session_id));
+        }
+        session_ids.push_back(session_id);
+    }
+    std::unordered_map<uint32_t, uint32_t> slots;
+    FileSocket::collect_session_slots(slots);
+    CHECK(slots.size() == SESSIONS - 10);
+
+    // Поток 0 - только текущий словарь, поток 1 - ещё и чужой (его сессии не восстанавливаются)
+    std::vector<SnapshotPart> parts(WRITER_WORKERS);
+    parts[0].dictionaries.push_back({words->fingerprint, words->dictionary.size()});
+    parts[1].dictionaries.push_back({other_words->fingerprint, other_words->dictionary.size()});
+    parts[1].dictionaries.push_back({words->fingerprint, words->dictionary.size()});
+    std::unordered_map<uint32_t, SessionRecord> expected;
+    size_t other_dictionary = 0;
+    for (uint32_t i = 0; i < SESSIONS; ++i) {
+        uint32_t worker = i % WRITER_WORKERS;
+        uint32_t words_slot = worker == 0 ? 0 : (i % 3 == 0 ? 0 : 1);
+        SessionRecord record = make_record(session_ids[i], words_slot, random);
+        parts[worker].records.push_back(record);
+        bool current_words = worker == 0 || words_slot == 1;
+        if (slots.count(record.session_id) == 0) {
+            continue;
+        }
+        if (current_words) {
+            expected[record.session_id] = record;
+        } else {
+            ++other_dictionary;
+        }
+    }
+    CHECK(other_dictionary > 0);
+    CHECK(write_snapshot(parts));
+
+    // Запись - чтение
+    std::vector<RestoredSessions> workers;
+    CHECK(load_snapshot(SNAPSHOT_FILE, words, READER_WORKERS, workers));
+    CHECK(workers.size() == READER_WORKERS);
+    CHECK(restored_count(workers) == expected.size());
+    for (uint32_t worker = 0; worker < workers.size(); ++worker) {
+        CHECK(workers[worker].words == words);
+        for (const RestoredSession& session : workers[worker].sessions) {
+            auto it = expected.find(session.record.session_id);
+            CHECK(it != expected.end());
+            if (it == expected.end()) {
+                continue;
+            }
+            CHECK(same_record(session.record, it->second));
+            CHECK(session.slot == slots[session.record.session_id]);
+            CHECK(IPC::get_chunk_worker(IPC::get_slot_chunk(session.slot), READER_WORKERS) == worker);
+            expected.erase(it);
+        }
+    }
+    CHECK(expected.empty());
+    // Сессии есть больше чем у одного потока
+    size_t busy_workers = 0;
+    for (const RestoredSessions& worker : workers) {
+        busy_workers += worker.sessions.empty() ? 0 : 1;
+    }
+    CHECK(busy_workers > 1);
+
+    // Словарь сервера другой: остаются только сессии, начатые на нём же
+    CHECK(load_snapshot(SNAPSHOT_FILE, other_words, READER_WORKERS, workers));
+    // (в файле словари потока 0 идут первыми, чужой получил номер 1)
+    CHECK(restored_count(workers) == other_dictionary);
+    for (const RestoredSessions& worker : workers) {
+        for (const RestoredSession& session : worker.sessions) {
+            CHECK(session.record.words_slot == 1);
+        }
+    }
+    // Ни с одним словарём снимка не совпадает - не восстанавливается ничего
+    auto third_words = make_words("third.txt", {"india", "juliett"});
+    CHECK(load_snapshot(SNAPSHOT_FILE, third_words, READER_WORKERS, workers));
+    CHECK(restored_count(workers) == 0);
+
+    // Обрезанный на байт файл
+    const std::vector<char> image = read_file(SNAPSHOT_FILE);
+    std::vector<char> damaged(image.begin(), image.end() - 1);
+    write_file(SNAPSHOT_FILE, damaged);
+    workers.clear();
+    CHECK(!load_snapshot(SNAPSHOT_FILE, words, READER_WORKERS, workers));
+    CHECK(restored_count(workers) == 0);
+
+    // Испорченный байт записи и байт самой CRC
+    damaged = image;
+    damaged[sizeof(SnapshotFileHeader) + 2 * sizeof(SnapshotDictionary) + 5] ^= 0x01;
+    write_file(SNAPSHOT_FILE, damaged);
+    CHECK(!load_snapshot(SNAPSHOT_FILE, words, READER_WORKERS, workers));
+    damaged = image;
+    damaged[image.size() - sizeof(SnapshotFileTrailer)] ^= 0x80;
+    write_file(SNAPSHOT_FILE, damaged);
+    CHECK(!load_snapshot(SNAPSHOT_FILE, words, READER_WORKERS, workers));
+
+    // Целый файл после всего этого снова читается
+    write_file(SNAPSHOT_FILE, image);
+    CHECK(load_snapshot(SNAPSHOT_FILE, words, READER_WORKERS, workers));
+    CHECK(restored_count(workers) > 0);
+
+    for (uint32_t session_id : session_ids) {
+        FileSocket::release_session(session_id);
+    }
+    std::filesystem::current_path(directory.parent_path());
+    std::error_code error;
+    std::filesystem::remove_all(directory, error);
+    return test_result("session_snapshot_test");
+}
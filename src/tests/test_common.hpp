@@ -0,0 +1,30 @@
+#ifndef TEST_COMMON_HPP
+#define TEST_COMMON_HPP
+
+#include <cstdio>
+
+// Проверки тестов: несработавшая печатается с местом и засчитывается, тест идёт дальше.
+// main теста возвращает test_result(...) - 0, если проверок с ошибкой не было.
+inline int& test_failures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(condition)                                                                   \
+    do {                                                                                   \
+        if (!(condition)) {                                                                \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            ++test_failures();                                                             \
+        }                                                                                  \
+    } while (0)
+
+inline int test_result(const char* name) {
+    if (test_failures() != 0) {
+        std::printf("%s: %d check(s) failed\n", name, test_failures());
+        return 1;
+    }
+    std::printf("%s: ok\n", name);
+    return 0;
+}
+
+#endif
@@ -0,0 +1,151 @@
+// Колесо таймеров против эталона на std::map: случайные постановки, снятия и
+// продвижения времени (по тику и скачками через границы уровней) должны давать
+// те же сработавшие таймеры в том же порядке сроков.
+#include "test_common.hpp"
+#include "../server/timer_wheel.hpp"
+#include <algorithm>
+#include <map>
+#include <random>
+#include <vector>
+
+static const uint32_t TIMER_IDS = 5000;
+static const int OPERATIONS = 200000;
+
+struct Reference {
+    uint64_t now;
+    std::map<uint32_t, uint64_t> expires;   // id -> срок
+
+    // Те же правила округления срока, что у колеса
+    uint64_t clamp(uint64_t when) const {
+        if (when <= now) {
+            when = now + 1;
+        }
+        if (when - now > TimerWheel::MAX_DELAY) {
+            when = now + TimerWheel::MAX_DELAY;
+        }
+        return when;
+    }
+};
+
+// Задержки всех масштабов: внутри младшего уровня, у границ уровней, за MAX_DELAY
+static uint64_t random_delay(std::mt19937_64& random) {
+    int level = static_cast<int>(random() % (TimerWheel::LEVELS + 1));
+    uint64_t span = level < TimerWheel::LEVELS ? 1ull << (TimerWheel::SLOT_BITS * (level + 1))
+                                               : TimerWheel::MAX_DELAY * 2;
+    switch (random() % 4) {
+        case 0: return span - 1 - random() % 3;
+        case 1: return span + random() % 3;
+        default: return random() % span;
+    }
+}
+
+static uint64_t random_step(std::mt19937_64& random) {
+    switch (random() % 8) {
+        case 0: return random() % (1ull << (TimerWheel::SLOT_BITS * 2));
+        case 1: return random() % (1ull << (TimerWheel::SLOT_BITS * 3));
+        case 2: return 0;
+        default: return 1 + random() % 3;
+    }
+}
+
+static void check_advance(TimerWheel& wheel, Reference& reference, uint64_t now) {
+    std::vector<uint32_t> expired;
+    wheel.advance(now, expired);
+
+    std::vector<std::pair<uint64_t, uint32_t>> due;
+    for (auto it = reference.expires.begin(); it != reference.expires.end();) {
+        if (it->second <= now) {
+            due.push_back({it->second, it->first});
+            it = reference.expires.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    reference.now = now;
+
+    CHECK(expired.size() == due.size());
+    // Сроки сработавших не убывают; внутри одного тика порядок не задан
+    std::vector<std::pair<uint64_t, uint32_t>> fired;
+    uint64_t last = 0;
+    for (uint32_t id : expired) {
+        CHECK(!wheel.is_scheduled(id));
+        uint64_t when = wheel.expires(id);
+        CHECK(when >= last);
+        last = when;
+        fired.push_back({when, id});
+    }
+    std::sort(fired.begin(), fired.end());
+    std::sort(due.begin(), due.end());
+    CHECK(fired == due);
+}
+
+static void check_state(const TimerWheel& wheel, const Reference& reference) {
+    CHECK(wheel.now() == reference.now);
+    CHECK(wheel.size() == reference.expires.size());
+    if (reference.expires.empty()) {
+        CHECK(wheel.ticks_until_next() == 0);
+        return;
+    }
+    // Ближайшее срабатывание не раньше обещанного
+    uint64_t next = UINT64_MAX;
+    for (const auto& timer : reference.expires) {
+        next = std::min(next, timer.second);
+    }
+    uint64_t ticks = wheel.ticks_until_next();
+    CHECK(ticks > 0);
+    CHECK(reference.now + ticks <= next);
+}
+
+int main() {
+    std::mt19937_64 random(2024);
+    // Старт не с нуля и у границы старшего уровня - чтобы сразу пройти каскады
+    uint64_t start = (1ull << 30) - 5;
+    TimerWheel wheel(start);
+    Reference reference{start, {}};
+
+    for (int operation = 0; operation < OPERATIONS && test_failures() < 20; ++operation) {
+        uint32_t id = static_cast<uint32_t>(random() % TIMER_IDS);
+        switch (random() % 10) {
+            case 0:
+            case 1:
+            case 2:
+            case 3: {
+                uint64_t when = reference.now + random_delay(random);
+                wheel.schedule(id, when);
+                reference.expires[id] = reference.clamp(when);
+                CHECK(wheel.is_scheduled(id));
+                CHECK(wheel.expires(id) == reference.expires[id]);
+                break;
+            }
+            case 4:
+            case 5: {
+                // Срок в прошлом сдвигается на следующий тик
+                wheel.schedule(id, reference.now - random() % 4);
+                reference.expires[id] = reference.now + 1;
+                break;
+            }
+            case 6: {
+                wheel.cancel(id);
+                reference.expires.erase(id);
+                CHECK(!wheel.is_scheduled(id));
+                break;
+            }
+            default:
+                check_advance(wheel, reference, reference.now + random_step(random));
+                break;
+        }
+        check_state(wheel, reference);
+    }
+
+    // До конца: всё, что осталось, должно сработать ровно в свои сроки
+    while (!reference.expires.empty() && test_failures() < 20) {
+        uint64_t next = UINT64_MAX;
+        for (const auto& timer : reference.expires) {
+            next = std::min(next, timer.second);
+        }
+        check_advance(wheel, reference, next);
+        CHECK(wheel.size() == reference.expires.size());
+    }
+    CHECK(wheel.size() == 0);
+    return test_result("timer_wheel_test");
+}
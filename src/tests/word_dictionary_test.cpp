@@ -0,0 +1,109 @@
+// Скомпилированный словарь: открывается с теми же словами и WordInfo, что и
+// текстовый; любой испорченный байт, обрезанный файл и прежняя версия формата
+// отвергаются; слово с неверными границами при целой сумме не выдаётся.
+#include "test_common.hpp"
+#include "../game/word_dictionary.hpp"
+#include "../protocol/checksum.hpp"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+static const std::vector<std::string> WORDS = {"hangman", "Socket", "mmap", "futex", "rock'n'roll", "a",
+                                               "zzz", "abcdefghijklmnopqrstuvwxyz"};
+
+static void write_file(const std::string& filename, const std::vector<char>& data) {
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+static bool opens(const std::string& filename, const std::vector<char>& image) {
+    write_file(filename, image);
+    GameLogic::WordDictionary dictionary;
+    return dictionary.open_compiled(filename);
+}
+
+static GameLogic::DictionaryFileHeader read_header(const std::vector<char>& image) {
+    GameLogic::DictionaryFileHeader header;
+    std::memcpy(&header, image.data(), sizeof(header));
+    return header;
+}
+
+// Пересчитывает сумму - как если бы файл таким записал dict_compile
+static void reseal(std::vector<char>& image) {
+    GameLogic::DictionaryFileHeader header = read_header(image);
+    header.checksum = 0;
+    uint32_t crc = Protocol::crc32c(0, reinterpret_cast<const uint8_t*>(&header), sizeof(header));
+    header.checksum = Protocol::crc32c(crc, reinterpret_cast<const uint8_t*>(image.data()) + sizeof(header),
+                                       image.size() - sizeof(header));
+    std::memcpy(image.data(), &header, sizeof(header));
+}
+
+int main() {
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "hangman_dictionary_test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    std::string filename = (directory / "words.dict").string();
+    std::string text_filename = (directory / "words.txt").string();
+
+    const std::vector<char> image = GameLogic::compile_dictionary(WORDS);
+    write_file(filename, image);
+    {
+        std::ofstream text(text_filename);
+        for (const std::string& word : WORDS) {
+            text << word << '\n';
+        }
+    }
+
+    // Файл и текст дают один и тот же словарь
+    GameLogic::WordDictionary compiled;
+    GameLogic::WordDictionary text;
+    CHECK(compiled.open_compiled(filename));
+    CHECK(text.load_text(text_filename));
+    CHECK(compiled.size() == WORDS.size());
+    CHECK(compiled.fingerprint() == text.fingerprint());
+    for (size_t i = 0; i < WORDS.size(); ++i) {
+        CHECK(compiled.word(i) == WORDS[i]);
+        GameLogic::WordInfo expected = GameLogic::make_word_info(WORDS[i]);
+        GameLogic::WordInfo info = compiled.info(i);
+        CHECK(std::memcmp(&info, &expected, sizeof(info)) == 0);
+    }
+    CHECK(compiled.word(WORDS.size()).empty());
+
+    // Любой испорченный байт (заголовок, смещения, WordInfo, пул, сама сумма)
+    for (size_t i = 0; i < image.size(); ++i) {
+        std::vector<char> damaged = image;
+        damaged[i] ^= 0x10;
+        CHECK(!opens(filename, damaged));
+    }
+    CHECK(!opens(filename, std::vector<char>(image.begin(), image.end() - 1)));
+    std::vector<char> longer = image;
+    longer.push_back(0);
+    CHECK(!opens(filename, longer));
+
+    // Прежняя версия формата (без суммы) не открывается, даже с верной суммой
+    std::vector<char> old_version = image;
+    GameLogic::DictionaryFileHeader header = read_header(old_version);
+    header.version = 1;
+    std::memcpy(old_version.data(), &header, sizeof(header));
+    reseal(old_version);
+    CHECK(!opens(filename, old_version));
+
+    // Сумма верна, но смещение слова за концом пула: файл открывается, слово не выдаётся
+    std::vector<char> bad_offset = image;
+    uint32_t offset = static_cast<uint32_t>(header.pool_size + 5);
+    std::memcpy(&bad_offset[header.offsets_offset + sizeof(uint32_t)], &offset, sizeof(offset));
+    reseal(bad_offset);
+    write_file(filename, bad_offset);
+    GameLogic::WordDictionary damaged;
+    CHECK(damaged.open_compiled(filename));
+    CHECK(damaged.word(0).empty());
+    CHECK(damaged.word(1).empty());
+    CHECK(damaged.word(2) == WORDS[2]);
+
+    std::error_code error;
+    std::filesystem::remove_all(directory, error);
+    return test_result("word_dictionary_test");
+}
@@ -0,0 +1,106 @@
+// Уровни сложности WordSelector: ключ растёт с ошибками частотного игрока, затем
+// с уменьшением числа разных букв, затем с уменьшением длины; уровни - подряд
+// идущие трети словаря по ключу, и выбор из уровня не выходит за его границы.
+#include "test_common.hpp"
+#include "../game/word_selector.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+static const int PICKS = 20000;
+
+static uint32_t key(const char* word) {
+    return GameLogic::WordSelector::difficulty_key(GameLogic::make_word_info(word));
+}
+
+static bool load_words(GameLogic::WordDictionary& dictionary, const std::vector<std::string>& words) {
+    std::string filename = (std::filesystem::temp_directory_path() / "word_selector_test.txt").string();
+    {
+        std::ofstream file(filename);
+        for (const std::string& word : words) {
+            file << word << '\n';
+        }
+    }
+    bool loaded = dictionary.load_text(filename);
+    std::remove(filename.c_str());
+    return loaded;
+}
+
+static void check_key_order() {
+    // Одинаковые ошибки (буквы - начало частотного порядка) и длина: меньше разных букв - сложнее
+    CHECK(GameLogic::WordSelector::frequency_misses(GameLogic::make_word_info("eeee").letter_mask) == 0);
+    CHECK(GameLogic::WordSelector::frequency_misses(GameLogic::make_word_info("etet").letter_mask) == 0);
+    CHECK(key("eeee") > key("etet"));
+    CHECK(key("etet") > key("etae"));
+    // Число разных букв важнее длины, длина решает при прочих равных
+    CHECK(key("eeeeeeee") > key("et"));
+    CHECK(key("tete") > key("tetete"));
+    // Ошибки важнее всего
+    CHECK(key("zzzzzzzz") > key("etaoinsh"));
+    CHECK(key("jazz") > key("eeee"));
+    // Ключ в пределах таблицы подсчёта даже для предельных слов
+    CHECK(key(std::string(255, 'q').c_str()) < GameLogic::WordSelector::DIFFICULTY_KEYS);
+    CHECK(key("abcdefghijklmnopqrstuvwxyz") < GameLogic::WordSelector::DIFFICULTY_KEYS);
+}
+
+// Слова с равными ошибками и длиной расходятся по уровням только по числу разных букв
+static void check_distinct_tiers() {
+    GameLogic::WordDictionary dictionary;
+    CHECK(load_words(dictionary, {"etaeta", "eeeeee", "etetet", "aetaet", "eeeeee", "tetete",
+                                  "eteeet", "aaetae", "eeeeee"}));
+    GameLogic::WordSelector selector(dictionary);
+    for (uint8_t tier = 1; tier <= GameLogic::DIFFICULTY_TIERS; ++tier) {
+        CHECK(selector.tier_size(tier) == 3);
+    }
+    for (int i = 0; i < 1000; ++i) {
+        CHECK(dictionary.info(selector.pick_index(1)).distinct_letters == 3);
+        CHECK(dictionary.info(selector.pick_index(2)).distinct_letters == 2);
+        CHECK(dictionary.info(selector.pick_index(3)).distinct_letters == 1);
+    }
+}
+
+// Выбор из уровня t не сложнее любого выбора из уровня t + 1
+static void check_tier_ranges() {
+    std::mt19937 random(14);
+    std::vector<std::string> words;
+    for (int i = 0; i < 900; ++i) {
+        std::string word;
+        size_t length = 2 + random() % 12;
+        size_t alphabet = 1 + random() % 26;
+        for (size_t j = 0; j < length; ++j) {
+            word += static_cast<char>('a' + random() % alphabet);
+        }
+        words.push_back(word);
+    }
+    GameLogic::WordDictionary dictionary;
+    CHECK(load_words(dictionary, words));
+    GameLogic::WordSelector selector(dictionary);
+
+    size_t total = 0;
+    uint32_t previous_max = 0;
+    for (uint8_t tier = 1; tier <= GameLogic::DIFFICULTY_TIERS; ++tier) {
+        total += selector.tier_size(tier);
+        uint32_t min_key = UINT32_MAX;
+        uint32_t max_key = 0;
+        for (int i = 0; i < PICKS; ++i) {
+            uint32_t word_key = GameLogic::WordSelector::difficulty_key(dictionary.info(selector.pick_index(tier)));
+            min_key = std::min(min_key, word_key);
+            max_key = std::max(max_key, word_key);
+        }
+        CHECK(previous_max <= min_key);
+        previous_max = max_key;
+    }
+    CHECK(total == dictionary.size());
+    CHECK(selector.tier_size(GameLogic::DIFFICULTY_ANY) == dictionary.size());
+}
+
+int main() {
+    check_key_order();
+    check_distinct_tiers();
+    check_tier_ranges();
+    return test_result("word_selector_test");
+}
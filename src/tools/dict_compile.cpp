@@ -0,0 +1,57 @@
+// Компиляция текстового словаря (слово на строку) в бинарный формат,
+// который сервер отображает в память: dict_compile words.txt words.dict
+#include "../game/word_dictionary.hpp"
+#include "../game/game_logic.hpp"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cout << "Usage: " << argv[0] << " <words.txt> <words.dict>" << std::endl;
+        return 1;
+    }
+    std::string input = argv[1];
+    std::string output = argv[2];
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::string> words = GameLogic::Dictionary::load_words(input);
+    if (words.empty()) {
+        std::cout << "Error: no words in " << input << std::endl;
+        return 1;
+    }
+    std::vector<char> image = GameLogic::compile_dictionary(words);
+
+    // Пишем во временный файл и переименовываем: работающий сервер
+    // никогда не увидит недописанный словарь
+    std::string temporary = output + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        file.write(image.data(), static_cast<std::streamsize>(image.size()));
+        if (!file) {
+            std::cout << "Error: cannot write " << temporary << std::endl;
+            return 1;
+        }
+    }
+#ifdef _WIN32
+    std::remove(output.c_str()); // rename в Windows не заменяет существующий файл
+#endif
+    if (std::rename(temporary.c_str(), output.c_str()) != 0) {
+        std::cout << "Error: cannot rename " << temporary << " to " << output << std::endl;
+        return 1;
+    }
+
+    GameLogic::WordDictionary dictionary;
+    if (!dictionary.open_compiled(output)) {
+        std::cout << "Error: " << output << " is not readable after compilation" << std::endl;
+        return 1;
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    std::cout << "Compiled " << dictionary.size() << " words (" << image.size() << " bytes) into "
+              << output << " in " << elapsed.count() << " ms" << std::endl;
+    return 0;
+}
@@ -0,0 +1,370 @@
+// Просмотр статистики работающего сервера в духе top. Область IPC::STATS_SLOT
+// файла-сокета отображается только для чтения; скорости считаются по разнице
+// двух снимков. Сервер об этом не знает и ничего лишнего не делает.
+#include "../ipc/ipc_common.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Заголовок файла и область статистики - первые два слота блока 0
+static const size_t STATS_VIEW_SIZE = (IPC::STATS_SLOT + 1) * IPC::SESSION_REGION_SIZE;
+
+class StatsView {
+private:
+    const char* data_;
+
+public:
+    StatsView() : data_(nullptr) {}
+    ~StatsView() { close(); }
+
+    bool is_open() const { return data_ != nullptr; }
+
+#ifdef _WIN32
+    bool open(const std::string& filename) {
+        HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                                  NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        LARGE_INTEGER size;
+        HANDLE mapping = NULL;
+        if (GetFileSizeEx(file, &size) && size.QuadPart >= static_cast<LONGLONG>(STATS_VIEW_SIZE)) {
+            mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, static_cast<DWORD>(STATS_VIEW_SIZE), NULL);
+        }
+        CloseHandle(file);
+        if (mapping == NULL) {
+            return false;
+        }
+        data_ = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, STATS_VIEW_SIZE));
+        CloseHandle(mapping);
+        return data_ != nullptr;
+    }
+
+    void close() {
+        if (data_ != nullptr) {
+            UnmapViewOfFile(data_);
+            data_ = nullptr;
+        }
+    }
+#else
+    bool open(const std::string& filename) {
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        // Отображение за концом файла дало бы SIGBUS при чтении
+        struct stat st;
+        void* view = MAP_FAILED;
+        if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= STATS_VIEW_SIZE) {
+            view = mmap(nullptr, STATS_VIEW_SIZE, PROT_READ, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+        if (view == MAP_FAILED) {
+            return false;
+        }
+        data_ = static_cast<const char*>(view);
+        return true;
+    }
+
+    void close() {
+        if (data_ != nullptr) {
+            munmap(const_cast<char*>(data_), STATS_VIEW_SIZE);
+            data_ = nullptr;
+        }
+    }
+#endif
+
+    const IPC::SocketFileHeader* header() const {
+        return reinterpret_cast<const IPC::SocketFileHeader*>(data_);
+    }
+
+    const IPC::StatsRegion* stats() const {
+        return reinterpret_cast<const IPC::StatsRegion*>(data_ + IPC::get_slot_file_offset(IPC::STATS_SLOT));
+    }
+
+    StatsView(const StatsView&) = delete;
+    StatsView& operator=(const StatsView&) = delete;
+};
+
+// Копия счётчиков на момент чтения
+struct WorkerSnapshot {
+    uint64_t messages[IPC::StatsMessage::KINDS];
+    uint64_t duplicates;
+    uint64_t guesses;
+    uint64_t games_won;
+    uint64_t games_lost;
+    uint64_t active_sessions;
+    uint64_t busy_ns;
+    uint64_t idle_ns;
+    uint64_t cleanups;
+    uint64_t cleanup_ns;
+    uint64_t cleanup_max_ns;
+    uint64_t latency[IPC::STATS_LATENCY_BUCKETS];
+};
+
+struct StatsSnapshot {
+    bool valid;
+    uint64_t started_ms;
+    uint64_t server_pid;
+    uint32_t worker_count;
+    uint64_t lock_contended;
+    uint64_t lock_retries;
+    uint64_t lock_failures;
+    uint64_t lock_wait_ns;
+    WorkerSnapshot workers[IPC::MAX_SERVER_WORKERS];
+    WorkerSnapshot total;
+    std::chrono::steady_clock::time_point taken;
+};
+
+static uint64_t load(const std::atomic<uint64_t>& counter) {
+    return counter.load(std::memory_order_relaxed);
+}
+
+static void add_worker(WorkerSnapshot& total, const WorkerSnapshot& worker) {
+    for (int k = 0; k < IPC::StatsMessage::KINDS; ++k) {
+        total.messages[k] += worker.messages[k];
+    }
+    total.duplicates += worker.duplicates;
+    total.guesses += worker.guesses;
+    total.games_won += worker.games_won;
+    total.games_lost += worker.games_lost;
+    total.active_sessions += worker.active_sessions;
+    total.busy_ns += worker.busy_ns;
+    total.idle_ns += worker.idle_ns;
+    total.cleanups += worker.cleanups;
+    total.cleanup_ns += worker.cleanup_ns;
+    if (worker.cleanup_max_ns > total.cleanup_max_ns) {
+        total.cleanup_max_ns = worker.cleanup_max_ns;
+    }
+    for (int b = 0; b < IPC::STATS_LATENCY_BUCKETS; ++b) {
+        total.latency[b] += worker.latency[b];
+    }
+}
+
+static void take_snapshot(const StatsView& view, StatsSnapshot& snapshot) {
+    snapshot = StatsSnapshot();
+    snapshot.taken = std::chrono::steady_clock::now();
+
+    const IPC::SocketFileHeader* header = view.header();
+    const IPC::StatsRegion* stats = view.stats();
+    snapshot.started_ms = stats->started_ms.load(std::memory_order_acquire);
+    snapshot.valid = header->magic.load(std::memory_order_acquire) == IPC::SOCKET_FILE_MAGIC &&
+                     header->version.load(std::memory_order_acquire) == IPC::SOCKET_FILE_VERSION &&
+                     snapshot.started_ms != 0;
+    if (!snapshot.valid) {
+        return;
+    }
+
+    snapshot.server_pid = load(stats->server_pid);
+    snapshot.worker_count = header->worker_count.load(std::memory_order_acquire);
+    if (snapshot.worker_count > static_cast<uint32_t>(IPC::MAX_SERVER_WORKERS)) {
+        snapshot.worker_count = IPC::MAX_SERVER_WORKERS;
+    }
+    snapshot.lock_contended = load(stats->lock_contended);
+    snapshot.lock_retries = load(stats->lock_retries);
+    snapshot.lock_failures = load(stats->lock_failures);
+    snapshot.lock_wait_ns = load(stats->lock_wait_ns);
+
+    for (uint32_t w = 0; w < snapshot.worker_count; ++w) {
+        const IPC::WorkerStats& source = stats->workers[w];
+        WorkerSnapshot& worker = snapshot.workers[w];
+        for (int k = 0; k < IPC::StatsMessage::KINDS; ++k) {
+            worker.messages[k] = load(source.messages[k]);
+        }
+        worker.duplicates = load(source.duplicates);
+        worker.guesses = load(source.guesses);
+        worker.games_won = load(source.games_won);
+        worker.games_lost = load(source.games_lost);
+        worker.active_sessions = load(source.active_sessions);
+        worker.busy_ns = load(source.busy_ns);
+        worker.idle_ns = load(source.idle_ns);
+        worker.cleanups = load(source.cleanups);
+        worker.cleanup_ns = load(source.cleanup_ns);
+        worker.cleanup_max_ns = load(source.cleanup_max_ns);
+        for (int b = 0; b < IPC::STATS_LATENCY_BUCKETS; ++b) {
+            worker.latency[b] = load(source.latency[b]);
+        }
+        add_worker(snapshot.total, worker);
+    }
+}
+
+// Разность счётчиков; при перезапуске сервера они начинаются с нуля
+static uint64_t delta(uint64_t now, uint64_t before) {
+    return now >= before ? now - before : now;
+}
+
+// Корзина гистограммы, в которую попал перцентиль; -1 - сообщений не было
+static int latency_percentile_bucket(const WorkerSnapshot& now, const WorkerSnapshot& before, double percentile) {
+    uint64_t counts[IPC::STATS_LATENCY_BUCKETS];
+    uint64_t total = 0;
+    for (int b = 0; b < IPC::STATS_LATENCY_BUCKETS; ++b) {
+        counts[b] = delta(now.latency[b], before.latency[b]);
+        total += counts[b];
+    }
+    if (total == 0) {
+        return -1;
+    }
+    uint64_t rank = static_cast<uint64_t>(total * percentile / 100.0 + 0.5);
+    uint64_t seen = 0;
+    for (int b = 0; b < IPC::STATS_LATENCY_BUCKETS; ++b) {
+        seen += counts[b];
+        if (seen >= rank && counts[b] != 0) {
+            return b;
+        }
+    }
+    return IPC::STATS_LATENCY_BUCKETS - 1;
+}
+
+// Граница корзины в микросекундах: "<верхняя", для последней - ">нижняя"
+static std::string format_latency(int bucket) {
+    if (bucket < 0) {
+        return "-";
+    }
+    char text[32];
+    if (bucket < IPC::STATS_LATENCY_BUCKETS - 1) {
+        std::snprintf(text, sizeof(text), "<%.0f", (1ull << (bucket + 10)) / 1000.0);
+    } else {
+        std::snprintf(text, sizeof(text), ">%.0f", (1ull << (bucket + 9)) / 1000.0);
+    }
+    return text;
+}
+
+static void print_row(const char* name, const WorkerSnapshot& now, const WorkerSnapshot& before, double seconds) {
+    double rates[IPC::StatsMessage::KINDS];
+    for (int k = 0; k < IPC::StatsMessage::KINDS; ++k) {
+        rates[k] = delta(now.messages[k], before.messages[k]) / seconds;
+    }
+    uint64_t busy = delta(now.busy_ns, before.busy_ns) + delta(now.cleanup_ns, before.cleanup_ns);
+    uint64_t idle = delta(now.idle_ns, before.idle_ns);
+    double busy_percent = busy + idle > 0 ? 100.0 * busy / (busy + idle) : 0.0;
+
+    double cleanup_avg_ms = now.cleanups > 0 ? now.cleanup_ns / 1e6 / now.cleanups : 0.0;
+
+    std::printf("%-7s %8llu %8.0f %8.0f %8.0f %8.0f %9.0f %8llu %8llu %6.1f %7s %7s %8.2f %8.2f\n",
+                name, static_cast<unsigned long long>(now.active_sessions),
+                rates[IPC::StatsMessage::START], rates[IPC::StatsMessage::GUESS],
+                rates[IPC::StatsMessage::BATCH], rates[IPC::StatsMessage::INVALID],
+                delta(now.guesses, before.guesses) / seconds,
+                static_cast<unsigned long long>(now.games_won), static_cast<unsigned long long>(now.games_lost),
+                busy_percent, format_latency(latency_percentile_bucket(now, before, 50)).c_str(),
+                format_latency(latency_percentile_bucket(now, before, 99)).c_str(),
+                cleanup_avg_ms, now.cleanup_max_ns / 1e6);
+}
+
+static void print_screen(const StatsSnapshot& now, const StatsSnapshot& before, bool clear) {
+    if (clear) {
+        std::printf("\033[H\033[2J");
+    }
+
+    double seconds = std::chrono::duration<double>(now.taken - before.taken).count();
+    if (seconds <= 0) {
+        seconds = 1;
+    }
+
+    uint64_t now_ms = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    uint64_t uptime = now_ms > now.started_ms ? (now_ms - now.started_ms) / 1000 : 0;
+    std::printf("hangman-top - server pid %llu, up %llu:%02llu:%02llu, %u worker(s), interval %.1f s\n\n",
+                static_cast<unsigned long long>(now.server_pid),
+                static_cast<unsigned long long>(uptime / 3600),
+                static_cast<unsigned long long>(uptime / 60 % 60),
+                static_cast<unsigned long long>(uptime % 60), now.worker_count, seconds);
+
+    std::printf("%-7s %8s %8s %8s %8s %8s %9s %8s %8s %6s %7s %7s %8s %8s\n",
+                "worker", "sessions", "start/s", "guess/s", "batch/s", "inval/s", "letters/s",
+                "won", "lost", "busy%", "p50us", "p99us", "clean ms", "max ms");
+    for (uint32_t w = 0; w < now.worker_count; ++w) {
+        std::string name = std::to_string(w);
+        print_row(name.c_str(), now.workers[w], before.workers[w], seconds);
+    }
+    if (now.worker_count > 1) {
+        print_row("total", now.total, before.total, seconds);
+    }
+
+    std::printf("\nduplicates %llu (+%llu)\n",
+                static_cast<unsigned long long>(now.total.duplicates),
+                static_cast<unsigned long long>(delta(now.total.duplicates, before.total.duplicates)));
+    std::printf("file locks: contended %llu (+%llu), retries %llu (+%llu), failures %llu (+%llu), wait %.1f ms (+%.1f)\n",
+                static_cast<unsigned long long>(now.lock_contended),
+                static_cast<unsigned long long>(delta(now.lock_contended, before.lock_contended)),
+                static_cast<unsigned long long>(now.lock_retries),
+                static_cast<unsigned long long>(delta(now.lock_retries, before.lock_retries)),
+                static_cast<unsigned long long>(now.lock_failures),
+                static_cast<unsigned long long>(delta(now.lock_failures, before.lock_failures)),
+                now.lock_wait_ns / 1e6, delta(now.lock_wait_ns, before.lock_wait_ns) / 1e6);
+    std::fflush(stdout);
+}
+
+int main(int argc, char* argv[]) {
+    std::string filename = IPC::SOCKET_FILE;
+    int interval_ms = 1000;
+    long count = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--interval" && i + 1 < argc) {
+            interval_ms = std::atoi(argv[++i]);
+        } else if (arg == "--count" && i + 1 < argc) {
+            count = std::atol(argv[++i]);
+        } else if (arg == "--file" && i + 1 < argc) {
+            filename = argv[++i];
+        } else {
+            std::printf("Usage: %s [--interval MS] [--count N (0 - until interrupted)] [--file %s]\n",
+                        argv[0], IPC::SOCKET_FILE.c_str());
+            return 1;
+        }
+    }
+    if (interval_ms <= 0 || count < 0) {
+        std::printf("Error: interval must be positive\n");
+        return 1;
+    }
+
+#ifdef _WIN32
+    bool clear = false;
+#else
+    bool clear = isatty(STDOUT_FILENO) != 0;
+#endif
+
+    StatsView view;
+    StatsSnapshot before;
+    StatsSnapshot now;
+    before.valid = false;
+    for (long shown = 0; count == 0 || shown < count; ) {
+        // С --count нужен снимок здесь и сейчас, без ожидания сервера
+        if (!view.is_open() && !view.open(filename)) {
+            std::printf("Waiting for %s...\n", filename.c_str());
+            if (count != 0) {
+                return 1;
+            }
+            before.valid = false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+            continue;
+        }
+
+        take_snapshot(view, now);
+        if (!now.valid) {
+            std::printf("No running server in %s\n", filename.c_str());
+            if (count != 0) {
+                return 1;
+            }
+        } else if (before.valid && before.started_ms == now.started_ms) {
+            print_screen(now, before, clear);
+            ++shown;
+        }
+        before = now;
+        if (count == 0 || shown < count) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+        }
+    }
+    return 0;
+}
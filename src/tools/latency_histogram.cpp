@@ -0,0 +1,64 @@
+#include "latency_histogram.hpp"
+#include <algorithm>
+
+LatencyHistogram::LatencyHistogram()
+    : counts_(static_cast<size_t>(MAGNITUDES + 1) * SUB_BUCKETS, 0), total_(0), min_(UINT64_MAX), max_(0), sum_(0) {}
+
+// Значения меньше 64 лежат в нулевой степени точно; дальше степень -
+// номер старшего бита, ячейка - следующие 6 бит
+size_t LatencyHistogram::bucket_index(uint64_t value) {
+    if (value < static_cast<uint64_t>(SUB_BUCKETS)) {
+        return static_cast<size_t>(value);
+    }
+    int top_bit = 63;
+    while (((value >> top_bit) & 1) == 0) {
+        --top_bit;
+    }
+    int magnitude = top_bit - SUB_BUCKET_BITS + 1;
+    uint64_t sub_bucket = (value >> (magnitude - 1)) & (SUB_BUCKETS - 1);
+    return static_cast<size_t>(magnitude) * SUB_BUCKETS + static_cast<size_t>(sub_bucket);
+}
+
+uint64_t LatencyHistogram::bucket_upper_bound(size_t index) {
+    size_t magnitude = index / SUB_BUCKETS;
+    uint64_t sub_bucket = index % SUB_BUCKETS;
+    if (magnitude == 0) {
+        return sub_bucket;
+    }
+    uint64_t low = (static_cast<uint64_t>(SUB_BUCKETS) | sub_bucket) << (magnitude - 1);
+    return low + ((1ull << (magnitude - 1)) - 1);
+}
+
+void LatencyHistogram::record(uint64_t value_ns) {
+    ++counts_[bucket_index(value_ns)];
+    ++total_;
+    min_ = std::min(min_, value_ns);
+    max_ = std::max(max_, value_ns);
+    sum_ += static_cast<double>(value_ns);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < counts_.size(); ++i) {
+        counts_[i] += other.counts_[i];
+    }
+    total_ += other.total_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+    sum_ += other.sum_;
+}
+
+uint64_t LatencyHistogram::percentile(double percentile) const {
+    if (total_ == 0) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(total_) + 0.5);
+    rank = std::max<uint64_t>(rank, 1);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts_.size(); ++i) {
+        seen += counts_[i];
+        if (seen >= rank) {
+            return std::min(bucket_upper_bound(i), max_);
+        }
+    }
+    return max_;
+}
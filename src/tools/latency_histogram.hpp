@@ -0,0 +1,41 @@
+#ifndef LATENCY_HISTOGRAM_HPP
+#define LATENCY_HISTOGRAM_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Гистограмма задержек в духе HdrHistogram: значения в наносекундах
+// раскладываются по степеням двойки, каждая степень делится на 64 равные
+// ячейки. Относительная ошибка не больше 1/64 (~1.6%) на всём диапазоне,
+// запись - несколько целочисленных операций, памяти - 30 КБ.
+class LatencyHistogram {
+private:
+    static const int SUB_BUCKET_BITS = 6;
+    static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static const int MAGNITUDES = 64 - SUB_BUCKET_BITS;
+
+    std::vector<uint64_t> counts_;
+    uint64_t total_;
+    uint64_t min_;
+    uint64_t max_;
+    double sum_;
+
+    static size_t bucket_index(uint64_t value);
+    static uint64_t bucket_upper_bound(size_t index);
+
+public:
+    LatencyHistogram();
+
+    void record(uint64_t value_ns);
+    void merge(const LatencyHistogram& other);
+
+    uint64_t count() const { return total_; }
+    uint64_t min() const { return total_ != 0 ? min_ : 0; }
+    uint64_t max() const { return max_; }
+    double mean() const { return total_ != 0 ? sum_ / total_ : 0; }
+    // Верхняя граница ячейки, в которую попал percentile-й процент значений
+    uint64_t percentile(double percentile) const;
+};
+
+#endif
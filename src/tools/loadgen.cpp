@@ -0,0 +1,294 @@
+// Генератор нагрузки: N клиентов в отдельных потоках играют через настоящие
+// send_binary_ping/receive_binary_message с заданной суммарной частотой запросов.
+// Задержка ping->pong считается от запланированного момента отправки, а не от
+// фактического: если сервер тормозит, очередь запросов копится в задержке,
+// а не прячется (поправка на coordinated omission).
+#include "latency_histogram.hpp"
+#include "../protocol/protocol.hpp"
+#include "../protocol/codec.hpp"
+#include "../ipc/file_socket.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct LoadOptions {
+    int clients = 8;
+    double rate = 0;        // запросов в секунду на всех; 0 - без ограничения
+    double duration = 10;   // секунд
+    int timeout_ms = 1000;
+    int retries = 2;
+    std::string json_file;
+};
+
+struct ClientStats {
+    LatencyHistogram latency;
+    uint64_t requests = 0;
+    uint64_t timeouts = 0;   // запросы, на которые не пришёл ответ и после повторов
+    uint64_t retries = 0;
+    uint64_t errors = 0;     // ERROR_STATE или неразборчивый ответ
+    uint64_t games = 0;
+};
+
+typedef std::chrono::steady_clock Clock;
+
+// Статус игры из ответа без выделения памяти; 0 - ответ не разобран
+static uint8_t reply_status(const Protocol::BinaryMessage& reply) {
+    Protocol::ByteSpan payload{reply.payload.data(), reply.payload.size()};
+    if (!reply.payload.empty() && reply.payload[0] == Protocol::PayloadType::COMPACT_STATE) {
+        Protocol::CompactStateView state;
+        return Protocol::decode_compact_state(payload, state) ? state.status : 0;
+    }
+    Protocol::GameStateView state;
+    return Protocol::decode_game_state(payload, state) ? state.status : 0;
+}
+
+// Отправка с повторами: ответы на прошлые (просроченные) запросы пропускаются.
+// Повтор уходит с новым sequence - сервер не отвечает на дубликаты.
+static bool exchange(uint32_t session_id, uint32_t& sequence, const std::string& payload,
+                     Protocol::ChecksumType& checksum, Protocol::BinaryMessage& reply,
+                     const LoadOptions& options, ClientStats& stats) {
+    for (int attempt = 0; attempt <= options.retries; ++attempt) {
+        if (attempt > 0) {
+            ++stats.retries;
+        }
+        uint32_t request_sequence = sequence++;
+        if (!Protocol::send_binary_ping(session_id, request_sequence, payload, checksum)) {
+            continue;
+        }
+
+        auto deadline = Clock::now() + std::chrono::milliseconds(options.timeout_ms);
+        while (true) {
+            int left_ms = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - Clock::now()).count());
+            if (left_ms <= 0 || !Protocol::receive_binary_message(session_id, reply, left_ms)) {
+                break;
+            }
+            if (reply.header.sequence == request_sequence) {
+                if (reply.checksum == Protocol::ChecksumType::CRC32C) {
+                    checksum = Protocol::ChecksumType::CRC32C;
+                }
+                return true;
+            }
+        }
+    }
+    ++stats.timeouts;
+    return false;
+}
+
+// Клиент играет партию за партией: start, затем буквы по порядку до конца игры
+static void run_client(int index, uint32_t session_id, const LoadOptions& options, Clock::time_point start,
+                       Clock::time_point stop, std::atomic<bool>& failed, ClientStats& stats) {
+    if (!FileSocket::connect_session(session_id)) {
+        failed.store(true);
+        return;
+    }
+
+    Protocol::BinaryMessage reply;
+    Protocol::ChecksumType checksum = Protocol::ChecksumType::XOR;
+    uint32_t sequence = 1;
+    bool in_game = false;
+    char next_letter = 'a';
+    std::string payload;
+
+    // Каждый клиент отправляет с шагом clients/rate, клиенты сдвинуты друг от друга
+    Clock::duration interval = Clock::duration::zero();
+    Clock::time_point scheduled = start;
+    if (options.rate > 0) {
+        interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.clients / options.rate));
+        scheduled += interval * index / options.clients;
+    }
+
+    while (true) {
+        if (options.rate > 0) {
+            if (scheduled >= stop) {
+                break;
+            }
+            std::this_thread::sleep_until(scheduled);
+        } else {
+            scheduled = Clock::now();
+            if (scheduled >= stop) {
+                break;
+            }
+        }
+
+        if (!in_game) {
+            payload = "start";
+            sequence = 1;
+        } else {
+            payload.assign(1, next_letter);
+        }
+
+        ++stats.requests;
+        bool answered = exchange(session_id, sequence, payload, checksum, reply, options, stats);
+        if (answered) {
+            stats.latency.record(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - scheduled).count()));
+
+            uint8_t status = reply_status(reply);
+            if (status == Protocol::GameStatus::IN_PROGRESS) {
+                if (!in_game) {
+                    ++stats.games;
+                    next_letter = 'a';
+                } else {
+                    ++next_letter;
+                }
+                in_game = next_letter <= 'z';
+            } else if (status == Protocol::GameStatus::WIN || status == Protocol::GameStatus::LOSE) {
+                in_game = false;
+            } else {
+                // Отказ на start - обычно "Game already in progress" после потерянного
+                // ответа: доигрываем партию буквами с начала алфавита. Отказ на букву
+                // (сессия удалена) - начинаем новую игру.
+                ++stats.errors;
+                next_letter = 'a';
+                in_game = !in_game;
+            }
+        } else {
+            in_game = false;
+        }
+
+        scheduled += interval;
+    }
+
+    FileSocket::release_session(session_id);
+}
+
+static void print_report(const LoadOptions& options, const ClientStats& total, double seconds) {
+    const double percentiles[] = {50, 90, 99, 99.9};
+    if (options.rate > 0) {
+        std::printf("clients %d, target rate %.0f req/s, duration %.1f s\n", options.clients, options.rate, seconds);
+    } else {
+        std::printf("clients %d, unlimited rate, duration %.1f s\n", options.clients, seconds);
+    }
+    std::printf("requests %llu, replies %llu, throughput %.0f req/s, games %llu\n",
+                static_cast<unsigned long long>(total.requests),
+                static_cast<unsigned long long>(total.latency.count()),
+                seconds > 0 ? total.latency.count() / seconds : 0.0,
+                static_cast<unsigned long long>(total.games));
+    std::printf("timeouts %llu, retries %llu, errors %llu\n",
+                static_cast<unsigned long long>(total.timeouts),
+                static_cast<unsigned long long>(total.retries),
+                static_cast<unsigned long long>(total.errors));
+    std::printf("latency us: min %.1f mean %.1f", total.latency.min() / 1000.0, total.latency.mean() / 1000.0);
+    for (double p : percentiles) {
+        std::printf(" p%g %.1f", p, total.latency.percentile(p) / 1000.0);
+    }
+    std::printf(" max %.1f\n", total.latency.max() / 1000.0);
+}
+
+static bool write_json(const LoadOptions& options, const ClientStats& total, double seconds) {
+    FILE* file = options.json_file == "-" ? stdout : std::fopen(options.json_file.c_str(), "w");
+    if (file == nullptr) {
+        return false;
+    }
+    std::fprintf(file,
+                 "{\n"
+                 "  \"clients\": %d,\n"
+                 "  \"target_rate\": %.1f,\n"
+                 "  \"duration_s\": %.3f,\n"
+                 "  \"requests\": %llu,\n"
+                 "  \"replies\": %llu,\n"
+                 "  \"throughput_rps\": %.1f,\n"
+                 "  \"games\": %llu,\n"
+                 "  \"timeouts\": %llu,\n"
+                 "  \"retries\": %llu,\n"
+                 "  \"errors\": %llu,\n"
+                 "  \"latency_ns\": {\"min\": %llu, \"mean\": %.0f, \"p50\": %llu, \"p90\": %llu, "
+                 "\"p99\": %llu, \"p99_9\": %llu, \"max\": %llu}\n"
+                 "}\n",
+                 options.clients, options.rate, seconds,
+                 static_cast<unsigned long long>(total.requests),
+                 static_cast<unsigned long long>(total.latency.count()),
+                 seconds > 0 ? total.latency.count() / seconds : 0.0,
+                 static_cast<unsigned long long>(total.games),
+                 static_cast<unsigned long long>(total.timeouts),
+                 static_cast<unsigned long long>(total.retries),
+                 static_cast<unsigned long long>(total.errors),
+                 static_cast<unsigned long long>(total.latency.min()), total.latency.mean(),
+                 static_cast<unsigned long long>(total.latency.percentile(50)),
+                 static_cast<unsigned long long>(total.latency.percentile(90)),
+                 static_cast<unsigned long long>(total.latency.percentile(99)),
+                 static_cast<unsigned long long>(total.latency.percentile(99.9)),
+                 static_cast<unsigned long long>(total.latency.max()));
+    if (file != stdout) {
+        std::fclose(file);
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    LoadOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (value != nullptr && arg == "--clients") {
+            options.clients = std::atoi(value);
+        } else if (value != nullptr && arg == "--rate") {
+            options.rate = std::atof(value);
+        } else if (value != nullptr && arg == "--duration") {
+            options.duration = std::atof(value);
+        } else if (value != nullptr && arg == "--timeout") {
+            options.timeout_ms = std::atoi(value);
+        } else if (value != nullptr && arg == "--retries") {
+            options.retries = std::atoi(value);
+        } else if (value != nullptr && arg == "--json") {
+            options.json_file = value;
+        } else {
+            std::printf("Usage: %s [--clients N] [--rate REQ_PER_S (0 - unlimited)] [--duration S]"
+                        " [--timeout MS] [--retries K] [--json FILE|-]\n", argv[0]);
+            return 1;
+        }
+        ++i;
+    }
+    if (options.clients <= 0 || options.duration <= 0 || options.timeout_ms <= 0 || options.retries < 0) {
+        std::printf("Error: clients, duration and timeout must be positive\n");
+        return 1;
+    }
+
+    // Идентификаторы сессий подряд от случайной базы, чтобы не пересечься с другими запусками
+    std::random_device device;
+    uint32_t base = device() & 0x7FFF0000u;
+
+    std::vector<ClientStats> stats(options.clients);
+    std::vector<std::thread> threads;
+    std::atomic<bool> failed(false);
+    Clock::time_point start = Clock::now() + std::chrono::milliseconds(50);
+    Clock::time_point stop = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.duration));
+    for (int i = 0; i < options.clients; ++i) {
+        threads.emplace_back(run_client, i, base + 1 + static_cast<uint32_t>(i), std::cref(options), start, stop,
+                             std::ref(failed), std::ref(stats[i]));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    if (failed.load()) {
+        std::printf("Error: not enough free session slots for %d clients\n", options.clients);
+        return 1;
+    }
+
+    ClientStats total;
+    for (const ClientStats& client : stats) {
+        total.latency.merge(client.latency);
+        total.requests += client.requests;
+        total.timeouts += client.timeouts;
+        total.retries += client.retries;
+        total.errors += client.errors;
+        total.games += client.games;
+    }
+
+    if (options.json_file != "-") {
+        print_report(options, total, seconds);
+    }
+    if (!options.json_file.empty() && !write_json(options, total, seconds)) {
+        std::printf("Error: cannot write %s\n", options.json_file.c_str());
+        return 1;
+    }
+    return 0;
+}